@@ -69,6 +69,8 @@ template <class Backend> void RunAll(RandomMatrices *matrices, RandomMatrices *m
 }
 
 struct BackendStats {
+  std::vector<std::vector<double>> generic_8bit;
+  std::vector<std::vector<double>> sse2_8bit;
   std::vector<std::vector<double>> ssse3_8bit;
   std::vector<std::vector<double>> avx2_8bit;
   std::vector<std::vector<double>> avx512_8bit;
@@ -142,6 +144,18 @@ int main(int, char ** argv) {
   const int kSamples = 100;
   // Realistically, we don't expect different architectures or different precisions to run in the
   // same run of an application. Benchmark per architecture and per precision level.
+  std::cerr << "Generic 8bit, 100 samples..." << std::endl;
+  for (int samples = 0; samples < kSamples; ++samples) {
+    RandomMatrices *end = (samples < 4) ? matrices_end : full_sample;
+    RunAll<Generic::Kernels8>(matrices, end, stats.generic_8bit);
+  }
+
+  std::cerr << "SSE2 8bit, 100 samples..." << std::endl;
+  for (int samples = 0; samples < kSamples; ++samples) {
+    RandomMatrices *end = (samples < 4) ? matrices_end : full_sample;
+    RunAll<SSE2::Kernels8>(matrices, end, stats.sse2_8bit);
+  }
+
   std::cerr << "SSSE3 8bit, 100 samples..." << std::endl;
   for (int samples = 0; samples < kSamples; ++samples) {
     RandomMatrices *end = (samples < 4) ? matrices_end : full_sample;
@@ -194,6 +208,8 @@ int main(int, char ** argv) {
   }
   for (std::size_t i = 0; i < sizeof(matrices) / sizeof(RandomMatrices); ++i) {
     std::cout << "Multiply\t" << matrices[i].A_rows << '\t' << matrices[i].width << '\t' << matrices[i].B_cols << '\t' << "Samples=" << (kOutlierThreshold * stats.sse2_16bit[i].size()) << '\n';
+    Print<Generic::Kernels8>(stats.generic_8bit, i);
+    Print<SSE2::Kernels8>(stats.sse2_8bit, i);
     Print<SSSE3::Kernels8>(stats.ssse3_8bit, i);
     Print<AVX2::Kernels8>(stats.avx2_8bit, i);
 #ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
@@ -0,0 +1,59 @@
+#include "../intgemm/intgemm.h"
+#include "../intgemm/aligned.h"
+#include "../intgemm/sse2_gemm.h"
+#include "../intgemm/ssse3_gemm.h"
+#include "../intgemm/avx2_gemm.h"
+#include "../intgemm/avx512_gemm.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Shortlist sizes seen in output layers, including some not divisible by 8.
+const intgemm::Index kShortlists[] = {1000, 2500, 4999, 10000};
+const intgemm::Index kVocab = 32000;
+
+template <class Backend> void SelectColumnsBench(const int8_t *prepared, int8_t *out, intgemm::Index rows, const std::vector<intgemm::Index> &cols) {
+  if (intgemm::kCPU < Backend::kUses) return;
+  Backend::SelectColumnsB(prepared, out, rows, cols.data(), cols.data() + cols.size());
+  const std::size_t kTries = 20;
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t t = 0; t < kTries; ++t) {
+    Backend::SelectColumnsB(prepared, out, rows, cols.data(), cols.data() + cols.size());
+  }
+  auto end = std::chrono::steady_clock::now();
+  double took = std::chrono::duration<double>(end - start).count() / kTries;
+  std::cout << std::setw(5) << rows << ' ' << std::setw(6) << cols.size() << ' ' << std::fixed << std::setw(9) << std::setprecision(7) << took << ' ' << Backend::kName << std::endl;
+}
+} // namespace
+
+int main() {
+  std::mt19937 gen;
+  std::uniform_int_distribution<intgemm::Index> col_dist(0, kVocab - 1);
+  for (intgemm::Index rows : {256, 512, 1024}) {
+    // Contents don't matter for a copy.
+    intgemm::AlignedVector<int8_t> prepared(rows * kVocab);
+    for (std::size_t i = 0; i < prepared.size(); ++i) {
+      prepared[i] = static_cast<int8_t>(i);
+    }
+    for (intgemm::Index count : kShortlists) {
+      std::vector<intgemm::Index> cols(count);
+      for (intgemm::Index &c : cols) {
+        c = col_dist(gen);
+      }
+      intgemm::AlignedVector<int8_t> out(rows * ((count + 7) & ~7));
+      SelectColumnsBench<intgemm::SSE2::Kernels8>(prepared.begin(), out.begin(), rows, cols);
+      SelectColumnsBench<intgemm::SSSE3::Kernels8>(prepared.begin(), out.begin(), rows, cols);
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+      SelectColumnsBench<intgemm::AVX2::Kernels8>(prepared.begin(), out.begin(), rows, cols);
+#endif
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+      SelectColumnsBench<intgemm::AVX512BW::Kernels8>(prepared.begin(), out.begin(), rows, cols);
+#endif
+    }
+  }
+}
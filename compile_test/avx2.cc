@@ -4,13 +4,14 @@
 #if defined(_MSC_VER)
 #define INTGEMM_AVX2
 #else
-#define INTGEMM_AVX2 __attribute__ ((target ("avx2")))
+#define INTGEMM_AVX2 __attribute__ ((target ("avx2,f16c")))
 #endif
 
 INTGEMM_AVX2 int Test() {
   __m256i value = _mm256_set1_epi32(1);
   value = _mm256_abs_epi8(value);
-  return *(int*)&value;
+  __m128i half = _mm256_cvtps_ph(_mm256_castsi256_ps(value), _MM_FROUND_TO_NEAREST_INT);
+  return *(int*)&half;
 }
 
 int main() {
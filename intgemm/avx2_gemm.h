@@ -21,6 +21,8 @@ INTGEMM_AVX2 inline Register QuantizerGrab(const float *input, const __m256 quan
 
 INTGEMM_SELECT_COL_B(INTGEMM_AVX2, __m256i)
 
+INTGEMM_DOT_COLUMNS8(__m256i, INTGEMM_AVX2)
+
 class QuantizeTile16 {
   public:
     INTGEMM_AVX2 static inline Register Consecutive(FRegister mult_reg, const float *input) {
@@ -187,6 +189,8 @@ struct Kernels8 {
  public:
   INTGEMM_QUANTIZE(INTGEMM_AVX2)
 
+  INTGEMM_PREPARE_A_ROWWISE(INTGEMM_AVX2)
+
   // Currently A is prepared by quantization but this could theoretically change.
   INTGEMM_AVX2 static inline void PrepareA(const float *input, uint8_t *output, float quant_mult, Index rows, Index cols) {
     QuantizeU(input, output, quant_mult, rows * cols);
@@ -203,6 +207,28 @@ struct Kernels8 {
     }
   }
 
+  // Asymmetric version: round(input * quant_mult) + zero_point saturated to [0, 255].
+  INTGEMM_AVX2 static void QuantizeZeroPoint(const float *input, uint8_t *output, float quant_mult, int32_t zero_point, Index size) {
+    assert(size % 32 == 0);
+    assert(reinterpret_cast<uintptr_t>(input) % 32 == 0);
+    FRegister q = set1_ps<FRegister>(quant_mult);
+    const __m256i zero_point_reg = set1_epi32<__m256i>(zero_point);
+    const __m256i shuffle_param = _mm256_set_epi32(7, 3, 6, 2, 5, 1, 4, 0);
+    const float *end = input + size;
+    for (; input != end; input += 32, output += 32) {
+      __m256i g0 = add_epi32(QuantizerGrab(input, q), zero_point_reg);
+      __m256i g1 = add_epi32(QuantizerGrab(input + 8, q), zero_point_reg);
+      __m256i g2 = add_epi32(QuantizerGrab(input + 16, q), zero_point_reg);
+      __m256i g3 = add_epi32(QuantizerGrab(input + 24, q), zero_point_reg);
+      __m256i packed0 = _mm256_packs_epi32(g0, g1);
+      __m256i packed1 = _mm256_packs_epi32(g2, g3);
+      // Unsigned saturation clips to [0, 255].
+      __m256i packed = _mm256_packus_epi16(packed0, packed1);
+      // Same lane order as QuantizeTile8::TileU.
+      *reinterpret_cast<__m256i*>(output) = _mm256_permutevar8x32_epi32(packed, shuffle_param);
+    }
+  }
+
   // Tile size for B; B must be a multiple of this block size.
   static const Index kBTileRow = 32;
   static const Index kBTileCol = 8;
@@ -210,6 +236,7 @@ struct Kernels8 {
   INTGEMM_PREPARE_B_8(INTGEMM_AVX2, AVX2::QuantizeTile8)
   INTGEMM_PREPARE_B_QUANTIZED_TRANSPOSED(INTGEMM_AVX2, int8_t)
   INTGEMM_PREPARE_B_TRANSPOSED(INTGEMM_AVX2, AVX2::QuantizeTile8, int8_t)
+  INTGEMM_PACK_B_PANEL_8(INTGEMM_AVX2, AVX2::QuantizeTile8)
 
   INTGEMM_AVX2 static void SelectColumnsB(const int8_t *input, int8_t *output, Index rows, const Index *cols_begin, const Index *cols_end) {
     AVX2::SelectColumnsOfB((const __m256i*)input, (__m256i*)output, rows, cols_begin, cols_end);
@@ -220,6 +247,17 @@ struct Kernels8 {
   INTGEMM_MULTIPLY8SHIFT(__m256i, INTGEMM_AVX2, CPUType::AVX2)
 
   INTGEMM_PREPAREBIASFOR8(__m256i, INTGEMM_AVX2, CPUType::AVX2)
+
+  INTGEMM_MULTIPLY8_GROUPWISE(__m256i, INTGEMM_AVX2, CPUType::AVX2)
+
+  INTGEMM_MULTIPLY8_DYNAMIC_B(__m256i, INTGEMM_AVX2, CPUType::AVX2)
+
+  INTGEMM_MULTIPLY8_DUAL(__m256i, INTGEMM_AVX2, CPUType::AVX2)
+
+  INTGEMM_MULTIPLY8_GATED(__m256i, INTGEMM_AVX2, CPUType::AVX2)
+  INTGEMM_MULTIPLY8_CELL(__m256i, INTGEMM_AVX2, CPUType::AVX2)
+
+  INTGEMM_MULTIPLY8_SHORTLIST(__m256i, INTGEMM_AVX2, CPUType::AVX2)
   
   constexpr static const char *const kName = "8-bit AVX2";
 
@@ -42,6 +42,8 @@ INTGEMM_AVX512BW inline __m512i QuantizerGrab(const float *input, const __m512 q
 /* Only INTGEMM_AVX512F is necessary but due to GCC 5.4 bug we have to set INTGEMM_AVX512BW */
 INTGEMM_SELECT_COL_B(INTGEMM_AVX512BW, __m512i)
 
+INTGEMM_DOT_COLUMNS8(__m512i, INTGEMM_AVX512BW)
+
 // For PrepareB we want to read 8 columns at a time.  When converting 32-bit
 // floats to 8-bit values, that's 32 bytes of floats.  But AVX512 is 64 bytes
 // wide so it reads off the edge of the tile.  We could expand the tile size
@@ -86,6 +88,20 @@ class QuantizeTile16 {
 
 class QuantizeTile8 {
   public:
+    INTGEMM_AVX512BW static inline Register Consecutive(FRegister quant_mult, const float *input) {
+      const __m512i neg127 = _mm512_set1_epi8(-127);
+      const __m512i shuffle_param = _mm512_set_epi32(15, 11, 7, 3, 14, 10, 6, 2, 13, 9, 5, 1, 12, 8, 4, 0);
+      auto g0 = QuantizerGrab(input, quant_mult);
+      auto g1 = QuantizerGrab(input + 16, quant_mult);
+      auto g2 = QuantizerGrab(input + 32, quant_mult);
+      auto g3 = QuantizerGrab(input + 48, quant_mult);
+      auto packed0 = packs_epi32(g0, g1);
+      auto packed1 = packs_epi32(g2, g3);
+      auto packed = _mm512_packs_epi16(packed0, packed1);
+      packed = _mm512_max_epi8(packed, neg127);
+      return _mm512_permutexvar_epi32(shuffle_param, packed);
+    }
+
     INTGEMM_AVX512BW static inline Register ConsecutiveWithWrapping(FRegister quant_mult, const float *input, Index cols_left, Index cols, Index row_step) {
       static const __m512i neg127 = _mm512_set1_epi8(-127);
       static const __m512i shuffle_param = _mm512_set_epi32(15, 11, 7, 3, 14, 10, 6, 2, 13, 9, 5, 1, 12, 8, 4, 0);
@@ -242,6 +258,8 @@ struct Kernels8 {
     _mm512_mask_cvtsepi32_storeu_epi8(fast_output_end, (1 << overhang) - 1, asint);
   }
 
+  INTGEMM_PREPARE_A_ROWWISE(INTGEMM_AVX512BW)
+
   // Preparing A for the signed/unsigned multiplication. Using add 127
   /* Only INTGEMM_AVX512F is necessary but due to GCC 5.4 bug we have to set INTGEMM_AVX512BW */
   INTGEMM_AVX512BW static inline void PrepareA(const float *input, uint8_t *output, float quant_mult, Index rows, Index cols) {
@@ -269,6 +287,24 @@ struct Kernels8 {
     }
   }
 
+  // Asymmetric version: round(input * quant_mult) + zero_point saturated to [0, 255].
+  /* Only INTGEMM_AVX512F is necessary but due to GCC 5.4 bug we have to set INTGEMM_AVX512BW */
+  INTGEMM_AVX512BW static void QuantizeZeroPoint(const float *input, uint8_t *output, float quant_mult, int32_t zero_point, Index size) {
+    assert(size % 16 == 0);
+    assert(reinterpret_cast<uintptr_t>(input) % 64 == 0);
+    const __m512i zero_point_reg = _mm512_set1_epi32(zero_point);
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512 quant_mult_reg = _mm512_set1_ps(quant_mult);
+    const float *end = input + size;
+    for (; input < end; input += 16, output += 16) {
+      __m512i asint = QuantizerGrab(input, quant_mult_reg);
+      asint = _mm512_add_epi32(asint, zero_point_reg);
+      // The store saturates unsigned so only the bottom needs clipping.
+      asint = _mm512_max_epi32(asint, zero);
+      _mm512_mask_cvtusepi32_storeu_epi8(output, 0xffff, asint);
+    }
+  }
+
   // Tile size for B; B must be a multiple of this block size.
   static const Index kBTileRow = 64;
   static const Index kBTileCol = 8;
@@ -277,6 +313,7 @@ struct Kernels8 {
   INTGEMM_PREPARE_B_8(INTGEMM_AVX512BW, QuantizeTile8)
   INTGEMM_PREPARE_B_QUANTIZED_TRANSPOSED(INTGEMM_AVX512BW, int8_t)
   INTGEMM_PREPARE_B_TRANSPOSED(INTGEMM_AVX512BW, QuantizeTile8, int8_t)
+  INTGEMM_PACK_B_PANEL_8(INTGEMM_AVX512BW, QuantizeTile8)
 
   /* Only INTGEMM_AVX512F is necessary but due to GCC 5.4 bug we have to set INTGEMM_AVX512BW */
   INTGEMM_AVX512BW static void SelectColumnsB(const int8_t *input, int8_t *output, Index rows, const Index *cols_begin, const Index *cols_end) {
@@ -287,13 +324,22 @@ struct Kernels8 {
   // allocate registers manually) and no sign instruction.
   template <typename Callback>
   INTGEMM_AVX512BW static void Multiply(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) {
+    MultiplyStrided(A, width, B, A_rows, width, B_cols, B_cols, callback);
+  }
+
+  // Multiply where rows of A are lda bytes apart and rows of the output ldc
+  // elements apart.
+  template <typename Callback>
+  INTGEMM_AVX512BW static void MultiplyStrided(const int8_t *A, Index lda, const int8_t *B, Index A_rows, Index width, Index B_cols, Index ldc, Callback callback) {
     // This is copy-paste from Multiply8_SSE2OrAVX2.
     assert(width % sizeof(Register) == 0);
+    assert(lda % sizeof(Register) == 0);
     assert(B_cols % 8 == 0);
     assert(reinterpret_cast<uintptr_t>(A) % sizeof(Register) == 0);
     assert(reinterpret_cast<uintptr_t>(B) % sizeof(Register) == 0);
     // There's 8 results for INTGEMM_AVX2 to handle.
     auto callback_impl = callbacks::CallbackImpl<CPUType::AVX2, Callback>(callback);
+    BeginRows(callback_impl, A_rows, 0);
     const Index simd_width = width / sizeof(Register);
     // Added for AVX512.
     Register zeros = setzero_si<Register>();
@@ -301,10 +347,11 @@ struct Kernels8 {
 #pragma omp for
     for (Index B0_colidx = 0; B0_colidx < B_cols; B0_colidx += 8) {
       const Register *B0_col = reinterpret_cast<const Register*>(B) + B0_colidx * simd_width;
+      __m256i tile[callbacks::kTileRows];
       // Process one row of A at a time.  Doesn't seem to be faster to do multiple rows of A at once.
       for (Index A_rowidx = 0; A_rowidx < A_rows; ++A_rowidx) {
         // Iterate over shared (inner) dimension.
-        const Register *A_live = reinterpret_cast<const Register *>(A + A_rowidx * width);
+        const Register *A_live = reinterpret_cast<const Register *>(A + A_rowidx * lda);
         const Register *A_end = A_live + simd_width;
         const Register *B_live = B0_col;
 
@@ -391,15 +438,27 @@ struct Kernels8 {
         Register pack4567 = Pack0123(sum4, sum5, sum6, sum7);
 
         auto total = PermuteSummer(pack0123, pack4567);
-        callback_impl.Run(total, callbacks::OutputBufferInfo(A_rowidx, B0_colidx, A_rows, B_cols));
+        RunCallbackTiled(callback_impl, tile, total, A_rowidx, B0_colidx, A_rows, B_cols, ldc);
       }
     }
+    FinishRows(callback_impl, A_rows, B_cols, ldc, 0);
   }
 
   INTGEMM_MULTIPLY8SHIFT(__m512i, INTGEMM_AVX512BW, CPUType::AVX2)
 
   INTGEMM_PREPAREBIASFOR8(__m512i, INTGEMM_AVX512BW, CPUType::AVX2)
 
+  INTGEMM_MULTIPLY8_GROUPWISE(__m512i, INTGEMM_AVX512BW, CPUType::AVX2)
+
+  INTGEMM_MULTIPLY8_DYNAMIC_B(__m512i, INTGEMM_AVX512BW, CPUType::AVX2)
+
+  INTGEMM_MULTIPLY8_DUAL(__m512i, INTGEMM_AVX512BW, CPUType::AVX2)
+
+  INTGEMM_MULTIPLY8_GATED(__m512i, INTGEMM_AVX512BW, CPUType::AVX2)
+  INTGEMM_MULTIPLY8_CELL(__m512i, INTGEMM_AVX512BW, CPUType::AVX2)
+
+  INTGEMM_MULTIPLY8_SHORTLIST(__m512i, INTGEMM_AVX512BW, CPUType::AVX2)
+
   constexpr static const char *const kName = "8-bit AVX512BW";
 
   static const CPUType kUses = CPUType::AVX512BW;
@@ -18,24 +18,66 @@ INTGEMM_AVX512VNNI static inline void VNNI8(__m512i &c, __m512i a, __m512i b) {
 #endif
 }
 
+// VNNI versions of DotColumns8Vertical and DotColumns8 from multiply.h, accumulating directly in 32-bit.
+INTGEMM_AVX512VNNI static inline void DotColumns8Vertical(const __m512i *A_live, const __m512i *B_live, Index simd_width, __m512i *sums) {
+  const __m512i *A_end = A_live + simd_width;
+  __m512i zeros = _mm512_setzero_si512();
+  __m512i sum0 = zeros, sum1 = zeros, sum2 = zeros, sum3 = zeros, sum4 = zeros, sum5 = zeros, sum6 = zeros, sum7 = zeros;
+  for (; A_live != A_end; ++A_live, B_live += 8) {
+    __m512i a = *A_live;
+    // Get a mask where a is negative.
+    __mmask64 neg_mask = _mm512_test_epi8_mask(a, _mm512_set1_epi8(-128));
+    __m512i a_positive = _mm512_abs_epi8(a);
+    // Negate by subtracting from zero with a mask.
+    VNNI8(sum0, a_positive, _mm512_mask_sub_epi8(B_live[0], neg_mask, zeros, B_live[0]));
+    VNNI8(sum1, a_positive, _mm512_mask_sub_epi8(B_live[1], neg_mask, zeros, B_live[1]));
+    VNNI8(sum2, a_positive, _mm512_mask_sub_epi8(B_live[2], neg_mask, zeros, B_live[2]));
+    VNNI8(sum3, a_positive, _mm512_mask_sub_epi8(B_live[3], neg_mask, zeros, B_live[3]));
+    VNNI8(sum4, a_positive, _mm512_mask_sub_epi8(B_live[4], neg_mask, zeros, B_live[4]));
+    VNNI8(sum5, a_positive, _mm512_mask_sub_epi8(B_live[5], neg_mask, zeros, B_live[5]));
+    VNNI8(sum6, a_positive, _mm512_mask_sub_epi8(B_live[6], neg_mask, zeros, B_live[6]));
+    VNNI8(sum7, a_positive, _mm512_mask_sub_epi8(B_live[7], neg_mask, zeros, B_live[7]));
+  }
+  sums[0] = sum0; sums[1] = sum1; sums[2] = sum2; sums[3] = sum3;
+  sums[4] = sum4; sums[5] = sum5; sums[6] = sum6; sums[7] = sum7;
+}
+
+INTGEMM_AVX512VNNI static inline __m256i DotColumns8(const __m512i *A_live, const __m512i *B_live, Index simd_width) {
+  __m512i sums[8];
+  DotColumns8Vertical(A_live, B_live, simd_width, sums);
+  __m512i pack0123 = Pack0123(sums[0], sums[1], sums[2], sums[3]);
+  __m512i pack4567 = Pack0123(sums[4], sums[5], sums[6], sums[7]);
+  return PermuteSummer(pack0123, pack4567);
+}
+
 struct Kernels8 : public AVX512BW::Kernels8 {
   template <typename Callback>
   INTGEMM_AVX512VNNI static void Multiply(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) {
+    MultiplyStrided(A, width, B, A_rows, width, B_cols, B_cols, callback);
+  }
+
+  // Multiply where rows of A are lda bytes apart and rows of the output ldc
+  // elements apart.
+  template <typename Callback>
+  INTGEMM_AVX512VNNI static void MultiplyStrided(const int8_t *A, Index lda, const int8_t *B, Index A_rows, Index width, Index B_cols, Index ldc, Callback callback) {
     assert(width % sizeof(Register) == 0);
+    assert(lda % sizeof(Register) == 0);
     assert(B_cols % 8 == 0);
     assert(reinterpret_cast<uintptr_t>(A) % sizeof(Register) == 0);
     assert(reinterpret_cast<uintptr_t>(B) % sizeof(Register) == 0);
     auto callback_impl = callbacks::CallbackImpl<CPUType::AVX2, Callback>(callback);
+    BeginRows(callback_impl, A_rows, 0);
     const Index simd_width = width / sizeof(Register);
     Register zeros = setzero_si<Register>();
     // Go over 8 columns of B at a time.
 #pragma omp for
     for (Index B0_colidx = 0; B0_colidx < B_cols; B0_colidx += 8) {
       const Register *B0_col = reinterpret_cast<const Register*>(B) + B0_colidx * simd_width;
+      __m256i tile[callbacks::kTileRows];
       // Process one row of A at a time.  Doesn't seem to be faster to do multiple rows of A at once.
       for (Index A_rowidx = 0; A_rowidx < A_rows; ++A_rowidx) {
         // Iterate over shared (inner) dimension.
-        const Register *A_live = reinterpret_cast<const Register *>(A + A_rowidx * width);
+        const Register *A_live = reinterpret_cast<const Register *>(A + A_rowidx * lda);
         const Register *A_end = A_live + simd_width;
         const Register *B_live = B0_col;
         // TODO: separate first step.
@@ -75,9 +117,10 @@ struct Kernels8 : public AVX512BW::Kernels8 {
         Register pack0123 = Pack0123(sum0, sum1, sum2, sum3);
         Register pack4567 = Pack0123(sum4, sum5, sum6, sum7);
         auto total = PermuteSummer(pack0123, pack4567);
-        callback_impl.Run(total, callbacks::OutputBufferInfo(A_rowidx, B0_colidx, A_rows, B_cols));
+        RunCallbackTiled(callback_impl, tile, total, A_rowidx, B0_colidx, A_rows, B_cols, ldc);
       }
     }
+    FinishRows(callback_impl, A_rows, B_cols, ldc, 0);
   }
 
   template <typename Callback>
@@ -87,6 +130,7 @@ struct Kernels8 : public AVX512BW::Kernels8 {
     assert(reinterpret_cast<uintptr_t>(A) % sizeof(Register) == 0);
     assert(reinterpret_cast<uintptr_t>(B) % sizeof(Register) == 0);
     auto callback_impl = callbacks::CallbackImpl<CPUType::AVX2, Callback>(callback);
+    BeginRows(callback_impl, A_rows, 0);
     const Index simd_width = width / sizeof(Register);
     Register zeros = setzero_si<Register>();
     // Go over 8 columns of B at a time.
@@ -119,6 +163,7 @@ struct Kernels8 : public AVX512BW::Kernels8 {
         callback_impl.Run(total, callbacks::OutputBufferInfo(A_rowidx, B0_colidx, A_rows, B_cols));
       }
     }
+    FinishRows(callback_impl, A_rows, B_cols, B_cols, 0);
   }
 
   template <typename Callback>
@@ -157,6 +202,17 @@ struct Kernels8 : public AVX512BW::Kernels8 {
     }
   }
 
+  INTGEMM_MULTIPLY8_GROUPWISE(__m512i, INTGEMM_AVX512VNNI, CPUType::AVX2)
+
+  INTGEMM_MULTIPLY8_DYNAMIC_B(__m512i, INTGEMM_AVX512VNNI, CPUType::AVX2)
+
+  INTGEMM_MULTIPLY8_DUAL(__m512i, INTGEMM_AVX512VNNI, CPUType::AVX2)
+
+  INTGEMM_MULTIPLY8_GATED(__m512i, INTGEMM_AVX512VNNI, CPUType::AVX2)
+  INTGEMM_MULTIPLY8_CELL(__m512i, INTGEMM_AVX512VNNI, CPUType::AVX2)
+
+  INTGEMM_MULTIPLY8_SHORTLIST(__m512i, INTGEMM_AVX512VNNI, CPUType::AVX2)
+
   constexpr static const char *const kName = "8-bit AVX512VNNI";
 
   static const CPUType kUses = CPUType::AVX512VNNI;
@@ -6,10 +6,18 @@
 #include "intgemm/intgemm_config.h"
 #include "intrinsics.h"
 #include "kernels.h"
+#include "stats.h"
 #include "types.h"
 #include "utils.h"
 #include "vec_traits.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #define CALLBACKS_THIS_IS_SSE2
 #include "callbacks/implementations.inl"
 #undef CALLBACKS_THIS_IS_SSE2
@@ -26,3 +34,6 @@
 #undef CALLBACKS_THIS_IS_AVX512BW
 #endif
 
+#define CALLBACKS_THIS_IS_GENERIC
+#include "callbacks/implementations.inl"
+#undef CALLBACKS_THIS_IS_GENERIC
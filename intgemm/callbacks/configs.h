@@ -1,6 +1,12 @@
 #pragma once
 
+#include "../types.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <tuple>
+#include <vector>
 
 namespace intgemm {
 namespace callbacks {
@@ -26,6 +32,25 @@ struct Write {
   Write(Type* output_addr) : output_addr(output_addr) {}
 };
 
+/*
+ * Write the output transposed: result (row, col) goes to
+ * output_addr[col * rows + row], so the output is B_cols x A_rows.  Type is
+ * int32_t or float.
+ */
+template <typename Type>
+struct WriteTransposed {
+  Type* output_addr;
+
+  WriteTransposed(Type* output_addr) : output_addr(output_addr) {}
+};
+
+struct UnquantizeAndWriteTransposed {
+  float unquant_mult;
+  float* output_addr;
+
+  UnquantizeAndWriteTransposed(float unquant_mult, float* output_addr) : unquant_mult(unquant_mult), output_addr(output_addr) {}
+};
+
 struct Unquantize {
   float unquant_mult;
 
@@ -39,6 +64,49 @@ struct UnquantizeAndWrite {
   UnquantizeAndWrite(float unquant_mult, float* output_addr) : unquant_mult(unquant_mult), output_addr(output_addr) {}
 };
 
+/*
+ * Unquantizes, adds bias (unless bias_addr is nullptr) and writes rows
+ * b * seq + s, columns h * head_dim + d of the output to
+ * output_addr[((b * heads + h) * seq + s) * head_dim + d], i.e. from
+ * [batch * seq, heads * head_dim] to [batch, heads, seq, head_dim] without a
+ * separate reshape.  A fused QKV projection with 3 * heads * head_dim columns
+ * writes Q, K and V one after another, each [batch, heads, seq, head_dim].
+ * head_dim must be a multiple of 8.
+ */
+struct UnquantizeAndAddBiasAndWriteHeads {
+  float unquant_mult;
+  const float* bias_addr;
+  Index seq;
+  Index heads;
+  Index head_dim;
+  float* output_addr;
+
+  UnquantizeAndAddBiasAndWriteHeads(float unquant_mult, const float* bias_addr, Index seq, Index heads, Index head_dim, float* output_addr) : unquant_mult(unquant_mult), bias_addr(bias_addr), seq(seq), heads(heads), head_dim(head_dim), output_addr(output_addr) {}
+};
+
+/*
+ * Unquantizes, adds bias (unless bias_addr is nullptr) and applies rotary
+ * position embeddings to the Q or K projection of rows b * seq + s, rotating
+ * each pair of columns (2i, 2i + 1) within a head of head_dim columns:
+ *   y[2i]     = x[2i] * cos[p][2i]     - x[2i + 1] * sin[p][2i]
+ *   y[2i + 1] = x[2i] * sin[p][2i + 1] + x[2i + 1] * cos[p][2i + 1]
+ * where p = position_offset + s.  cos_table and sin_table are
+ * [positions, head_dim] with each angle repeated for both columns of its pair.
+ * head_dim must be a multiple of 8.
+ */
+struct UnquantizeAndAddBiasAndRotary {
+  float unquant_mult;
+  const float* bias_addr;
+  const float* cos_table;
+  const float* sin_table;
+  Index seq;
+  Index head_dim;
+  Index position_offset;
+  float* output_addr;
+
+  UnquantizeAndAddBiasAndRotary(float unquant_mult, const float* bias_addr, const float* cos_table, const float* sin_table, Index seq, Index head_dim, float* output_addr, Index position_offset = 0) : unquant_mult(unquant_mult), bias_addr(bias_addr), cos_table(cos_table), sin_table(sin_table), seq(seq), head_dim(head_dim), position_offset(position_offset), output_addr(output_addr) {}
+};
+
 struct UnquantizeAndWriteRelu {
   float unquant_mult;
   float* output_addr;
@@ -61,6 +129,29 @@ struct UnquantizeAndAddBiasAndWrite {
   UnquantizeAndAddBiasAndWrite(float unquant_mult, const float* bias_addr, float* output_addr) : unquant_mult(unquant_mult), bias_addr(bias_addr), output_addr(output_addr) {}
 };
 
+/*
+ * Accumulating versions of UnquantizeAndWrite and UnquantizeAndAddBiasAndWrite
+ * for residual connections and split-K reductions:
+ *   output = unquant_mult * result + bias + beta * output
+ * Fold alpha of C = alpha * A * B + beta * C into unquant_mult.
+ */
+struct UnquantizeAndAccumulate {
+  float unquant_mult;
+  float beta;
+  float* output_addr;
+
+  UnquantizeAndAccumulate(float unquant_mult, float* output_addr, float beta = 1.0f) : unquant_mult(unquant_mult), beta(beta), output_addr(output_addr) {}
+};
+
+struct UnquantizeAndAddBiasAndAccumulate {
+  float unquant_mult;
+  const float* bias_addr;
+  float beta;
+  float* output_addr;
+
+  UnquantizeAndAddBiasAndAccumulate(float unquant_mult, const float* bias_addr, float* output_addr, float beta = 1.0f) : unquant_mult(unquant_mult), bias_addr(bias_addr), beta(beta), output_addr(output_addr) {}
+};
+
 struct UnquantizeAndAddBiasAndWriteRelu {
   float unquant_mult;
   const float* bias_addr;
@@ -69,5 +160,295 @@ struct UnquantizeAndAddBiasAndWriteRelu {
   UnquantizeAndAddBiasAndWriteRelu(float unquant_mult, const float* bias_addr, float* output_addr) : unquant_mult(unquant_mult), bias_addr(bias_addr), output_addr(output_addr) {}
 };
 
+struct UnquantizeAndAddBiasAndWriteSigmoid {
+  float unquant_mult;
+  const float* bias_addr;
+  float* output_addr;
+
+  UnquantizeAndAddBiasAndWriteSigmoid(float unquant_mult, const float* bias_addr, float* output_addr) : unquant_mult(unquant_mult), bias_addr(bias_addr), output_addr(output_addr) {}
+};
+
+struct UnquantizeAndAddBiasAndWriteTanh {
+  float unquant_mult;
+  const float* bias_addr;
+  float* output_addr;
+
+  UnquantizeAndAddBiasAndWriteTanh(float unquant_mult, const float* bias_addr, float* output_addr) : unquant_mult(unquant_mult), bias_addr(bias_addr), output_addr(output_addr) {}
+};
+
+struct UnquantizeAndAddBiasAndWriteGelu {
+  float unquant_mult;
+  const float* bias_addr;
+  float* output_addr;
+
+  UnquantizeAndAddBiasAndWriteGelu(float unquant_mult, const float* bias_addr, float* output_addr) : unquant_mult(unquant_mult), bias_addr(bias_addr), output_addr(output_addr) {}
+};
+
+struct UnquantizeAndAddBiasAndWriteSilu {
+  float unquant_mult;
+  const float* bias_addr;
+  float* output_addr;
+
+  UnquantizeAndAddBiasAndWriteSilu(float unquant_mult, const float* bias_addr, float* output_addr) : unquant_mult(unquant_mult), bias_addr(bias_addr), output_addr(output_addr) {}
+};
+
+/*
+ * For B prepared with per-column multipliers (Int8::PrepareBPerColumn):
+ * unquant_mults has one multiplier per column of the output, aligned like
+ * bias_addr.
+ */
+struct UnquantizePerColumnAndWrite {
+  const float* unquant_mults;
+  float* output_addr;
+
+  UnquantizePerColumnAndWrite(const float* unquant_mults, float* output_addr) : unquant_mults(unquant_mults), output_addr(output_addr) {}
+};
+
+struct UnquantizePerColumnAndAddBiasAndWrite {
+  const float* unquant_mults;
+  const float* bias_addr;
+  float* output_addr;
+
+  UnquantizePerColumnAndAddBiasAndWrite(const float* unquant_mults, const float* bias_addr, float* output_addr) : unquant_mults(unquant_mults), bias_addr(bias_addr), output_addr(output_addr) {}
+};
+
+/*
+ * For A prepared by Int8::PrepareARowwise: each output row is multiplied by
+ * row_scales[row] and by the unquantization multiplier of B, which is either
+ * one unquant_mult (1.0 / B quant_mult) or one per column
+ * (column_unquant_mults, for Int8::PrepareBPerColumn).
+ */
+struct UnquantizeRowScaledAndAddBiasAndWrite {
+  const float* row_scales;
+  float unquant_mult;
+  const float* column_unquant_mults;
+  const float* bias_addr;
+  float* output_addr;
+
+  UnquantizeRowScaledAndAddBiasAndWrite(const float* row_scales, float unquant_mult, const float* bias_addr, float* output_addr) : row_scales(row_scales), unquant_mult(unquant_mult), column_unquant_mults(nullptr), bias_addr(bias_addr), output_addr(output_addr) {}
+  UnquantizeRowScaledAndAddBiasAndWrite(const float* row_scales, const float* column_unquant_mults, const float* bias_addr, float* output_addr) : row_scales(row_scales), unquant_mult(1.0f), column_unquant_mults(column_unquant_mults), bias_addr(bias_addr), output_addr(output_addr) {}
+};
+
+/*
+ * For Int8::MultiplyShortlist: the output has one column per shortlist entry
+ * but bias_addr covers every column of B, so the bias is looked up through
+ * shortlist (the cols_begin passed to the multiply).
+ */
+struct UnquantizeAndAddShortlistBiasAndWrite {
+  float unquant_mult;
+  const float* bias_addr;
+  const Index* shortlist;
+  float* output_addr;
+
+  UnquantizeAndAddShortlistBiasAndWrite(float unquant_mult, const float* bias_addr, const Index* shortlist, float* output_addr) : unquant_mult(unquant_mult), bias_addr(bias_addr), shortlist(shortlist), output_addr(output_addr) {}
+};
+
+/*
+ * Keeps the k largest unquantized values of every row, for greedy or beam
+ * search over an output layer.  indices_addr and scores_addr are rows x k
+ * row-major and receive, per row, the columns and values sorted by descending
+ * value (ties go to the lower column).  Rows with fewer than k columns are
+ * filled with -infinity and std::numeric_limits<Index>::max().  Every
+ * multiply resets them first.  The full output is only written if output_addr
+ * is not null.
+ */
+struct UnquantizeAndTopK {
+  float unquant_mult;
+  Index k;
+  Index* indices_addr;
+  float* scores_addr;
+  float* output_addr;
+
+  UnquantizeAndTopK(float unquant_mult, Index k, Index* indices_addr, float* scores_addr, float* output_addr = nullptr) : unquant_mult(unquant_mult), k(k), indices_addr(indices_addr), scores_addr(scores_addr), output_addr(output_addr) {}
+};
+
+/*
+ * Unquantizes and writes like UnquantizeAndWrite while keeping the running
+ * maximum and sum of exp(value - maximum) of every row, so a softmax or
+ * log-softmax can be finished with FinishSoftmax or FinishLogSoftmax in one
+ * more pass over the output.  row_max and row_sum have one entry per row and
+ * every multiply resets them first.
+ */
+struct UnquantizeAndWriteSoftmaxStats {
+  float unquant_mult;
+  float* output_addr;
+  float* row_max;
+  float* row_sum;
+
+  UnquantizeAndWriteSoftmaxStats(float unquant_mult, float* output_addr, float* row_max, float* row_sum) : unquant_mult(unquant_mult), output_addr(output_addr), row_max(row_max), row_sum(row_sum) {}
+};
+
+/*
+ * Unquantizes, adds bias (unless bias_addr is nullptr) and writes like
+ * UnquantizeAndAddBiasAndWrite while tracking the absolute maximum of every
+ * row in row_max and of the whole output in global_max, so the next layer can
+ * choose its quant_mult without a MaxAbsolute pass over the output.  Either
+ * may be nullptr.  Every multiply resets them first.
+ */
+struct UnquantizeAndAddBiasAndWriteAbsMax {
+  float unquant_mult;
+  const float* bias_addr;
+  float* output_addr;
+  float* row_max;
+  float* global_max;
+
+  UnquantizeAndAddBiasAndWriteAbsMax(float unquant_mult, const float* bias_addr, float* output_addr, float* row_max, float* global_max = nullptr) : unquant_mult(unquant_mult), bias_addr(bias_addr), output_addr(output_addr), row_max(row_max), global_max(global_max) {}
+};
+
+/*
+ * Fused bias, residual and LayerNorm over each row of the output:
+ *   y = unquant_mult * x + bias + residual
+ *   output = (y - mean(y)) / sqrt(var(y) + epsilon) * gamma + beta
+ * Row sums are collected while blocks are written and every row is
+ * normalized once all its blocks are done (see FinishRows in multiply.h), so
+ * the statistics do not need another pass over the output.  The sums are
+ * kept in double in row_sums, which the threads' callbacks share and every
+ * multiply resets, so the variance does not cancel for rows whose mean dwarfs
+ * their deviation.  residual_addr (laid out like the output), gamma and beta
+ * may be nullptr.  row_mean and row_rstd have one entry per row and receive
+ * the mean and 1 / sqrt(var + epsilon).
+ */
+struct UnquantizeAndAddBiasAndLayerNorm {
+  float unquant_mult;
+  const float* bias_addr;
+  const float* residual_addr;
+  const float* gamma;
+  const float* beta;
+  float epsilon;
+  float* output_addr;
+  float* row_mean;
+  float* row_rstd;
+  // Sum of every row followed by sum of squares of every row.
+  std::shared_ptr<std::vector<double>> row_sums;
+
+  UnquantizeAndAddBiasAndLayerNorm(float unquant_mult, const float* bias_addr, const float* residual_addr, const float* gamma, const float* beta, float epsilon, float* output_addr, float* row_mean, float* row_rstd) : unquant_mult(unquant_mult), bias_addr(bias_addr), residual_addr(residual_addr), gamma(gamma), beta(beta), epsilon(epsilon), output_addr(output_addr), row_mean(row_mean), row_rstd(row_rstd), row_sums(std::make_shared<std::vector<double>>()) {}
+};
+
+/*
+ * For A quantized with a zero point (Int8Shift::PrepareAZeroPoint): subtracts
+ * zero_point * (column sums of B) before unquantizing.  With one zero point for
+ * all of A, pass zero_point_sums from Int8Shift::PrepareBZeroPointSums.  With
+ * one zero point per row of A, pass column_sums from
+ * Int8Shift::PrepareBColumnSums and row_zero_points.
+ */
+struct UnquantizeZeroPointAndAddBiasAndWrite {
+  float unquant_mult;
+  const int* zero_point_sums;
+  const int* column_sums;
+  const int* row_zero_points;
+  const float* bias_addr;
+  float* output_addr;
+
+  UnquantizeZeroPointAndAddBiasAndWrite(float unquant_mult, const int* zero_point_sums, const float* bias_addr, float* output_addr) : unquant_mult(unquant_mult), zero_point_sums(zero_point_sums), column_sums(nullptr), row_zero_points(nullptr), bias_addr(bias_addr), output_addr(output_addr) {}
+  UnquantizeZeroPointAndAddBiasAndWrite(float unquant_mult, const int* column_sums, const int* row_zero_points, const float* bias_addr, float* output_addr) : unquant_mult(unquant_mult), zero_point_sums(nullptr), column_sums(column_sums), row_zero_points(row_zero_points), bias_addr(bias_addr), output_addr(output_addr) {}
+};
+
+
+/*
+ * Activations for UnquantizeAndAddBiasAndRequantize.
+ */
+enum class Activation {
+  Identity,
+  Relu,
+  Sigmoid,
+  Tanh,
+  Gelu,
+  Silu,
+};
+
+/*
+ * Unquantizes, adds bias and applies the activation like the float callbacks
+ * above, then quantizes again with the next layer's quant_mult.  The output is
+ * laid out like prepared A so it can be passed straight to the next Multiply.
+ * Type is int8_t for Int8 or uint8_t (values shifted by 127) for Int8Shift.
+ */
+template <typename Type, Activation activation = Activation::Identity>
+struct UnquantizeAndAddBiasAndRequantize {
+  float unquant_mult;
+  const float* bias_addr;
+  float quant_mult;
+  Type* output_addr;
+
+  UnquantizeAndAddBiasAndRequantize(float unquant_mult, const float* bias_addr, float quant_mult, Type* output_addr) : unquant_mult(unquant_mult), bias_addr(bias_addr), quant_mult(quant_mult), output_addr(output_addr) {}
+};
+
+/*
+ * Gated linear unit for Int8::MultiplyGated, which hands the callback the gate
+ * and up sums of the same 8 output columns together:
+ *   output = activation(gate_unquant_mult * gate + gate_bias) * (up_unquant_mult * up + up_bias)
+ * Activation::Sigmoid gives GLU, Activation::Silu SwiGLU and Activation::Gelu
+ * GeGLU.  Biases are indexed by output column and may be nullptr.
+ */
+template <Activation activation>
+struct UnquantizeAndAddBiasAndGate {
+  float gate_unquant_mult;
+  const float* gate_bias_addr;
+  float up_unquant_mult;
+  const float* up_bias_addr;
+  float* output_addr;
+
+  UnquantizeAndAddBiasAndGate(float gate_unquant_mult, const float* gate_bias_addr, float up_unquant_mult, const float* up_bias_addr, float* output_addr) : gate_unquant_mult(gate_unquant_mult), gate_bias_addr(gate_bias_addr), up_unquant_mult(up_unquant_mult), up_bias_addr(up_bias_addr), output_addr(output_addr) {}
+};
+
+/*
+ * Recurrent cell updates for MultiplyCell, which hands over the sums of four
+ * gate projections for the same output columns.  bias_addr holds 4 * cols
+ * values, cols per gate in gate order, and may be nullptr.
+ *
+ * LSTM with gates input i, forget f, candidate g and output o:
+ *   c = sigmoid(f) * c + sigmoid(i) * tanh(g)
+ *   h = sigmoid(o) * tanh(c)
+ * cell_addr holds the previous cell state and is updated in place; h is
+ * written to hidden_addr.
+ */
+struct UnquantizeAndAddBiasAndLSTMCell {
+  float unquant_mult;
+  const float* bias_addr;
+  float* cell_addr;
+  float* hidden_addr;
+
+  UnquantizeAndAddBiasAndLSTMCell(float unquant_mult, const float* bias_addr, float* cell_addr, float* hidden_addr) : unquant_mult(unquant_mult), bias_addr(bias_addr), cell_addr(cell_addr), hidden_addr(hidden_addr) {}
+};
+
+/*
+ * GRU with the reset gate applied after the recurrent projection, as cuDNN
+ * does, so one multiply suffices.  Gates are reset r, update z and the
+ * candidate's input part x_n and recurrent part h_n; give those two zero
+ * weights for the hidden and input rows of A respectively.
+ *   n = tanh(x_n + sigmoid(r) * h_n)
+ *   h = (1 - sigmoid(z)) * n + sigmoid(z) * h
+ * hidden_addr holds the previous hidden state and is updated in place.
+ */
+struct UnquantizeAndAddBiasAndGRUCell {
+  float unquant_mult;
+  const float* bias_addr;
+  float* hidden_addr;
+
+  UnquantizeAndAddBiasAndGRUCell(float unquant_mult, const float* bias_addr, float* hidden_addr) : unquant_mult(unquant_mult), bias_addr(bias_addr), hidden_addr(hidden_addr) {}
+};
+
+/*
+ * Unquantize, optionally add bias and write 16-bit floats, halving the output
+ * traffic for the next layer.  Values are converted in registers with round to
+ * nearest even; output holds the raw bits.  bias_addr may be nullptr.
+ */
+struct UnquantizeAndWriteBFloat16 {
+  float unquant_mult;
+  const float* bias_addr;
+  uint16_t* output_addr;
+
+  UnquantizeAndWriteBFloat16(float unquant_mult, uint16_t* output_addr) : unquant_mult(unquant_mult), bias_addr(nullptr), output_addr(output_addr) {}
+  UnquantizeAndWriteBFloat16(float unquant_mult, const float* bias_addr, uint16_t* output_addr) : unquant_mult(unquant_mult), bias_addr(bias_addr), output_addr(output_addr) {}
+};
+
+struct UnquantizeAndWriteFloat16 {
+  float unquant_mult;
+  const float* bias_addr;
+  uint16_t* output_addr;
+
+  UnquantizeAndWriteFloat16(float unquant_mult, uint16_t* output_addr) : unquant_mult(unquant_mult), bias_addr(nullptr), output_addr(output_addr) {}
+  UnquantizeAndWriteFloat16(float unquant_mult, const float* bias_addr, uint16_t* output_addr) : unquant_mult(unquant_mult), bias_addr(bias_addr), output_addr(output_addr) {}
+};
+
 }
 }
@@ -8,14 +8,21 @@
 #elif defined(CALLBACKS_THIS_IS_AVX512BW)
   #define CPU_NAME AVX512BW
   #define INTGEMM_TARGET INTGEMM_AVX512BW
+#elif defined(CALLBACKS_THIS_IS_GENERIC)
+  #define CPU_NAME UNSUPPORTED
+  #define INTGEMM_TARGET INTGEMM_GENERIC
 #else
-  #error "Only SSE2, AVX2 and AVX512BW are supported"
+  #error "Only SSE2, AVX2, AVX512BW and Generic are supported"
 #endif
 
 #if defined(CALLBACKS_THIS_IS_SSE2)
   #define vi vector_t<CPUType::SSE2, int>
   #define vf vector_t<CPUType::SSE2, float>
   #define vd vector_t<CPUType::SSE2, double>
+#elif defined(CALLBACKS_THIS_IS_GENERIC)
+  #define vi vector_t<CPUType::UNSUPPORTED, int>
+  #define vf vector_t<CPUType::UNSUPPORTED, float>
+  #define vd vector_t<CPUType::UNSUPPORTED, double>
 #else
   #define vi vector_t<CPUType::AVX2, int>
   #define vf vector_t<CPUType::AVX2, float>
@@ -35,6 +42,12 @@ namespace callbacks {
 template <CPUType CpuType, typename CallbackConfig>
 class CallbackImpl;
 
+template <CPUType CpuType>
+struct Activations;
+
+template <CPUType CpuType>
+class TransposeTile;
+
 }}
 
 /*
@@ -101,13 +114,193 @@ public:
   explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const Write<Type>& config) : config(config) {}
 
   INTGEMM_TARGET void Run(vector_t<CPUType::CPU_NAME, Type> input, const OutputBufferInfo& info) {
-    kernels::write(input, config.output_addr, info.row_idx * info.cols + info.col_idx);
+    kernels::write(input, config.output_addr, info.row_idx * info.ldc + info.col_idx);
   }
 
 private:
   Write<Type> config;
 };
 
+/*
+ * Collects 8 consecutive rows of a block of 8 columns and writes them
+ * transposed, as 8 rows of 8 consecutive values at output + col * ld + row.
+ * The multiplies hand one thread all rows of a block of columns in increasing
+ * order, so a tile is complete at every eighth row and at the last row.
+ * Tile callbacks already have the rows together and call Transpose directly.
+ * Values are only moved, so 32-bit integers travel as float bits.
+ */
+template <> class TransposeTile<CPUType::CPU_NAME> {
+public:
+  template <typename Type>
+  INTGEMM_TARGET void Run(vf input, const OutputBufferInfo& info, Type* output) {
+    static_assert(sizeof(Type) == sizeof(float), "Transposing moves 32-bit values.");
+    const Index row = info.row_idx % 8;
+    const Index part = (info.col_idx % 8) / kLanes;
+    tile[row * kParts + part] = input;
+    if (part + 1 == kParts && (row == 7 || info.row_idx + 1 == info.rows)) {
+      ZeroRows(tile, row + 1);
+      Transpose(tile, reinterpret_cast<float*>(output), info.row_idx - row, row + 1, info.col_idx - info.col_idx % 8, info.rows);
+    }
+  }
+
+  static constexpr Index kLanes = sizeof(vf) / sizeof(float);
+  static constexpr Index kParts = 8 / kLanes;
+
+  // Transpose reads all 8 rows, so zero the ones past valid in a partial tile.
+  INTGEMM_TARGET static inline void ZeroRows(vf* tile, Index valid) {
+    for (Index i = valid * kParts; i < 8 * kParts; ++i) {
+      tile[i] = setzero_ps<vf>();
+    }
+  }
+
+  // tile holds valid <= 8 rows of 8 columns, kParts registers per row.
+#if defined(CALLBACKS_THIS_IS_SSE2)
+  INTGEMM_TARGET static void Transpose(const vf* tile, float* output, Index row0, Index valid, Index col0, Index ld) {
+    for (Index part = 0; part < kParts; ++part) {
+      for (Index block = 0; block * 4 < valid; ++block) {
+        __m128 r0 = tile[(block * 4 + 0) * kParts + part];
+        __m128 r1 = tile[(block * 4 + 1) * kParts + part];
+        __m128 r2 = tile[(block * 4 + 2) * kParts + part];
+        __m128 r3 = tile[(block * 4 + 3) * kParts + part];
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        const Index count = std::min<Index>(4, valid - block * 4);
+        float* to = output + (col0 + part * 4) * ld + row0 + block * 4;
+        Store(to, r0, count);
+        Store(to + ld, r1, count);
+        Store(to + 2 * ld, r2, count);
+        Store(to + 3 * ld, r3, count);
+      }
+    }
+  }
+#elif defined(CALLBACKS_THIS_IS_GENERIC)
+  INTGEMM_TARGET static void Transpose(const vf* tile, float* output, Index row0, Index valid, Index col0, Index ld) {
+    for (Index column = 0; column < 8; ++column) {
+      float* to = output + (col0 + column) * ld + row0;
+      for (Index row = 0; row < valid; ++row) {
+        to[row] = tile[row * kParts + column / kLanes].lanes[column % kLanes];
+      }
+    }
+  }
+#else
+  INTGEMM_TARGET static void Transpose(const vf* tile, float* output, Index row0, Index valid, Index col0, Index ld) {
+    __m256 t0 = _mm256_unpacklo_ps(tile[0], tile[1]);
+    __m256 t1 = _mm256_unpackhi_ps(tile[0], tile[1]);
+    __m256 t2 = _mm256_unpacklo_ps(tile[2], tile[3]);
+    __m256 t3 = _mm256_unpackhi_ps(tile[2], tile[3]);
+    __m256 t4 = _mm256_unpacklo_ps(tile[4], tile[5]);
+    __m256 t5 = _mm256_unpackhi_ps(tile[4], tile[5]);
+    __m256 t6 = _mm256_unpacklo_ps(tile[6], tile[7]);
+    __m256 t7 = _mm256_unpackhi_ps(tile[6], tile[7]);
+    __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    float* to = output + col0 * ld + row0;
+    Store(to, _mm256_permute2f128_ps(s0, s4, 0x20), valid);
+    Store(to + ld, _mm256_permute2f128_ps(s1, s5, 0x20), valid);
+    Store(to + 2 * ld, _mm256_permute2f128_ps(s2, s6, 0x20), valid);
+    Store(to + 3 * ld, _mm256_permute2f128_ps(s3, s7, 0x20), valid);
+    Store(to + 4 * ld, _mm256_permute2f128_ps(s0, s4, 0x31), valid);
+    Store(to + 5 * ld, _mm256_permute2f128_ps(s1, s5, 0x31), valid);
+    Store(to + 6 * ld, _mm256_permute2f128_ps(s2, s6, 0x31), valid);
+    Store(to + 7 * ld, _mm256_permute2f128_ps(s3, s7, 0x31), valid);
+  }
+#endif
+
+private:
+  INTGEMM_TARGET static inline void Store(float* to, vf value, Index count) {
+    if (count == kLanes) {
+      storeu_ps(to, value);
+    } else {
+      float values[kLanes];
+      storeu_ps(values, value);
+      std::memcpy(to, values, count * sizeof(float));
+    }
+  }
+
+
+  vf tile[8 * kParts];
+};
+
+/*
+ * WriteTransposed
+ */
+template <typename Type>
+class CallbackImpl<CPUType::CPU_NAME, WriteTransposed<Type>> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const WriteTransposed<Type>& config) : config(config) {}
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    static_assert(std::is_same<Type, int32_t>::value, "Integer sums are written as int32_t.");
+    tile.Run(cast_ps(input), info, config.output_addr);
+  }
+
+  INTGEMM_TARGET void Run(vf input, const OutputBufferInfo& info) {
+    static_assert(std::is_same<Type, float>::value, "Float results are written as float.");
+    tile.Run(input, info, config.output_addr);
+  }
+
+  INTGEMM_TARGET void RunTile(const vi* input, Index tile_rows, const OutputBufferInfo& info) {
+    static_assert(std::is_same<Type, int32_t>::value, "Integer sums are written as int32_t.");
+    vf rows[8 * TransposeTile<CPUType::CPU_NAME>::kParts];
+    for (Index i = 0; i < tile_rows * TransposeTile<CPUType::CPU_NAME>::kParts; ++i) {
+      rows[i] = cast_ps(input[i]);
+    }
+    TransposeTile<CPUType::CPU_NAME>::ZeroRows(rows, tile_rows);
+    TransposeTile<CPUType::CPU_NAME>::Transpose(rows, reinterpret_cast<float*>(config.output_addr), info.row_idx, tile_rows, info.col_idx, info.rows);
+  }
+
+private:
+  WriteTransposed<Type> config;
+  TransposeTile<CPUType::CPU_NAME> tile;
+};
+
+/*
+ * UnquantizeAndWriteTransposed
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndWriteTransposed> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndWriteTransposed& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    tile.Run(kernels::unquantize(input, mult_reg), info, config.output_addr);
+  }
+
+  INTGEMM_TARGET void RunTile(const vi* input, Index tile_rows, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    vf rows[8 * TransposeTile<CPUType::CPU_NAME>::kParts];
+    for (Index i = 0; i < tile_rows * TransposeTile<CPUType::CPU_NAME>::kParts; ++i) {
+      rows[i] = kernels::unquantize(input[i], mult_reg);
+    }
+    TransposeTile<CPUType::CPU_NAME>::ZeroRows(rows, tile_rows);
+    TransposeTile<CPUType::CPU_NAME>::Transpose(rows, config.output_addr, info.row_idx, tile_rows, info.col_idx, info.rows);
+  }
+
+private:
+  vf unquant_mult;
+  UnquantizeAndWriteTransposed config;
+  TransposeTile<CPUType::CPU_NAME> tile;
+};
+
 /*
  * Unquantize
  */
@@ -138,13 +331,13 @@ public:
   INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
     // Workaround gcc 5 internal compiler error that can't read register members in debug.
     vf mult_reg;
-#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER)
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
     asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
 #else
     mult_reg = unquant_mult;
 #endif
     auto result = kernels::unquantize(input, mult_reg);
-    kernels::write(result, config.output_addr, info.row_idx * info.cols + info.col_idx);
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
   }
 
 private:
@@ -152,6 +345,91 @@ private:
   UnquantizeAndWrite config;
 };
 
+/*
+ * UnquantizeAndAddBiasAndWriteHeads
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndAddBiasAndWriteHeads> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndAddBiasAndWriteHeads& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    auto result = kernels::unquantize(input, mult_reg);
+    if (config.bias_addr) {
+      result = kernels::add_bias(result, config.bias_addr, info.col_idx);
+    }
+    // Batch and sequence position from the row, head (counting Q, K and V
+    // heads of a fused projection in order) and offset within it from the column.
+    const Index batch = info.rows / config.seq;
+    const Index b = info.row_idx / config.seq, s = info.row_idx % config.seq;
+    const Index head = info.col_idx / config.head_dim, d = info.col_idx % config.head_dim;
+    const Index part = head / config.heads, h = head % config.heads;
+    kernels::write(result, config.output_addr, (((part * batch + b) * config.heads + h) * config.seq + s) * config.head_dim + d);
+  }
+private:
+  vf unquant_mult;
+  UnquantizeAndAddBiasAndWriteHeads config;
+};
+
+/*
+ * UnquantizeAndAddBiasAndRotary
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndAddBiasAndRotary> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndAddBiasAndRotary& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+    // Negate the swapped partner of even columns.
+#if defined(CALLBACKS_THIS_IS_SSE2)
+    pair_sign = _mm_set_ps(1.0f, -1.0f, 1.0f, -1.0f);
+#elif defined(CALLBACKS_THIS_IS_GENERIC)
+    pair_sign = vf{{-1.0f, 1.0f, -1.0f, 1.0f}};
+#else
+    pair_sign = _mm256_set_ps(1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f);
+#endif
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg, sign_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+    asm ("vmovdqa %1, %0" : "=x" (sign_reg) : "m" (pair_sign));
+#else
+    mult_reg = unquant_mult;
+    sign_reg = pair_sign;
+#endif
+    auto result = kernels::unquantize(input, mult_reg);
+    if (config.bias_addr) {
+      result = kernels::add_bias(result, config.bias_addr, info.col_idx);
+    }
+    const Index table_offset = (config.position_offset + info.row_idx % config.seq) * config.head_dim + info.col_idx % config.head_dim;
+    auto cos_reg = *reinterpret_cast<const vf*>(config.cos_table + table_offset);
+    auto sin_reg = *reinterpret_cast<const vf*>(config.sin_table + table_offset);
+    // Swap the columns of each pair.
+#if defined(CALLBACKS_THIS_IS_SSE2)
+    auto swapped = _mm_shuffle_ps(result, result, _MM_SHUFFLE(2, 3, 0, 1));
+#elif defined(CALLBACKS_THIS_IS_GENERIC)
+    auto swapped = vf{{result.lanes[1], result.lanes[0], result.lanes[3], result.lanes[2]}};
+#else
+    auto swapped = _mm256_shuffle_ps(result, result, _MM_SHUFFLE(2, 3, 0, 1));
+#endif
+    result = add_ps(mul_ps(result, cos_reg), mul_ps(mul_ps(swapped, sign_reg), sin_reg));
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
+  }
+private:
+  vf unquant_mult;
+  vf pair_sign;
+  UnquantizeAndAddBiasAndRotary config;
+};
+
 /*
  * UnquantizeAndWriteRelu
  */
@@ -164,13 +442,13 @@ public:
   INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
     // Workaround gcc 5 internal compiler error that can't read register members in debug.
     vf mult_reg;
-#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER)
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
     asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
 #else
     mult_reg = unquant_mult;
 #endif
     auto result = kernels::relu<float>(kernels::unquantize(input, mult_reg));
-    kernels::write(result, config.output_addr, info.row_idx * info.cols + info.col_idx);
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
   }
 
 private:
@@ -188,7 +466,7 @@ public:
 
   INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
     auto result = kernels::add_bias(input, config.bias_addr, info.col_idx);
-    kernels::write(result, config.output_addr, info.row_idx * info.cols + info.col_idx);
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
   }
 
 private:
@@ -207,20 +485,83 @@ public:
   INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
     // Workaround gcc 5 internal compiler error that can't read register members in debug.
     vf mult_reg;
-#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER)
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
     asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
 #else
     mult_reg = unquant_mult;
 #endif
     auto result = kernels::unquantize(input, mult_reg);
     result = kernels::add_bias(result, config.bias_addr, info.col_idx);
-    kernels::write(result, config.output_addr, info.row_idx * info.cols + info.col_idx);
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
   }
 private:
   vf unquant_mult;
   UnquantizeAndAddBiasAndWrite config;
 };
 
+/*
+ * UnquantizeAndAccumulate
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndAccumulate> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndAccumulate& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+    beta = set1_ps<vf>(config.beta);
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg, beta_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+    asm ("vmovdqa %1, %0" : "=x" (beta_reg) : "m" (beta));
+#else
+    mult_reg = unquant_mult;
+    beta_reg = beta;
+#endif
+    auto offset = info.row_idx * info.ldc + info.col_idx;
+    auto result = kernels::unquantize(input, mult_reg);
+    result = kernels::accumulate(result, config.output_addr, offset, beta_reg);
+    kernels::write(result, config.output_addr, offset);
+  }
+private:
+  vf unquant_mult;
+  vf beta;
+  UnquantizeAndAccumulate config;
+};
+
+/*
+ * UnquantizeAndAddBiasAndAccumulate
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndAddBiasAndAccumulate> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndAddBiasAndAccumulate& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+    beta = set1_ps<vf>(config.beta);
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg, beta_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+    asm ("vmovdqa %1, %0" : "=x" (beta_reg) : "m" (beta));
+#else
+    mult_reg = unquant_mult;
+    beta_reg = beta;
+#endif
+    auto offset = info.row_idx * info.ldc + info.col_idx;
+    auto result = kernels::unquantize(input, mult_reg);
+    result = kernels::add_bias(result, config.bias_addr, info.col_idx);
+    result = kernels::accumulate(result, config.output_addr, offset, beta_reg);
+    kernels::write(result, config.output_addr, offset);
+  }
+private:
+  vf unquant_mult;
+  vf beta;
+  UnquantizeAndAddBiasAndAccumulate config;
+};
+
 /*
  * UnquantizeAndAddBiasAndWrite
  */
@@ -233,7 +574,7 @@ public:
   INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
     // Workaround gcc 5 internal compiler error that can't read register members in debug.
     vf mult_reg;
-#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER)
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
     asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
 #else
     mult_reg = unquant_mult;
@@ -241,13 +582,810 @@ public:
     auto result = kernels::unquantize(input, mult_reg);
     result = kernels::add_bias(result, config.bias_addr, info.col_idx);
     result = kernels::relu<float>(result);
-    kernels::write(result, config.output_addr, info.row_idx * info.cols + info.col_idx);
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
   }
 private:
   vf unquant_mult;
   UnquantizeAndAddBiasAndWriteRelu config;
 };
 
+/*
+ * UnquantizeAndAddBiasAndWriteSigmoid
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndAddBiasAndWriteSigmoid> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndAddBiasAndWriteSigmoid& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    auto result = kernels::unquantize(input, mult_reg);
+    result = kernels::add_bias(result, config.bias_addr, info.col_idx);
+    result = kernels::sigmoid(result);
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
+  }
+private:
+  vf unquant_mult;
+  UnquantizeAndAddBiasAndWriteSigmoid config;
+};
+
+/*
+ * UnquantizeAndAddBiasAndWriteTanh
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndAddBiasAndWriteTanh> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndAddBiasAndWriteTanh& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    auto result = kernels::unquantize(input, mult_reg);
+    result = kernels::add_bias(result, config.bias_addr, info.col_idx);
+    result = kernels::tanh(result);
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
+  }
+private:
+  vf unquant_mult;
+  UnquantizeAndAddBiasAndWriteTanh config;
+};
+
+/*
+ * UnquantizeAndAddBiasAndWriteGelu
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndAddBiasAndWriteGelu> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndAddBiasAndWriteGelu& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    auto result = kernels::unquantize(input, mult_reg);
+    result = kernels::add_bias(result, config.bias_addr, info.col_idx);
+    result = kernels::gelu(result);
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
+  }
+private:
+  vf unquant_mult;
+  UnquantizeAndAddBiasAndWriteGelu config;
+};
+
+/*
+ * UnquantizeAndAddBiasAndWriteSilu
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndAddBiasAndWriteSilu> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndAddBiasAndWriteSilu& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    auto result = kernels::unquantize(input, mult_reg);
+    result = kernels::add_bias(result, config.bias_addr, info.col_idx);
+    result = kernels::silu(result);
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
+  }
+private:
+  vf unquant_mult;
+  UnquantizeAndAddBiasAndWriteSilu config;
+};
+
+/*
+ * UnquantizePerColumnAndWrite
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizePerColumnAndWrite> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizePerColumnAndWrite& config) : config(config) {}
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    auto mult_reg = *reinterpret_cast<const vf*>(config.unquant_mults + info.col_idx);
+    auto result = kernels::unquantize(input, mult_reg);
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
+  }
+
+private:
+  UnquantizePerColumnAndWrite config;
+};
+
+/*
+ * UnquantizePerColumnAndAddBiasAndWrite
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizePerColumnAndAddBiasAndWrite> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizePerColumnAndAddBiasAndWrite& config) : config(config) {}
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    auto mult_reg = *reinterpret_cast<const vf*>(config.unquant_mults + info.col_idx);
+    auto result = kernels::unquantize(input, mult_reg);
+    result = kernels::add_bias(result, config.bias_addr, info.col_idx);
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
+  }
+
+private:
+  UnquantizePerColumnAndAddBiasAndWrite config;
+};
+
+/*
+ * UnquantizeRowScaledAndAddBiasAndWrite
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeRowScaledAndAddBiasAndWrite> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeRowScaledAndAddBiasAndWrite& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    if (config.column_unquant_mults) {
+      mult_reg = *reinterpret_cast<const vf*>(config.column_unquant_mults + info.col_idx);
+    }
+    mult_reg = mul_ps(mult_reg, set1_ps<vf>(config.row_scales[info.row_idx]));
+    auto result = kernels::unquantize(input, mult_reg);
+    result = kernels::add_bias(result, config.bias_addr, info.col_idx);
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
+  }
+
+private:
+  vf unquant_mult;
+  UnquantizeRowScaledAndAddBiasAndWrite config;
+};
+
+/*
+ * UnquantizeAndAddShortlistBiasAndWrite
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndAddShortlistBiasAndWrite> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndAddShortlistBiasAndWrite& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    // Gather the bias of the original columns.
+    alignas(sizeof(vf)) float bias[sizeof(vf) / sizeof(float)];
+    for (Index i = 0; i < sizeof(vf) / sizeof(float); ++i) {
+      bias[i] = config.bias_addr[config.shortlist[info.col_idx + i]];
+    }
+    auto result = kernels::unquantize(input, mult_reg);
+    result = kernels::add_bias(result, bias, 0);
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
+  }
+private:
+  vf unquant_mult;
+  UnquantizeAndAddShortlistBiasAndWrite config;
+};
+
+/*
+ * UnquantizeAndTopK
+ *
+ * Every thread keeps its own heap of the k best (value, column) pairs per row.
+ * Blocks whose maximum can't beat the worst of a full heap are skipped with
+ * one horizontal max.  The threads' heaps are merged into the output when each
+ * thread's callback is destroyed at the end of the multiply.
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndTopK> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndTopK& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  void Reset(Index rows) {
+    std::fill(config.indices_addr, config.indices_addr + rows * config.k, std::numeric_limits<Index>::max());
+    std::fill(config.scores_addr, config.scores_addr + rows * config.k, -std::numeric_limits<float>::infinity());
+  }
+
+  ~CallbackImpl() {
+    if (heaps.empty()) return;
+    std::vector<Entry> merged;
+#pragma omp critical
+    for (Index row = 0; row < heaps.size(); ++row) {
+      if (heaps[row].empty()) continue;
+      float *scores = config.scores_addr + row * config.k;
+      Index *indices = config.indices_addr + row * config.k;
+      merged.assign(heaps[row].begin(), heaps[row].end());
+      for (Index i = 0; i < config.k; ++i) {
+        merged.emplace_back(scores[i], indices[i]);
+      }
+      std::partial_sort(merged.begin(), merged.begin() + config.k, merged.end(), Better);
+      for (Index i = 0; i < config.k; ++i) {
+        scores[i] = merged[i].first;
+        indices[i] = merged[i].second;
+      }
+    }
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    auto result = kernels::unquantize(input, mult_reg);
+    if (config.output_addr) {
+      kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
+    }
+    if (heaps.empty()) {
+      heaps.resize(info.rows);
+    }
+    std::vector<Entry> &heap = heaps[info.row_idx];
+    // Heaps are ordered so the worst entry is at the front.
+    if (heap.size() == config.k && MaxFloat32(result) < heap.front().first) return;
+    alignas(sizeof(vf)) float values[sizeof(vf) / sizeof(float)];
+    *reinterpret_cast<vf*>(values) = result;
+    for (Index i = 0; i < sizeof(vf) / sizeof(float); ++i) {
+      Entry entry(values[i], info.col_idx + i);
+      if (heap.size() < config.k) {
+        heap.push_back(entry);
+        std::push_heap(heap.begin(), heap.end(), Better);
+      } else if (Better(entry, heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), Better);
+        heap.back() = entry;
+        std::push_heap(heap.begin(), heap.end(), Better);
+      }
+    }
+  }
+
+private:
+  typedef std::pair<float, Index> Entry;
+
+  static bool Better(const Entry &a, const Entry &b) {
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+  }
+
+  vf unquant_mult;
+  UnquantizeAndTopK config;
+  std::vector<std::vector<Entry>> heaps;
+};
+
+/*
+ * UnquantizeAndWriteSoftmaxStats
+ *
+ * Online softmax statistics: when a block raises a row's maximum, the sum so
+ * far is rescaled by exp(old max - new max).  Every thread keeps its own
+ * statistics, merged the same way when its callback is destroyed.
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndWriteSoftmaxStats> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndWriteSoftmaxStats& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  void Reset(Index rows) {
+    std::fill(config.row_max, config.row_max + rows, -std::numeric_limits<float>::infinity());
+    std::fill(config.row_sum, config.row_sum + rows, 0.0f);
+  }
+
+  ~CallbackImpl() {
+#pragma omp critical
+    for (Index row = 0; row < thread_max.size(); ++row) {
+      if (thread_max[row] == -std::numeric_limits<float>::infinity()) continue;
+      float &max = config.row_max[row];
+      float &sum = config.row_sum[row];
+      float new_max = std::max(max, thread_max[row]);
+      sum = sum * std::exp(max - new_max) + thread_sum[row] * std::exp(thread_max[row] - new_max);
+      max = new_max;
+    }
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    auto result = kernels::unquantize(input, mult_reg);
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
+    if (thread_max.empty()) {
+      thread_max.assign(info.rows, -std::numeric_limits<float>::infinity());
+      thread_sum.assign(info.rows, 0.0f);
+    }
+    float &max = thread_max[info.row_idx];
+    float &sum = thread_sum[info.row_idx];
+    float block_max = MaxFloat32(result);
+    if (block_max > max) {
+      sum *= std::exp(max - block_max);
+      max = block_max;
+    }
+    sum += AddFloat32(kernels::exp_approx_taylor(sub_ps(result, set1_ps<vf>(max))));
+  }
+
+private:
+  vf unquant_mult;
+  UnquantizeAndWriteSoftmaxStats config;
+  std::vector<float> thread_max;
+  std::vector<float> thread_sum;
+};
+
+/*
+ * UnquantizeAndAddBiasAndWriteAbsMax
+ *
+ * Every thread keeps lane-wise maxima per row, reduced and merged when its
+ * callback is destroyed.
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndAddBiasAndWriteAbsMax> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndAddBiasAndWriteAbsMax& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  void Reset(Index rows) {
+    if (config.row_max) {
+      std::fill(config.row_max, config.row_max + rows, 0.0f);
+    }
+    if (config.global_max) {
+      *config.global_max = 0.0f;
+    }
+  }
+
+  ~CallbackImpl() {
+#pragma omp critical
+    for (Index row = 0; row < thread_max.size() / kLanes; ++row) {
+      float max = *std::max_element(thread_max.begin() + row * kLanes, thread_max.begin() + (row + 1) * kLanes);
+      if (config.row_max) {
+        config.row_max[row] = std::max(config.row_max[row], max);
+      }
+      if (config.global_max) {
+        *config.global_max = std::max(*config.global_max, max);
+      }
+    }
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    auto result = kernels::unquantize(input, mult_reg);
+    if (config.bias_addr) {
+      result = kernels::add_bias(result, config.bias_addr, info.col_idx);
+    }
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
+    if (thread_max.empty()) {
+      thread_max.assign(info.rows * kLanes, 0.0f);
+    }
+    float *max = &thread_max[info.row_idx * kLanes];
+    storeu_ps(max, max_ps(loadu_ps<vf>(max), and_ps(cast_ps(set1_epi32<vi>(kFloatAbsoluteMask)), result)));
+  }
+
+private:
+  static constexpr Index kLanes = sizeof(vf) / sizeof(float);
+
+  vf unquant_mult;
+  UnquantizeAndAddBiasAndWriteAbsMax config;
+  std::vector<float> thread_max;
+};
+
+/*
+ * UnquantizeAndAddBiasAndLayerNorm
+ *
+ * Every thread sums its blocks per row in double.  Merge adds them to the
+ * shared row_sums, which FinishRow turns into the statistics once the row is
+ * complete.
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndAddBiasAndLayerNorm> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndAddBiasAndLayerNorm& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  void Reset(Index rows) {
+    config.row_sums->assign(2 * rows, 0.0);
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    const Index offset = info.row_idx * info.ldc + info.col_idx;
+    auto result = kernels::unquantize(input, mult_reg);
+    result = kernels::add_bias(result, config.bias_addr, info.col_idx);
+    if (config.residual_addr) {
+      result = add_ps(result, *reinterpret_cast<const vf*>(config.residual_addr + offset));
+    }
+    kernels::write(result, config.output_addr, offset);
+    if (thread_sum.empty()) {
+      thread_sum.assign(info.rows, 0.0);
+      thread_sumsq.assign(info.rows, 0.0);
+    }
+    alignas(sizeof(vf)) float values[kLanes];
+    *reinterpret_cast<vf*>(values) = result;
+    double sum = 0.0, sumsq = 0.0;
+    for (Index i = 0; i < kLanes; ++i) {
+      sum += values[i];
+      sumsq += static_cast<double>(values[i]) * values[i];
+    }
+    thread_sum[info.row_idx] += sum;
+    thread_sumsq[info.row_idx] += sumsq;
+  }
+
+  void Merge() {
+    std::vector<double> &row_sums = *config.row_sums;
+    const Index rows = static_cast<Index>(row_sums.size() / 2);
+#pragma omp critical
+    for (Index row = 0; row < thread_sum.size(); ++row) {
+      row_sums[row] += thread_sum[row];
+      row_sums[rows + row] += thread_sumsq[row];
+    }
+  }
+
+  INTGEMM_TARGET void FinishRow(Index row, Index cols, Index ldc) {
+    std::vector<double> &row_sums = *config.row_sums;
+    const Index rows = static_cast<Index>(row_sums.size() / 2);
+    const double mean = row_sums[row] / cols;
+    const double variance = std::max(row_sums[rows + row] / cols - mean * mean, 0.0);
+    const float rstd = static_cast<float>(1.0 / std::sqrt(variance + config.epsilon));
+    config.row_mean[row] = static_cast<float>(mean);
+    config.row_rstd[row] = rstd;
+    const vf mean_reg = set1_ps<vf>(config.row_mean[row]);
+    const vf rstd_reg = set1_ps<vf>(rstd);
+    float *output = config.output_addr + row * ldc;
+    for (Index c = 0; c < cols; c += kLanes) {
+      auto normalized = mul_ps(sub_ps(*reinterpret_cast<const vf*>(output + c), mean_reg), rstd_reg);
+      if (config.gamma) {
+        normalized = mul_ps(normalized, loadu_ps<vf>(config.gamma + c));
+      }
+      if (config.beta) {
+        normalized = add_ps(normalized, loadu_ps<vf>(config.beta + c));
+      }
+      kernels::write(normalized, output, c);
+    }
+  }
+
+private:
+  static constexpr Index kLanes = sizeof(vf) / sizeof(float);
+
+  vf unquant_mult;
+  UnquantizeAndAddBiasAndLayerNorm config;
+  std::vector<double> thread_sum;
+  std::vector<double> thread_sumsq;
+};
+
+/*
+ * UnquantizeZeroPointAndAddBiasAndWrite
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeZeroPointAndAddBiasAndWrite> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeZeroPointAndAddBiasAndWrite& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    vf result;
+    if (config.zero_point_sums) {
+      // Subtract in int32 so sums beyond 2^24 stay exact.
+      result = cvtepi32_ps(sub_epi32(input, *reinterpret_cast<const vi*>(config.zero_point_sums + info.col_idx)));
+    } else {
+      vi zero_point = set1_epi32<vi>(config.row_zero_points[info.row_idx]);
+      vi column_sums = *reinterpret_cast<const vi*>(config.column_sums + info.col_idx);
+      // SSE2 and SSSE3 have no 32-bit mullo; kernels::multiply emulates it.
+      result = cvtepi32_ps(sub_epi32(input, kernels::multiply<int>(zero_point, column_sums)));
+    }
+    result = mul_ps(result, mult_reg);
+    result = kernels::add_bias(result, config.bias_addr, info.col_idx);
+    kernels::write(result, config.output_addr, info.row_idx * info.ldc + info.col_idx);
+  }
+private:
+  vf unquant_mult;
+  UnquantizeZeroPointAndAddBiasAndWrite config;
+};
+
+/*
+ * Activation overloads shared by the callbacks that take an Activation.
+ */
+template <> struct Activations<CPUType::CPU_NAME> {
+  INTGEMM_TARGET static inline vf Activate(vf x, std::integral_constant<Activation, Activation::Identity>) { return x; }
+  INTGEMM_TARGET static inline vf Activate(vf x, std::integral_constant<Activation, Activation::Relu>) { return kernels::relu<float>(x); }
+  INTGEMM_TARGET static inline vf Activate(vf x, std::integral_constant<Activation, Activation::Sigmoid>) { return kernels::sigmoid(x); }
+  INTGEMM_TARGET static inline vf Activate(vf x, std::integral_constant<Activation, Activation::Tanh>) { return kernels::tanh(x); }
+  INTGEMM_TARGET static inline vf Activate(vf x, std::integral_constant<Activation, Activation::Gelu>) { return kernels::gelu(x); }
+  INTGEMM_TARGET static inline vf Activate(vf x, std::integral_constant<Activation, Activation::Silu>) { return kernels::silu(x); }
+};
+
+/*
+ * UnquantizeAndAddBiasAndRequantize
+ */
+template <typename Type, Activation activation> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndAddBiasAndRequantize<Type, activation>> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndAddBiasAndRequantize<Type, activation>& config) : config(config) {
+    static_assert(sizeof(Type) == 1, "Requantizing writes int8_t or uint8_t.");
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+    quant_mult = set1_ps<vf>(config.quant_mult);
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg, quant_mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+    asm ("vmovdqa %1, %0" : "=x" (quant_mult_reg) : "m" (quant_mult));
+#else
+    mult_reg = unquant_mult;
+    quant_mult_reg = quant_mult;
+#endif
+    auto result = kernels::unquantize(input, mult_reg);
+    result = kernels::add_bias(result, config.bias_addr, info.col_idx);
+    result = Activations<CPUType::CPU_NAME>::Activate(result, std::integral_constant<Activation, activation>());
+    auto quantized = kernels::quantize(result, quant_mult_reg);
+    // Only the low sizeof(vi) / 4 bytes are used.
+    auto packed = kernels::downcast32to8(quantized, quantized, quantized, quantized);
+    // Ban -128 like PrepareA.
+#if defined(CALLBACKS_THIS_IS_SSE2)
+    packed = _mm_sub_epi8(packed, _mm_cmpeq_epi8(packed, set1_epi8<vi>(-128)));
+#else
+    packed = max_epi8(packed, set1_epi8<vi>(-127));
+#endif
+    if (std::is_same<Type, uint8_t>::value) {
+      packed = add_epi8(packed, set1_epi8<vi>(127));
+    }
+    Type* output = config.output_addr + info.row_idx * info.ldc + info.col_idx;
+#if defined(CALLBACKS_THIS_IS_SSE2)
+    int32_t low = _mm_cvtsi128_si32(packed);
+    std::memcpy(output, &low, sizeof(low));
+#elif defined(CALLBACKS_THIS_IS_GENERIC)
+    std::memcpy(output, &packed, sizeof(packed) / 4);
+#else
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output), _mm256_castsi256_si128(packed));
+#endif
+  }
+
+private:
+  vf unquant_mult;
+  vf quant_mult;
+  UnquantizeAndAddBiasAndRequantize<Type, activation> config;
+};
+
+/*
+ * UnquantizeAndAddBiasAndGate
+ */
+template <Activation activation> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndAddBiasAndGate<activation>> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndAddBiasAndGate<activation>& config) : config(config) {
+    gate_unquant_mult = set1_ps<vf>(config.gate_unquant_mult);
+    up_unquant_mult = set1_ps<vf>(config.up_unquant_mult);
+  }
+
+  INTGEMM_TARGET void Run(vi gate, vi up, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf gate_mult_reg, up_mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (gate_mult_reg) : "m" (gate_unquant_mult));
+    asm ("vmovdqa %1, %0" : "=x" (up_mult_reg) : "m" (up_unquant_mult));
+#else
+    gate_mult_reg = gate_unquant_mult;
+    up_mult_reg = up_unquant_mult;
+#endif
+    auto gate_result = kernels::unquantize(gate, gate_mult_reg);
+    auto up_result = kernels::unquantize(up, up_mult_reg);
+    if (config.gate_bias_addr) {
+      gate_result = kernels::add_bias(gate_result, config.gate_bias_addr, info.col_idx);
+    }
+    if (config.up_bias_addr) {
+      up_result = kernels::add_bias(up_result, config.up_bias_addr, info.col_idx);
+    }
+    gate_result = Activations<CPUType::CPU_NAME>::Activate(gate_result, std::integral_constant<Activation, activation>());
+    kernels::write(mul_ps(gate_result, up_result), config.output_addr, info.row_idx * info.ldc + info.col_idx);
+  }
+
+private:
+  vf gate_unquant_mult;
+  vf up_unquant_mult;
+  UnquantizeAndAddBiasAndGate<activation> config;
+};
+
+/*
+ * UnquantizeAndAddBiasAndLSTMCell
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndAddBiasAndLSTMCell> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndAddBiasAndLSTMCell& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  INTGEMM_TARGET void Run(vi gate0, vi gate1, vi gate2, vi gate3, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    vf gates[4] = {
+      kernels::unquantize(gate0, mult_reg),
+      kernels::unquantize(gate1, mult_reg),
+      kernels::unquantize(gate2, mult_reg),
+      kernels::unquantize(gate3, mult_reg),
+    };
+    if (config.bias_addr) {
+      for (Index g = 0; g < 4; ++g) {
+        gates[g] = kernels::add_bias(gates[g], config.bias_addr + g * info.cols, info.col_idx);
+      }
+    }
+    auto offset = info.row_idx * info.ldc + info.col_idx;
+    auto cell = *reinterpret_cast<const vf*>(config.cell_addr + offset);
+    cell = add_ps(mul_ps(kernels::sigmoid(gates[1]), cell), mul_ps(kernels::sigmoid(gates[0]), kernels::tanh(gates[2])));
+    kernels::write(cell, config.cell_addr, offset);
+    kernels::write(mul_ps(kernels::sigmoid(gates[3]), kernels::tanh(cell)), config.hidden_addr, offset);
+  }
+
+private:
+  vf unquant_mult;
+  UnquantizeAndAddBiasAndLSTMCell config;
+};
+
+/*
+ * UnquantizeAndAddBiasAndGRUCell
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndAddBiasAndGRUCell> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndAddBiasAndGRUCell& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  INTGEMM_TARGET void Run(vi gate0, vi gate1, vi gate2, vi gate3, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    vf gates[4] = {
+      kernels::unquantize(gate0, mult_reg),
+      kernels::unquantize(gate1, mult_reg),
+      kernels::unquantize(gate2, mult_reg),
+      kernels::unquantize(gate3, mult_reg),
+    };
+    if (config.bias_addr) {
+      for (Index g = 0; g < 4; ++g) {
+        gates[g] = kernels::add_bias(gates[g], config.bias_addr + g * info.cols, info.col_idx);
+      }
+    }
+    auto offset = info.row_idx * info.ldc + info.col_idx;
+    auto candidate = kernels::tanh(add_ps(gates[2], mul_ps(kernels::sigmoid(gates[0]), gates[3])));
+    auto hidden = *reinterpret_cast<const vf*>(config.hidden_addr + offset);
+    // (1 - z) * n + z * h = n + z * (h - n)
+    hidden = add_ps(candidate, mul_ps(kernels::sigmoid(gates[1]), sub_ps(hidden, candidate)));
+    kernels::write(hidden, config.hidden_addr, offset);
+  }
+
+private:
+  vf unquant_mult;
+  UnquantizeAndAddBiasAndGRUCell config;
+};
+
+/*
+ * UnquantizeAndWriteBFloat16
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndWriteBFloat16> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndWriteBFloat16& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    auto result = kernels::unquantize(input, mult_reg);
+    if (config.bias_addr) {
+      result = kernels::add_bias(result, config.bias_addr, info.col_idx);
+    }
+    auto converted = kernels::to_bfloat16(result);
+    auto output = config.output_addr + info.row_idx * info.ldc + info.col_idx;
+#if defined(CALLBACKS_THIS_IS_SSE2)
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output), converted);
+#elif defined(CALLBACKS_THIS_IS_GENERIC)
+    // Only the low half holds values, like SSE2.
+    std::memcpy(output, &converted, sizeof(converted) / 2);
+#else
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output), converted);
+#endif
+  }
+
+private:
+  vf unquant_mult;
+  UnquantizeAndWriteBFloat16 config;
+};
+
+/*
+ * UnquantizeAndWriteFloat16
+ */
+template <> class CallbackImpl<CPUType::CPU_NAME, UnquantizeAndWriteFloat16> {
+public:
+  explicit INTGEMM_TARGET_CONSTRUCTOR CallbackImpl(const UnquantizeAndWriteFloat16& config) : config(config) {
+    unquant_mult = set1_ps<vf>(config.unquant_mult);
+  }
+
+  INTGEMM_TARGET void Run(vi input, const OutputBufferInfo& info) {
+    // Workaround gcc 5 internal compiler error that can't read register members in debug.
+    vf mult_reg;
+#if !defined(__OPTIMIZE__) && (__GNUC__ == 5) && !defined(__clang__) && !defined(__INTEL_COMPILER) && !defined(CALLBACKS_THIS_IS_GENERIC)
+    asm ("vmovdqa %1, %0" : "=x" (mult_reg) : "m" (unquant_mult));
+#else
+    mult_reg = unquant_mult;
+#endif
+    auto result = kernels::unquantize(input, mult_reg);
+    if (config.bias_addr) {
+      result = kernels::add_bias(result, config.bias_addr, info.col_idx);
+    }
+    auto converted = kernels::to_float16(result);
+    auto output = config.output_addr + info.row_idx * info.ldc + info.col_idx;
+#if defined(CALLBACKS_THIS_IS_SSE2)
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output), converted);
+#elif defined(CALLBACKS_THIS_IS_GENERIC)
+    // Only the low half holds values, like SSE2.
+    std::memcpy(output, &converted, sizeof(converted) / 2);
+#else
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output), converted);
+#endif
+  }
+
+private:
+  vf unquant_mult;
+  UnquantizeAndWriteFloat16 config;
+};
+
 }
 }
 
@@ -5,15 +5,22 @@
 namespace intgemm {
 namespace callbacks {
 
+// Most rows a tile callback's RunTile gets at once.
+constexpr Index kTileRows = 8;
+
 struct OutputBufferInfo {
   Index row_idx;
   Index col_idx;
 
   Index rows; // = A_rows
   Index cols; // = B_cols
+  Index ldc; // distance between rows of the output, = cols unless writing into a wider buffer
 
   OutputBufferInfo(Index row_idx, Index col_idx, Index rows, Index cols)
-    : row_idx(row_idx), col_idx(col_idx), rows(rows), cols(cols) {}
+    : row_idx(row_idx), col_idx(col_idx), rows(rows), cols(cols), ldc(cols) {}
+
+  OutputBufferInfo(Index row_idx, Index col_idx, Index rows, Index cols, Index ldc)
+    : row_idx(row_idx), col_idx(col_idx), rows(rows), cols(cols), ldc(ldc) {}
 };
 
 }
@@ -0,0 +1,309 @@
+#pragma once
+
+#include "kernels.h"
+#include "multiply.h"
+#include "types.h"
+
+#include <cstdint>
+#include <cstring>
+
+/* Portable backend for CPUs without SSE2 and for testing with
+ * INTGEMM_CPUID=UNSUPPORTED.  It follows sse2_gemm.h with the Generic
+ * registers, so it needs no instruction set extension and the prepared layout
+ * is the same as SSE2 and SSSE3.  On gcc and clang the registers are vector
+ * extension types; elsewhere they are arrays.  The rest of the library still
+ * includes the x86 intrinsic headers, so this only builds for x86 (or
+ * emscripten, which translates them).  8-bit products are widened to 16 bits
+ * before madd_epi16 so sums are exact in 32 bits.
+ */
+
+namespace intgemm {
+namespace Generic {
+
+static inline Register QuantizerGrab(const float *input, const FRegister quant_mult_reg) {
+  return kernels::quantize(loadu_ps<FRegister>(input), quant_mult_reg);
+}
+
+INTGEMM_SELECT_COL_B(INTGEMM_GENERIC, Register)
+
+class QuantizeTile16 {
+  public:
+    static inline Register Consecutive(FRegister mult_reg, const float *input) {
+      return Tile(mult_reg, input, input + 4);
+    }
+
+    static inline Register ConsecutiveWithWrapping(FRegister mult_reg, const float *input, Index cols_left, Index cols, Index row_step) {
+      return Tile(mult_reg,
+        input,
+        input + 4 + (cols_left <= 4 ? cols * (row_step - 1) : 0));
+    }
+
+    static inline Register ForReshape(FRegister mult_reg, const float *input, int) {
+      return Consecutive(mult_reg, input);
+    }
+
+  private:
+    static inline Register Tile(FRegister mult_reg, const float *input0, const float *input1) {
+      Register g0 = QuantizerGrab(input0, mult_reg);
+      Register g1 = QuantizerGrab(input1, mult_reg);
+      return packs_epi32(g0, g1);
+    }
+};
+
+struct Kernels16 {
+  typedef int16_t Integer;
+
+  // Currently A is prepared by quantization but this could theoretically change.
+  static inline void PrepareA(const float *input, int16_t *output, float quant_mult, Index rows, Index cols) {
+    Quantize(input, output, quant_mult, rows * cols);
+  }
+
+  static void Quantize(const float *input, int16_t *output, float quant_mult, Index size) {
+    assert(size % 8 == 0);
+    assert(reinterpret_cast<uintptr_t>(input) % 16 == 0);
+    assert(reinterpret_cast<uintptr_t>(output) % 16 == 0);
+    FRegister q = set1_ps<FRegister>(quant_mult);
+    const float *end = input + size;
+    for (; input != end; input += 8, output += 8) {
+      *reinterpret_cast<Register*>(output) = QuantizeTile16::Consecutive(q, input);
+    }
+  }
+
+  // Tile size for B; B must be a multiple of this block size.
+  static const Index kBTileRow = 8;
+  static const Index kBTileCol = 8;
+
+  INTGEMM_PREPARE_B_16(INTGEMM_GENERIC, QuantizeTile16)
+  INTGEMM_PREPARE_B_QUANTIZED_TRANSPOSED(INTGEMM_GENERIC, int16_t)
+  INTGEMM_PREPARE_B_TRANSPOSED(INTGEMM_GENERIC, QuantizeTile16, int16_t)
+
+  static void SelectColumnsB(const int16_t *input, int16_t *output, Index rows, const Index *cols_begin, const Index *cols_end) {
+    SelectColumnsOfB((const Register*)input, (Register*)output, rows * 2, cols_begin, cols_end);
+  }
+  INTGEMM_MULTIPLY16(Register, INTGEMM_GENERIC, CPUType::UNSUPPORTED)
+
+  constexpr static const char *const kName = "16-bit Generic";
+
+  static const CPUType kUses = CPUType::UNSUPPORTED;
+};
+
+class QuantizeTile8 {
+  public:
+    static inline Register ForReshape(FRegister mult_reg, const float *input, Index cols) {
+      // Skip a row.
+      return Tile(mult_reg, input, input + 4, input + 2 * cols, input + 2 * cols + 4);
+    }
+
+    static inline Register Consecutive(FRegister mult_reg, const float *input) {
+      return Tile(mult_reg, input, input + 4, input + 8, input + 12);
+    }
+
+    static inline Register ConsecutiveU(FRegister mult_reg, const float *input) {
+      return add_epi8(Tile(mult_reg, input, input + 4, input + 8, input + 12), set1_epi8<Register>(127));
+    }
+
+    static inline Register ConsecutiveWithWrapping(FRegister mult_reg, const float *input, Index cols_left, Index cols, Index row_step) {
+      const float* inputs[4];
+      for (Index i = 0; i < sizeof(inputs) / sizeof(inputs[0]); ++i) {
+        while (cols_left < sizeof(Register) / sizeof(float)) {
+          input += cols * (row_step - 1);
+          cols_left += cols;
+        }
+        inputs[i] = input;
+        input += sizeof(Register) / sizeof(float);
+        cols_left -= sizeof(Register) / sizeof(float);
+      }
+      return Tile(mult_reg, inputs[0], inputs[1], inputs[2], inputs[3]);
+    }
+
+    // Quantize 16xfloat into 16xint8_t
+    static inline Register Tile(FRegister mult_reg, const float *input0, const float *input1, const float *input2, const float *input3) {
+      Register g0 = QuantizerGrab(input0, mult_reg);
+      Register g1 = QuantizerGrab(input1, mult_reg);
+      Register g2 = QuantizerGrab(input2, mult_reg);
+      Register g3 = QuantizerGrab(input3, mult_reg);
+      Register packed = packs_epi16(packs_epi32(g0, g1), packs_epi32(g2, g3));
+      // Ban -128.
+      return max_epi8(packed, set1_epi8<Register>(-127));
+    }
+};
+
+/* Extend the even and odd 8-bit integers of each 16-bit lane to 16 bits.  A
+ * dot product only needs A and B split the same way, so shifts stand in for
+ * the unpacks SSE2 uses and every step is elementwise.
+ */
+static inline void Widen8(Register in, Register &even, Register &odd) {
+  even = srai_epi16<8>(slli_epi16<8>(in));
+  odd = srai_epi16<8>(in);
+}
+
+static inline void Widen8Unsigned(Register in, Register &even, Register &odd) {
+  even = srli_epi16<8>(slli_epi16<8>(in));
+  odd = srli_epi16<8>(in);
+}
+
+/* Widen to 16-bit and use madd_epi16 like SSE2, so nothing saturates.  If
+ * a_unsigned, A is uint8_t as in Multiply8Shift.
+ */
+static inline void DotColumns8WidenedVertical(const Register *A_live, const Register *B_live, Index simd_width, bool a_unsigned, Register *sums) {
+  const Register *A_end = A_live + simd_width;
+  const Register zeros = setzero_si<Register>();
+  for (Index i = 0; i < 8; ++i) sums[i] = zeros;
+  for (; A_live != A_end; ++A_live, B_live += 8) {
+    Register a_even, a_odd;
+    if (a_unsigned) {
+      Widen8Unsigned(*A_live, a_even, a_odd);
+    } else {
+      Widen8(*A_live, a_even, a_odd);
+    }
+    for (Index i = 0; i < 8; ++i) {
+      Register b_even, b_odd;
+      Widen8(B_live[i], b_even, b_odd);
+      sums[i] = add_epi32(sums[i], add_epi32(madd_epi16(a_even, b_even), madd_epi16(a_odd, b_odd)));
+    }
+  }
+}
+
+static inline dvector_t<CPUType::UNSUPPORTED, int> DotColumns8Widened(const Register *A_live, const Register *B_live, Index simd_width, bool a_unsigned) {
+  Register sums[8];
+  DotColumns8WidenedVertical(A_live, B_live, simd_width, a_unsigned, sums);
+  Register pack0123 = Pack0123(sums[0], sums[1], sums[2], sums[3]);
+  Register pack4567 = Pack0123(sums[4], sums[5], sums[6], sums[7]);
+  return PermuteSummer(pack0123, pack4567);
+}
+
+static inline dvector_t<CPUType::UNSUPPORTED, int> DotColumns8(const Register *A_live, const Register *B_live, Index simd_width) {
+  return DotColumns8Widened(A_live, B_live, simd_width, false);
+}
+
+static inline void DotColumns8Vertical(const Register *A_live, const Register *B_live, Index simd_width, Register *sums) {
+  DotColumns8WidenedVertical(A_live, B_live, simd_width, false, sums);
+}
+
+// Scalar Transpose8x8Bytes for INTGEMM_PACK_B_PANEL_8.
+static inline void Transpose8x8Bytes(const int8_t *input, Index cols, int8_t *output, Index stride) {
+  for (Index r = 0; r < 8; ++r) {
+    for (Index c = 0; c < 8; ++c) {
+      output[c * stride + r] = input[r * cols + c];
+    }
+  }
+}
+
+struct Kernels8 {
+  typedef int8_t Integer;
+
+  // Currently A is prepared by quantization but this could theoretically change.
+  static inline void PrepareA(const float *input, int8_t *output, float quant_mult, Index rows, Index cols) {
+    Quantize(input, output, quant_mult, rows * cols);
+  }
+
+ private:
+  INTGEMM_QUANTIZE_THREAD(INTGEMM_GENERIC)
+ public:
+  INTGEMM_QUANTIZE(INTGEMM_GENERIC)
+
+  INTGEMM_PREPARE_A_ROWWISE(INTGEMM_GENERIC)
+
+  // Version with unsigned int + 127
+  static inline void PrepareA(const float *input, uint8_t *output, float quant_mult, Index rows, Index cols) {
+    QuantizeU(input, output, quant_mult, rows * cols);
+  }
+
+  static void QuantizeU(const float *input, uint8_t *output, float quant_mult, Index size) {
+    assert(size % 16 == 0);
+    assert(reinterpret_cast<uintptr_t>(input) % 16 == 0);
+    assert(reinterpret_cast<uintptr_t>(output) % 16 == 0);
+    FRegister q = set1_ps<FRegister>(quant_mult);
+    const float *end = input + size;
+    for (; input != end; input += 16, output += 16) {
+      *reinterpret_cast<Register*>(output) = QuantizeTile8::ConsecutiveU(q, input);
+    }
+  }
+
+  // Asymmetric version: round(input * quant_mult) + zero_point saturated to [0, 255].
+  static void QuantizeZeroPoint(const float *input, uint8_t *output, float quant_mult, int32_t zero_point, Index size) {
+    assert(size % 16 == 0);
+    assert(reinterpret_cast<uintptr_t>(input) % 16 == 0);
+    assert(reinterpret_cast<uintptr_t>(output) % 16 == 0);
+    FRegister q = set1_ps<FRegister>(quant_mult);
+    const Register zero_point_reg = set1_epi32<Register>(zero_point);
+    for (Index i = 0; i < size; i += 4) {
+      Register g = add_epi32(QuantizerGrab(input + i, q), zero_point_reg);
+      for (Index j = 0; j < 4; ++j) {
+        output[i + j] = static_cast<uint8_t>(std::min<int32_t>(std::max<int32_t>(g.lanes[j], 0), 255));
+      }
+    }
+  }
+
+  // Tile size for B; B must be a multiple of this block size.
+  static const Index kBTileRow = 16;
+  static const Index kBTileCol = 8;
+
+  INTGEMM_PREPARE_B_8(INTGEMM_GENERIC, QuantizeTile8)
+  INTGEMM_PREPARE_B_QUANTIZED_TRANSPOSED(INTGEMM_GENERIC, int8_t)
+  INTGEMM_PREPARE_B_TRANSPOSED(INTGEMM_GENERIC, QuantizeTile8, int8_t)
+  INTGEMM_PACK_B_PANEL_8(INTGEMM_GENERIC, QuantizeTile8)
+
+  static void SelectColumnsB(const int8_t *input, int8_t *output, Index rows, const Index *cols_begin, const Index *cols_end) {
+    Generic::SelectColumnsOfB((const Register*)input, (Register*)output, rows, cols_begin, cols_end);
+  }
+
+  template <typename Callback> static void Multiply(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) {
+    MultiplyWidened(A, width, B, false, A_rows, width, B_cols, B_cols, callback);
+  }
+
+  template <typename Callback> static void MultiplyStrided(const int8_t *A, Index lda, const int8_t *B, Index A_rows, Index width, Index B_cols, Index ldc, Callback callback) {
+    MultiplyWidened(A, lda, B, false, A_rows, width, B_cols, ldc, callback);
+  }
+
+  template <class Callback> static void Multiply8Shift(const uint8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) {
+    MultiplyWidened(reinterpret_cast<const int8_t*>(A), width, B, true, A_rows, width, B_cols, B_cols, callback);
+  }
+
+  // Column sums of B, as PrepareBias does with the other backends.
+  template <class Callback> static void PrepareBias(const int8_t *B, Index width, Index B_cols, Callback callback) {
+    AlignedVector<int8_t> ones(width);
+    for (Index i = 0; i < width; ++i) ones[i] = 1;
+    MultiplyWidened(ones.begin(), width, B, false, 1, width, B_cols, B_cols, callback);
+  }
+
+  INTGEMM_MULTIPLY8_GROUPWISE(Register, INTGEMM_GENERIC, CPUType::UNSUPPORTED)
+
+  INTGEMM_MULTIPLY8_DYNAMIC_B(Register, INTGEMM_GENERIC, CPUType::UNSUPPORTED)
+
+  INTGEMM_MULTIPLY8_DUAL(Register, INTGEMM_GENERIC, CPUType::UNSUPPORTED)
+
+  INTGEMM_MULTIPLY8_GATED(Register, INTGEMM_GENERIC, CPUType::UNSUPPORTED)
+  INTGEMM_MULTIPLY8_CELL(Register, INTGEMM_GENERIC, CPUType::UNSUPPORTED)
+
+  INTGEMM_MULTIPLY8_SHORTLIST(Register, INTGEMM_GENERIC, CPUType::UNSUPPORTED)
+
+  constexpr static const char *const kName = "8-bit Generic";
+
+  static const CPUType kUses = CPUType::UNSUPPORTED;
+
+ private:
+  template <typename Callback> static void MultiplyWidened(const int8_t *A, Index lda, const int8_t *B, bool a_unsigned, Index A_rows, Index width, Index B_cols, Index ldc, Callback callback) {
+    assert(width % sizeof(Register) == 0);
+    assert(lda % sizeof(Register) == 0);
+    assert(B_cols % 8 == 0);
+    assert(reinterpret_cast<uintptr_t>(A) % sizeof(Register) == 0);
+    assert(reinterpret_cast<uintptr_t>(B) % sizeof(Register) == 0);
+    const Index simd_width = width / sizeof(Register);
+    auto callback_impl = callbacks::CallbackImpl<CPUType::UNSUPPORTED, Callback>(callback);
+    BeginRows(callback_impl, A_rows, 0);
+    INTGEMM_OMP_FOR
+    for (Index B0_colidx = 0; B0_colidx < B_cols; B0_colidx += 8) {
+      const Register *B0_col = reinterpret_cast<const Register *>(B) + simd_width * B0_colidx;
+      dvector_t<CPUType::UNSUPPORTED, int> tile[callbacks::kTileRows];
+      for (Index A_rowidx = 0; A_rowidx < A_rows; ++A_rowidx) {
+        const Register *A_row = reinterpret_cast<const Register *>(A + A_rowidx * lda);
+        RunCallbackTiled(callback_impl, tile, DotColumns8Widened(A_row, B0_col, simd_width, a_unsigned), A_rowidx, B0_colidx, A_rows, B_cols, ldc);
+      }
+    }
+    FinishRows(callback_impl, A_rows, B_cols, ldc, 0);
+  }
+};
+
+} // namespace Generic
+} // namespace intgemm
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "intgemm/intgemm_config.h"
+#include "aligned.h"
 #include "intrinsics.h"
 #include "types.h"
 
@@ -33,6 +34,7 @@ INTGEMM_INTERLEAVE(INTGEMM_AVX2, __m256i)
 #ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
 INTGEMM_INTERLEAVE(INTGEMM_AVX512BW, __m512i)
 #endif
+INTGEMM_INTERLEAVE(INTGEMM_GENERIC, Generic::Register)
 
 /*
  * Swap vectors.
@@ -52,6 +54,7 @@ INTGEMM_SWAP(INTGEMM_AVX2, __m256i)
 /* Only INTGEMM_AVX512F is necessary but due to GCC 5.4 bug we have to set INTGEMM_AVX512BW */
 INTGEMM_SWAP(INTGEMM_AVX512BW, __m512i)
 #endif
+INTGEMM_SWAP(INTGEMM_GENERIC, Generic::Register)
 
 /* Transpose registers containing 8 packed 16-bit integers.
  * Each 128-bit lane is handled independently.
@@ -107,6 +110,7 @@ INTGEMM_TRANSPOSE16(INTGEMM_AVX2, __m256i)
 /* Only INTGEMM_AVX512F is necessary but due to GCC 5.4 bug we have to set INTGEMM_AVX512BW */
 INTGEMM_TRANSPOSE16(INTGEMM_AVX512BW, __m512i)
 #endif
+INTGEMM_TRANSPOSE16(INTGEMM_GENERIC, Generic::Register)
 
 /* Tranpose registers containing 16 packed 8-bit integers.
  * Each 128-bit lane is handled independently.
@@ -185,6 +189,28 @@ template <class Register> static inline void Transpose8InLane(
 // 257 273
 // ... ...
 #define INTGEMM_PREPARE_B_8(target, QuantClass) \
+/* One block of 8 columns starting at input, where cols is the row stride. */ \
+target static inline void PrepareBPanel(FRegister q, const float *input, Register *output, Index rows, Index cols) { \
+  for (Index r = 0; r < rows; r += sizeof(Register), output += 8) { \
+    /* Quantize and perform a transpose with height sizeof(Register) and width 8. \
+       This isn't quite Transpose8InLane because it's half the number of columns, \
+       so each register starts with two rows instead of being one row. \
+       The quantizers know to skip a row.*/ \
+    output[0] = QuantClass::ForReshape(q, input + cols * (r    ), cols); \
+    output[1] = QuantClass::ForReshape(q, input + cols * (r + 1), cols); \
+    output[2] = QuantClass::ForReshape(q, input + cols * (r + 4), cols); \
+    output[3] = QuantClass::ForReshape(q, input + cols * (r + 5), cols); \
+    output[4] = QuantClass::ForReshape(q, input + cols * (r + 8), cols); \
+    output[5] = QuantClass::ForReshape(q, input + cols * (r + 9), cols); \
+    output[6] = QuantClass::ForReshape(q, input + cols * (r + 12), cols); \
+    output[7] = QuantClass::ForReshape(q, input + cols * (r + 13), cols); \
+    Interleave8(output[0], output[1]); \
+    Interleave8(output[2], output[3]); \
+    Interleave8(output[4], output[5]); \
+    Interleave8(output[6], output[7]); \
+    Transpose16InLane(output[0], output[1], output[2], output[3], output[4], output[5], output[6], output[7]); \
+  } \
+} \
 target static inline void PrepareB(const float *input, int8_t *output_shadow, float quant_mult, Index rows, Index cols) { \
   FRegister q = set1_ps<FRegister>(quant_mult); \
   /* Currently all multipliers have a stride of 8 columns.*/ \
@@ -194,25 +220,32 @@ target static inline void PrepareB(const float *input, int8_t *output_shadow, fl
   assert(reinterpret_cast<uintptr_t>(input) % sizeof(Register) == 0); \
   Register *output = reinterpret_cast<Register*>(output_shadow); \
   assert(reinterpret_cast<uintptr_t>(output) % sizeof(Register) == 0); \
+  for (Index c = 0; c < cols; c += kColStride, output += (rows / sizeof(Register)) * 8) { \
+    PrepareBPanel(q, input + c, output, rows, cols); \
+  } \
+} \
+/* PrepareB with a multiplier for every group of group_size rows and every \
+ * column: quant_mults is (rows / group_size) x cols row major.  One group of \
+ * 8 columns at a time is scaled into a small buffer and quantized with a \
+ * multiplier of 1, so the whole matrix is never copied.*/ \
+target static inline void PrepareBGroupwise(const float *input, int8_t *output_shadow, const float *quant_mults, Index group_size, Index rows, Index cols) { \
+  const Index kColStride = 8; \
+  assert(cols % kColStride == 0); \
+  assert(group_size % sizeof(Register) == 0); \
+  assert(rows % group_size == 0); \
+  Register *output = reinterpret_cast<Register*>(output_shadow); \
+  assert(reinterpret_cast<uintptr_t>(output) % sizeof(Register) == 0); \
+  FRegister one = set1_ps<FRegister>(1.0f); \
+  AlignedVector<float> panel(group_size * kColStride); \
   for (Index c = 0; c < cols; c += kColStride) { \
-    for (Index r = 0; r < rows; r += sizeof(Register), output += 8) { \
-      /* Quantize and perform a transpose with height sizeof(Register) and width 8. \
-         This isn't quite Transpose8InLane because it's half the number of columns, \
-         so each register starts with two rows instead of being one row. \
-         The quantizers know to skip a row.*/ \
-      output[0] = QuantClass::ForReshape(q, input + cols * (r    ) + c, cols); \
-      output[1] = QuantClass::ForReshape(q, input + cols * (r + 1) + c, cols); \
-      output[2] = QuantClass::ForReshape(q, input + cols * (r + 4) + c, cols); \
-      output[3] = QuantClass::ForReshape(q, input + cols * (r + 5) + c, cols); \
-      output[4] = QuantClass::ForReshape(q, input + cols * (r + 8) + c, cols); \
-      output[5] = QuantClass::ForReshape(q, input + cols * (r + 9) + c, cols); \
-      output[6] = QuantClass::ForReshape(q, input + cols * (r + 12) + c, cols); \
-      output[7] = QuantClass::ForReshape(q, input + cols * (r + 13) + c, cols); \
-      Interleave8(output[0], output[1]); \
-      Interleave8(output[2], output[3]); \
-      Interleave8(output[4], output[5]); \
-      Interleave8(output[6], output[7]); \
-      Transpose16InLane(output[0], output[1], output[2], output[3], output[4], output[5], output[6], output[7]); \
+    for (Index g = 0; g < rows; g += group_size, output += (group_size / sizeof(Register)) * 8) { \
+      const float *mult = quant_mults + (g / group_size) * cols + c; \
+      for (Index r = 0; r < group_size; ++r) { \
+        for (Index i = 0; i < kColStride; ++i) { \
+          panel[r * kColStride + i] = input[(g + r) * cols + c + i] * mult[i]; \
+        } \
+      } \
+      PrepareBPanel(one, panel.begin(), output, group_size, kColStride); \
     } \
   } \
 } \
@@ -292,26 +325,111 @@ target static inline void PrepareBTransposed(const float* input, Integer* output
   } \
 }
 
+/* Transpose the 8x8 block of bytes at input, whose rows are cols apart, so
+ * that the 8 bytes of column k go to output + k * stride.
+ */
+INTGEMM_SSE2 static inline void Transpose8x8Bytes(const int8_t *input, Index cols, int8_t *output, Index stride) {
+  __m128i r01 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(input)), _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + cols)));
+  __m128i r23 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + 2 * cols)), _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + 3 * cols)));
+  __m128i r45 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + 4 * cols)), _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + 5 * cols)));
+  __m128i r67 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + 6 * cols)), _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + 7 * cols)));
+  // Rows 0-3 and 4-7 of columns 0-3 and 4-7.
+  __m128i r0123_c0123 = _mm_unpacklo_epi16(r01, r23);
+  __m128i r0123_c4567 = _mm_unpackhi_epi16(r01, r23);
+  __m128i r4567_c0123 = _mm_unpacklo_epi16(r45, r67);
+  __m128i r4567_c4567 = _mm_unpackhi_epi16(r45, r67);
+  // Each holds two whole columns.
+  __m128i c01 = _mm_unpacklo_epi32(r0123_c0123, r4567_c0123);
+  __m128i c23 = _mm_unpackhi_epi32(r0123_c0123, r4567_c0123);
+  __m128i c45 = _mm_unpacklo_epi32(r0123_c4567, r4567_c4567);
+  __m128i c67 = _mm_unpackhi_epi32(r0123_c4567, r4567_c4567);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(output), c01);
+  _mm_storeh_pd(reinterpret_cast<double*>(output + stride), _mm_castsi128_pd(c01));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(output + 2 * stride), c23);
+  _mm_storeh_pd(reinterpret_cast<double*>(output + 3 * stride), _mm_castsi128_pd(c23));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(output + 4 * stride), c45);
+  _mm_storeh_pd(reinterpret_cast<double*>(output + 5 * stride), _mm_castsi128_pd(c45));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(output + 6 * stride), c67);
+  _mm_storeh_pd(reinterpret_cast<double*>(output + 7 * stride), _mm_castsi128_pd(c67));
+}
+
+/*
+ * Pack one block of 8 columns of an unprepared B into PrepareB format, for
+ * multiplying by a B that changes with every call (e.g. attention).  B is
+ * rows x cols, either row major or, if transposed, column major (i.e. B^T is
+ * row major).  The int8_t versions expect values already quantized to
+ * [-127, 127] (e.g. with Quantize); the float versions quantize with
+ * quant_mult.  col is the first of the 8 columns and panel receives
+ * rows / sizeof(Register) * 8 registers.
+ *
+ * Requires INTGEMM_PREPARE_B_8 for the float row major case.
+ */
+#define INTGEMM_PACK_B_PANEL_8(target, Quantizer) \
+target static inline void PackBPanel(const int8_t *input, bool transposed, float /*quant_mult*/, Register *panel, Index rows, Index cols, Index col) { \
+  if (transposed) { \
+    /* Columns are contiguous so this is a copy.*/ \
+    for (Index r = 0; r < rows; r += sizeof(Register)) \
+      for (Index ci = 0; ci < 8; ++ci) \
+        *panel++ = *reinterpret_cast<const Register*>(input + (col + ci) * rows + r); \
+  } else { \
+    /* Transpose 8x8 byte blocks: column ci of rows r..r+7 goes to register ci.*/ \
+    int8_t *out = reinterpret_cast<int8_t*>(panel); \
+    for (Index r = 0; r < rows; r += sizeof(Register), out += 8 * sizeof(Register)) \
+      for (Index ri = 0; ri < sizeof(Register); ri += 8) \
+        Transpose8x8Bytes(input + (r + ri) * cols + col, cols, out + ri, sizeof(Register)); \
+  } \
+} \
+target static inline void PackBPanel(const float *input, bool transposed, float quant_mult, Register *panel, Index rows, Index cols, Index col) { \
+  FRegister q = set1_ps<FRegister>(quant_mult); \
+  if (transposed) { \
+    for (Index r = 0; r < rows; r += sizeof(Register)) \
+      for (Index ci = 0; ci < 8; ++ci) \
+        *panel++ = Quantizer::ConsecutiveWithWrapping(q, input + (col + ci) * rows + r, rows - r, rows, 8); \
+  } else { \
+    PrepareBPanel(q, input + col, panel, rows, cols); \
+  } \
+} \
+
 /* Select columns of B from PrepareB format to PrepareB format.
+ *
+ * The output has cols_end - cols_begin columns rounded up to a multiple of 8;
+ * the padding columns are zero.  Blocks of 8 output columns are split across
+ * threads.  The output is written with streaming stores because large
+ * shortlists don't fit in cache and it is only read later by Multiply.
  */
 #define INTGEMM_SELECT_COL_B(target, Register) \
-target static inline void SelectColumnsOfB(const Register *input, Register *output, Index rows_bytes /* number of bytes in a row */, const Index *cols_begin, const Index *cols_end) { \
-  assert(rows_bytes % sizeof(Register) == 0); \
-  assert((cols_end - cols_begin) % 8 == 0);  \
-  /* Do columns for multiples of 8.*/ \
-  Index register_rows = rows_bytes / sizeof(Register); \
+target static inline void SelectColumnsOfBThread(const Register *input, Register *output, Index register_rows, const Index *cols_begin, Index selected) { \
+  const Register zeros = setzero_si<Register>(); \
   const Register *starts[8]; \
-  for (; cols_begin != cols_end; cols_begin += 8) { \
-    for (Index k = 0; k < 8; ++k) { \
-      starts[k] = input + (cols_begin[k] & 7) + (cols_begin[k] & ~7) * register_rows; \
+  INTGEMM_OMP_FOR \
+  for (Index col = 0; col < selected; col += 8) { \
+    const Index in_block = std::min<Index>(8, selected - col); \
+    for (Index k = 0; k < in_block; ++k) { \
+      starts[k] = input + (cols_begin[col + k] & 7) + (cols_begin[col + k] & ~7) * register_rows; \
     } \
+    Register *out = output + col * register_rows; \
     for (Index r = 0; r < register_rows; ++r) { \
-      for (Index k = 0; k < 8; ++k) { \
-        *(output++) = *starts[k]; \
+      Index k = 0; \
+      for (; k < in_block; ++k) { \
+        stream_si(out++, *starts[k]); \
         starts[k] += 8; \
       } \
+      for (; k < 8; ++k) { \
+        stream_si(out++, zeros); \
+      } \
     } \
   } \
+  /* Streaming stores are weakly ordered. */ \
+  sfence<Register>(); \
+} \
+target static inline void SelectColumnsOfB(const Register *input, Register *output, Index rows_bytes /* number of bytes in a row */, const Index *cols_begin, const Index *cols_end) { \
+  assert(rows_bytes % sizeof(Register) == 0); \
+  assert(reinterpret_cast<uintptr_t>(output) % sizeof(Register) == 0); \
+  const Index selected = static_cast<Index>(cols_end - cols_begin); \
+  INTGEMM_OMP_PARALLEL \
+  { \
+    SelectColumnsOfBThread(input, output, rows_bytes / sizeof(Register), cols_begin, selected); \
+  } \
 }
 
 } // namespace intgemm
@@ -40,10 +40,13 @@
  */
 
 #include <cstdint>
+#include <cstring>
 
 #include "intgemm/intgemm_config.h"
+#include "aligned.h"
 #include "types.h"
 #include "sse2_gemm.h"
+#include "generic_gemm.h"
 #include "ssse3_gemm.h"
 #include "avx2_gemm.h"
 #include "avx512_gemm.h"
@@ -94,9 +97,15 @@ struct Unsupported_8bit {
   static void QuantizeU(const float *, uint8_t *, float, Index) {
     throw UnsupportedCPU();
   }
+  static void QuantizeZeroPoint(const float *, uint8_t *, float, int32_t, Index) {
+    throw UnsupportedCPU();
+  }
   static void PrepareA(const float *, int8_t *, float, Index, Index) {
     throw UnsupportedCPU();
   }
+  static void PrepareARowwise(const float *, int8_t *, float *, float, Index, Index) {
+    throw UnsupportedCPU();
+  }
   static void PrepareBQuantizedTransposed(const int8_t *, int8_t *, Index, Index) {
     throw UnsupportedCPU();
   }
@@ -106,6 +115,9 @@ struct Unsupported_8bit {
   static void PrepareB(const float *, int8_t *, float, Index, Index) {
     throw UnsupportedCPU();
   }
+  static void PrepareBGroupwise(const float *, int8_t *, const float *, Index, Index, Index) {
+    throw UnsupportedCPU();
+  }
   template<class Callback>
   static void PrepareBias(const int8_t *, Index, Index, Callback) {
     throw UnsupportedCPU();
@@ -121,6 +133,38 @@ struct Unsupported_8bit {
   static void Multiply8Shift(const uint8_t *, const int8_t *, Index, Index, Index, Callback) {
     throw UnsupportedCPU();
   }
+  template <typename Callback>
+  static void MultiplyGroupwise(const int8_t *, const int8_t *, const float *, Index, Index, Index, Index, Callback) {
+    throw UnsupportedCPU();
+  }
+  template <typename BType, typename Callback>
+  static void MultiplyDynamicB(const int8_t *, const BType *, float, bool, Index, Index, Index, Callback) {
+    throw UnsupportedCPU();
+  }
+  template <typename Callback>
+  static void MultiplyDual(const int8_t *, const int8_t *, float, Index, const int8_t *, const int8_t *, float, Index, Index, Index, Callback) {
+    throw UnsupportedCPU();
+  }
+  template <typename Callback>
+  static void MultiplyStrided(const int8_t *, Index, const int8_t *, Index, Index, Index, Index, Callback) {
+    throw UnsupportedCPU();
+  }
+  template <typename Callback>
+  static void MultiplyGated(const int8_t *, const int8_t *, Index, Index, Index, Callback) {
+    throw UnsupportedCPU();
+  }
+  template <typename Callback>
+  static void MultiplyCell(const int8_t *, const int8_t *, Index, Index, Index, Callback) {
+    throw UnsupportedCPU();
+  }
+  template <typename Callback>
+  static void MultiplyShortlist(const int8_t *, const int8_t *, Index, Index, const Index *, const Index *, Callback) {
+    throw UnsupportedCPU();
+  }
+  template <typename Callback>
+  static void MultiplyShortlistBatch(const int8_t *, const int8_t *, Index, Index, const Index *, const Index *, const Index *, const Callback *) {
+    throw UnsupportedCPU();
+  }
 
   constexpr static const char *const kName = "8-bit Unsupported";
 };
@@ -153,11 +197,11 @@ CPUType GetCPUID();
  *
  * avx2 if the CPU supports AVX2
  *
- * ssse3 if the CPU supports SSSE3 (this distinction from SSE2 matters for 8-bit)
+ * ssse3 if the CPU supports SSSE3 (8-bit on SSE2 uses a slower fallback)
  *
  * sse2 if the CPU supports SSE2
  *
- * unsupported otherwise
+ * unsupported otherwise, served by the portable Generic backend
  */
 template <class T> T ChooseCPU(T avx512vnni, T avx512bw, T avx2, T ssse3, T sse2, T unsupported) {
   const T ret[] = {unsupported, sse2, ssse3, avx2, avx512bw, avx512vnni};
@@ -190,6 +234,14 @@ struct Int8 {
   // Multiply floats by quant_mult then convert to 8-bit integers with saturation.
   static void (*Quantize)(const float *input, int8_t *output, float quant_mult, Index size);
 
+  // Quantize A with one multiplier per row, so an outlier in one row does not
+  // cost precision in the others.  Row r is quantized with
+  // max_quant / max(|row r|), usually max_quant = 127, and row_scales[r]
+  // receives the inverse.  Unquantize with a row-scaled callback such as
+  // callbacks::UnquantizeRowScaledAndAddBiasAndWrite.  cols must be a multiple
+  // of 64 and input aligned.
+  static void (*PrepareARowwise)(const float *input, int8_t *output, float *row_scales, float max_quant, Index rows, Index cols);
+
   // Multiply floats by quant_mult then convert to 8-bit integers with saturation.
   // A version that adds 127 to each number, making sure that all numbers are positive
   static void (*QuantizeU)(const float *input, uint8_t *output, float quant_mult, Index size);
@@ -209,7 +261,9 @@ struct Int8 {
   // a quantized model on disk then in a CPU-independent fashion.
   static void (*PrepareBTransposed)(const float *input, int8_t *output, float quant_mul, Index inner, Index B_untransposed_cols);
 
-  // Select columns from a prepared B matrix.  The number of selected columns must be a multiple of 8.
+  // Select columns from a prepared B matrix.  If the number of selected
+  // columns is not a multiple of 8, the output is padded with zero columns to
+  // the next multiple of 8, so it needs space for that many.
   static void (*SelectColumnsB)(const int8_t *input, int8_t *output, Index rows, const Index *cols_begin, const Index *cols_end);
 
   // Multiply C = A * B, presuming A and B have been prepared.
@@ -218,6 +272,139 @@ struct Int8 {
     MultiplyImpl<Callback>::run(A, B, A_rows, width, B_cols, callback);
   }
 
+  // Multiply reading and writing views of larger buffers: row i of A starts
+  // at A + i * lda (bytes) and row i of the output at i * ldc (elements), e.g.
+  // to write one head's columns of a [tokens, heads * dim] tensor in place.
+  // lda must keep rows of A aligned like A itself, i.e. a multiple of 64, and
+  // ldc a multiple of 8.  Callbacks see ldc as OutputBufferInfo::ldc.
+  template <typename Callback>
+  static void MultiplyStrided(const int8_t *A, Index lda, const int8_t *B, Index A_rows, Index width, Index B_cols, Index ldc, Callback callback) {
+    MultiplyStridedImpl<Callback>::run(A, lda, B, A_rows, width, B_cols, ldc, callback);
+  }
+
+  // Group-wise quantization of B: every group of group_size rows of B has its
+  // own quantization multiplier for each column.  quant_mults is a
+  // (rows / group_size) x cols row-major matrix.  group_size must divide rows
+  // and be a multiple of the register size (16 bytes for SSE2 and SSSE3, 32
+  // for AVX2, 64 for AVX512), so 64 works on every CPU.  The output is in the
+  // same format as PrepareB.
+  static void (*PrepareBGroupwise)(const float *input, int8_t *output, const float *quant_mults, Index group_size, Index rows, Index cols);
+
+  // Per-column (per output channel) quantization of B: column c is quantized
+  // with quant_mults[c], usually 127.0 / ColumnMaxAbsolute of that column.
+  // Multiply as usual and unquantize with a per-column callback such as
+  // callbacks::UnquantizePerColumnAndAddBiasAndWrite, passing
+  // 1.0 / (A_quant_mult * quant_mults[c]).
+  static inline void PrepareBPerColumn(const float *input, int8_t *output, const float *quant_mults, Index rows, Index cols) {
+    PrepareBGroupwise(input, output, quant_mults, rows, rows, cols);
+  }
+
+  // Multiply C = A * B where B was prepared by PrepareBGroupwise.
+  // group_unquant is a (width / group_size) x B_cols row-major matrix, usually
+  // 1.0 / (A_quant_mult * quant_mults[i]).  Sums are unquantized by group
+  // inside the multiply so the callback receives floats, e.g.
+  // callbacks::Write<float>.
+  template <typename Callback>
+  static void MultiplyGroupwise(const int8_t *A, const int8_t *B, const float *group_unquant, Index group_size, Index A_rows, Index width, Index B_cols, Callback callback) {
+    MultiplyGroupwiseImpl<Callback>::run(A, B, group_unquant, group_size, A_rows, width, B_cols, callback);
+  }
+
+  // Multiply by a B that was not prepared, such as keys or values in
+  // attention that change every call.  B is quantized (e.g. with Quantize)
+  // and width x B_cols row major, or column major if B_transposed (i.e. the
+  // transposed input to PrepareBQuantizedTransposed).  Blocks of B are
+  // prepared on the fly so this costs about one pass over B.
+  template <typename Callback>
+  static void MultiplyDynamicB(const int8_t *A, const int8_t *B, bool B_transposed, Index A_rows, Index width, Index B_cols, Callback callback) {
+    MultiplyDynamicBImpl<int8_t, Callback>::run(A, B, 1.0f, B_transposed, A_rows, width, B_cols, callback);
+  }
+
+  // Same but B is float and quantized on the fly with B_quant_mult.
+  template <typename Callback>
+  static void MultiplyDynamicB(const int8_t *A, const float *B, float B_quant_mult, bool B_transposed, Index A_rows, Index width, Index B_cols, Callback callback) {
+    MultiplyDynamicBImpl<float, Callback>::run(A, B, B_quant_mult, B_transposed, A_rows, width, B_cols, callback);
+  }
+
+  // C = A1 * B1 * unquant_mult1 + A2 * B2 * unquant_mult2 in one pass, e.g.
+  // the input and recurrent products of an RNN cell.  All four matrices are
+  // prepared as usual; A1 is A_rows x width1, B1 is width1 x B_cols, A2 is
+  // A_rows x width2 and B2 is width2 x B_cols.  The callback receives the
+  // unquantized sum, so use callbacks that take floats, like
+  // callbacks::Write<float>.
+  template <typename Callback>
+  static void MultiplyDual(const int8_t *A1, const int8_t *B1, float unquant_mult1, Index width1, const int8_t *A2, const int8_t *B2, float unquant_mult2, Index width2, Index A_rows, Index B_cols, Callback callback) {
+    MultiplyDualImpl<Callback>::run(A1, B1, unquant_mult1, width1, A2, B2, unquant_mult2, width2, A_rows, B_cols, callback);
+  }
+
+  // Interleave two prepared width x cols matrices, e.g. the gate and up
+  // projections of a gated FFN, into a prepared width x (2 * cols) matrix for
+  // MultiplyGated.  cols must be a multiple of 8.
+  static inline void InterleaveGatedB(const int8_t *gate, const int8_t *up, int8_t *output, Index width, Index cols) {
+    const std::size_t block = static_cast<std::size_t>(width) * 8;
+    for (Index c = 0; c < cols; c += 8) {
+      std::memcpy(output, gate + c * width, block);
+      output += block;
+      std::memcpy(output, up + c * width, block);
+      output += block;
+    }
+  }
+
+  // Gated linear unit: act(A * gate) * (A * up) in one pass, where B comes
+  // from InterleaveGatedB and has B_cols = 2 * (output columns).  The callback
+  // gets both sums for each block of output columns; use
+  // callbacks::UnquantizeAndAddBiasAndGate.
+  template <typename Callback>
+  static void MultiplyGated(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) {
+    MultiplyGatedImpl<Callback>::run(A, B, A_rows, width, B_cols, callback);
+  }
+
+  // Interleave four prepared width x cols gate projections of a recurrent cell
+  // into a prepared width x (4 * cols) matrix for MultiplyCell.  The order is
+  // the one the cell callback documents.  cols must be a multiple of 8.
+  static inline void InterleaveCellB(const int8_t *gate0, const int8_t *gate1, const int8_t *gate2, const int8_t *gate3, int8_t *output, Index width, Index cols) {
+    const std::size_t block = static_cast<std::size_t>(width) * 8;
+    const int8_t *gates[4] = {gate0, gate1, gate2, gate3};
+    for (Index c = 0; c < cols; c += 8) {
+      for (const int8_t *gate : gates) {
+        std::memcpy(output, gate + c * width, block);
+        output += block;
+      }
+    }
+  }
+
+  // Recurrent cell update in one pass: A is the concatenated input and
+  // previous hidden state, and B comes from InterleaveCellB with B_cols =
+  // 4 * (hidden size).  Use callbacks::UnquantizeAndAddBiasAndLSTMCell or
+  // callbacks::UnquantizeAndAddBiasAndGRUCell.
+  template <typename Callback>
+  static void MultiplyCell(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) {
+    MultiplyCellImpl<Callback>::run(A, B, A_rows, width, B_cols, callback);
+  }
+
+  // Multiply A by the columns of prepared B listed in [cols_begin, cols_end)
+  // without materializing them with SelectColumnsB.  The number of listed
+  // columns must be a multiple of 8; groups of 8 consecutive columns starting
+  // at a multiple of 8 are fastest.  The output has one column per listed
+  // column, in order.  callbacks::UnquantizeAndAddShortlistBiasAndWrite reads
+  // the bias of the original columns.
+  template <typename Callback>
+  static void MultiplyShortlist(const int8_t *A, const int8_t *B, Index A_rows, Index width, const Index *cols_begin, const Index *cols_end, Callback callback) {
+    MultiplyShortlistImpl<Callback>::run(A, B, A_rows, width, cols_begin, cols_end, callback);
+  }
+
+  // Batched MultiplyShortlist where each group of rows of A (e.g. a sentence)
+  // has its own shortlist.  Group g is rows [row_offsets[g], row_offsets[g+1])
+  // of A times columns cols[col_offsets[g]], ..., cols[col_offsets[g+1] - 1]
+  // of prepared B; every group's shortlist size must be a multiple of 8.
+  // group_callbacks[g] writes the group's output as a dense (rows in group) x
+  // (shortlist size) matrix, so pointing each group's output at consecutive
+  // offsets of one buffer gives a ragged layout.  All groups are scheduled in
+  // one parallel loop.
+  template <typename Callback>
+  static void MultiplyShortlistBatch(const int8_t *A, const int8_t *B, Index width, Index groups, const Index *row_offsets, const Index *col_offsets, const Index *cols, const Callback *group_callbacks) {
+    MultiplyShortlistBatchImpl<Callback>::run(A, B, width, groups, row_offsets, col_offsets, cols, group_callbacks);
+  }
+
   static const char *const kName;
 
 private:
@@ -225,10 +412,74 @@ private:
   struct MultiplyImpl {
     static void (*run)(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback);
   };
+
+  template <typename Callback>
+  struct MultiplyStridedImpl {
+    static void (*run)(const int8_t *A, Index lda, const int8_t *B, Index A_rows, Index width, Index B_cols, Index ldc, Callback callback);
+  };
+
+  template <typename Callback>
+  struct MultiplyDualImpl {
+    static void (*run)(const int8_t *A1, const int8_t *B1, float unquant_mult1, Index width1, const int8_t *A2, const int8_t *B2, float unquant_mult2, Index width2, Index A_rows, Index B_cols, Callback callback);
+  };
+
+  template <typename Callback>
+  struct MultiplyGatedImpl {
+    static void (*run)(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback);
+  };
+
+  template <typename Callback>
+  struct MultiplyCellImpl {
+    static void (*run)(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback);
+  };
+
+  template <typename Callback>
+  struct MultiplyShortlistImpl {
+    static void (*run)(const int8_t *A, const int8_t *B, Index A_rows, Index width, const Index *cols_begin, const Index *cols_end, Callback callback);
+  };
+
+  template <typename Callback>
+  struct MultiplyShortlistBatchImpl {
+    static void (*run)(const int8_t *A, const int8_t *B, Index width, Index groups, const Index *row_offsets, const Index *col_offsets, const Index *cols, const Callback *group_callbacks);
+  };
+
+  template <typename BType, typename Callback>
+  struct MultiplyDynamicBImpl {
+    static void (*run)(const int8_t *A, const BType *B, float B_quant_mult, bool B_transposed, Index A_rows, Index width, Index B_cols, Callback callback);
+  };
+
+  template <typename Callback>
+  struct MultiplyGroupwiseImpl {
+    static void (*run)(const int8_t *A, const int8_t *B, const float *group_unquant, Index group_size, Index A_rows, Index width, Index B_cols, Callback callback);
+  };
 };
 
 template <typename Callback>
-void (*Int8::MultiplyImpl<Callback>::run)(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) = ChooseCPU(OMPParallelWrap<Callback, AVX512VNNI::Kernels8>, OMPParallelWrap<Callback, AVX512BW::Kernels8>, OMPParallelWrap<Callback, AVX2::Kernels8>, OMPParallelWrap<Callback, SSSE3::Kernels8>, Unsupported_8bit::Multiply<Callback>, Unsupported_8bit::Multiply<Callback>);
+void (*Int8::MultiplyImpl<Callback>::run)(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) = ChooseCPU(OMPParallelWrap<Callback, AVX512VNNI::Kernels8>, OMPParallelWrap<Callback, AVX512BW::Kernels8>, OMPParallelWrap<Callback, AVX2::Kernels8>, OMPParallelWrap<Callback, SSSE3::Kernels8>, OMPParallelWrap<Callback, SSE2::Kernels8>, OMPParallelWrap<Callback, Generic::Kernels8>);
+
+template <typename Callback>
+void (*Int8::MultiplyStridedImpl<Callback>::run)(const int8_t *A, Index lda, const int8_t *B, Index A_rows, Index width, Index B_cols, Index ldc, Callback callback) = ChooseCPU(OMPParallelWrapStrided<Callback, AVX512VNNI::Kernels8>, OMPParallelWrapStrided<Callback, AVX512BW::Kernels8>, OMPParallelWrapStrided<Callback, AVX2::Kernels8>, OMPParallelWrapStrided<Callback, SSSE3::Kernels8>, OMPParallelWrapStrided<Callback, SSE2::Kernels8>, OMPParallelWrapStrided<Callback, Generic::Kernels8>);
+
+template <typename Callback>
+void (*Int8::MultiplyDualImpl<Callback>::run)(const int8_t *A1, const int8_t *B1, float unquant_mult1, Index width1, const int8_t *A2, const int8_t *B2, float unquant_mult2, Index width2, Index A_rows, Index B_cols, Callback callback) = ChooseCPU(OMPParallelWrapDual<Callback, AVX512VNNI::Kernels8>, OMPParallelWrapDual<Callback, AVX512BW::Kernels8>, OMPParallelWrapDual<Callback, AVX2::Kernels8>, OMPParallelWrapDual<Callback, SSSE3::Kernels8>, OMPParallelWrapDual<Callback, SSE2::Kernels8>, OMPParallelWrapDual<Callback, Generic::Kernels8>);
+
+template <typename Callback>
+void (*Int8::MultiplyGatedImpl<Callback>::run)(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) = ChooseCPU(OMPParallelWrapGated<Callback, AVX512VNNI::Kernels8>, OMPParallelWrapGated<Callback, AVX512BW::Kernels8>, OMPParallelWrapGated<Callback, AVX2::Kernels8>, OMPParallelWrapGated<Callback, SSSE3::Kernels8>, OMPParallelWrapGated<Callback, SSE2::Kernels8>, OMPParallelWrapGated<Callback, Generic::Kernels8>);
+
+template <typename Callback>
+void (*Int8::MultiplyCellImpl<Callback>::run)(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) = ChooseCPU(OMPParallelWrapCell<Callback, AVX512VNNI::Kernels8>, OMPParallelWrapCell<Callback, AVX512BW::Kernels8>, OMPParallelWrapCell<Callback, AVX2::Kernels8>, OMPParallelWrapCell<Callback, SSSE3::Kernels8>, OMPParallelWrapCell<Callback, SSE2::Kernels8>, OMPParallelWrapCell<Callback, Generic::Kernels8>);
+
+template <typename Callback>
+void (*Int8::MultiplyShortlistImpl<Callback>::run)(const int8_t *A, const int8_t *B, Index A_rows, Index width, const Index *cols_begin, const Index *cols_end, Callback callback) = ChooseCPU(OMPParallelWrapShortlist<Callback, AVX512VNNI::Kernels8>, OMPParallelWrapShortlist<Callback, AVX512BW::Kernels8>, OMPParallelWrapShortlist<Callback, AVX2::Kernels8>, OMPParallelWrapShortlist<Callback, SSSE3::Kernels8>, OMPParallelWrapShortlist<Callback, SSE2::Kernels8>, OMPParallelWrapShortlist<Callback, Generic::Kernels8>);
+
+template <typename Callback>
+void (*Int8::MultiplyShortlistBatchImpl<Callback>::run)(const int8_t *A, const int8_t *B, Index width, Index groups, const Index *row_offsets, const Index *col_offsets, const Index *cols, const Callback *group_callbacks) = ChooseCPU(OMPParallelWrapShortlistBatch<Callback, AVX512VNNI::Kernels8>, OMPParallelWrapShortlistBatch<Callback, AVX512BW::Kernels8>, OMPParallelWrapShortlistBatch<Callback, AVX2::Kernels8>, OMPParallelWrapShortlistBatch<Callback, SSSE3::Kernels8>, OMPParallelWrapShortlistBatch<Callback, SSE2::Kernels8>, OMPParallelWrapShortlistBatch<Callback, Generic::Kernels8>);
+
+template <typename BType, typename Callback>
+void (*Int8::MultiplyDynamicBImpl<BType, Callback>::run)(const int8_t *A, const BType *B, float B_quant_mult, bool B_transposed, Index A_rows, Index width, Index B_cols, Callback callback) = ChooseCPU(OMPParallelWrapDynamicB<BType, Callback, AVX512VNNI::Kernels8>, OMPParallelWrapDynamicB<BType, Callback, AVX512BW::Kernels8>, OMPParallelWrapDynamicB<BType, Callback, AVX2::Kernels8>, OMPParallelWrapDynamicB<BType, Callback, SSSE3::Kernels8>, OMPParallelWrapDynamicB<BType, Callback, SSE2::Kernels8>, OMPParallelWrapDynamicB<BType, Callback, Generic::Kernels8>);
+
+template <typename Callback>
+void (*Int8::MultiplyGroupwiseImpl<Callback>::run)(const int8_t *A, const int8_t *B, const float *group_unquant, Index group_size, Index A_rows, Index width, Index B_cols, Callback callback) = ChooseCPU(OMPParallelWrapGroupwise<Callback, AVX512VNNI::Kernels8>, OMPParallelWrapGroupwise<Callback, AVX512BW::Kernels8>, OMPParallelWrapGroupwise<Callback, AVX2::Kernels8>, OMPParallelWrapGroupwise<Callback, SSSE3::Kernels8>, OMPParallelWrapGroupwise<Callback, SSE2::Kernels8>, OMPParallelWrapGroupwise<Callback, Generic::Kernels8>);
 
 /*
  * 8-bit matrix multiplication with shifting A by 127
@@ -247,14 +498,43 @@ struct Int8Shift {
   // Multiply floats by quant_mult then convert to 8-bit integers with saturation.
   // A version that adds 127 to each number, making sure that all numbers are positive
   static void (*QuantizeU)(const float *input, uint8_t *output, float quant_mult, Index size);
-  
+
+  /* Asymmetric (zero point) quantization of A.  Values are quantized to
+   * round(input * quant_mult) + zero_point saturated to [0, 255], so
+   * activations that are mostly positive (after ReLU or softmax) can use the
+   * full 8-bit range.  Typically quant_mult = 255 / (max - min) and
+   * zero_point = round(-min * quant_mult).
+   *
+   * Multiply the result with Multiply below using the callback
+   * callbacks::UnquantizeZeroPointAndAddBiasAndWrite, which subtracts
+   * zero_point * (column sums of B) computed once by PrepareBZeroPointSums
+   * (or PrepareBColumnSums with per-row zero points).
+   * Beware that except on AVX512VNNI, pairs of products are added with 16-bit
+   * saturation, so B's quantization multiplier should keep
+   * 2 * 255 * max |B| below 32768 (e.g. 64 / max |B| rather than 127).
+   */
+  static void (*QuantizeZeroPoint)(const float *input, uint8_t *output, float quant_mult, int32_t zero_point, Index size);
+
+  static inline void PrepareAZeroPoint(const float *input, int8_t *output, float quant_mult, int32_t zero_point, Index rows, Index cols) {
+    QuantizeZeroPoint(input, reinterpret_cast<uint8_t *>(output), quant_mult, zero_point, rows * cols);
+  }
+
+  // Per-row zero points, one for each of the rows of A.
+  static inline void PrepareAZeroPoint(const float *input, int8_t *output, float quant_mult, const int32_t *zero_points, Index rows, Index cols) {
+    for (Index r = 0; r < rows; ++r) {
+      QuantizeZeroPoint(input + r * cols, reinterpret_cast<uint8_t *>(output) + r * cols, quant_mult, zero_points[r], cols);
+    }
+  }
+
   // Warning: the output of PrepareB depends on the CPU.
   // It will match the Multiply function on the same CPU though.
   static void PrepareB(const float *input, int8_t *output, float quant_mult, Index rows, Index cols) {
     Int8::PrepareB(input, output, quant_mult, rows, cols);
   }
 
-  // Select columns from a prepared B matrix.  The number of selected columns must be a multiple of 8. 
+  // Select columns from a prepared B matrix.  If the number of selected
+  // columns is not a multiple of 8, the output is padded with zero columns to
+  // the next multiple of 8, so it needs space for that many.
   static void SelectColumnsB(const int8_t *input, int8_t *output, Index rows, const Index *cols_begin, const Index *cols_end) {
     Int8::SelectColumnsB(input, output, rows, cols_begin, cols_end);
   }
@@ -275,7 +555,24 @@ struct Int8Shift {
   static void PrepareBias(const int8_t *B, Index width, Index B_cols, Callback callback) {
     PrepareBiasImpl<Callback>::run(B, width, B_cols, callback);
   }
-  
+
+  // Column sums of a prepared B, needed to remove the zero point of A when
+  // unquantizing.  column_sums has B_cols entries and must be aligned.
+  // Compute once with B since they do not depend on A.
+  static inline void PrepareBColumnSums(const int8_t *B, int32_t *column_sums, Index width, Index B_cols) {
+    PrepareBias(B, width, B_cols, callbacks::Write<int>(column_sums));
+  }
+
+  // zero_point * (column sums of B) for one zero point across all of A, kept
+  // in int32 so the callback subtracts them exactly.  zero_point_sums has
+  // B_cols entries and must be aligned.
+  static inline void PrepareBZeroPointSums(const int8_t *B, int32_t zero_point, int32_t *zero_point_sums, Index width, Index B_cols) {
+    PrepareBColumnSums(B, zero_point_sums, width, B_cols);
+    for (Index i = 0; i < B_cols; ++i) {
+      zero_point_sums[i] *= zero_point;
+    }
+  }
+
   static const char *const kName;
 
 private:
@@ -296,10 +593,11 @@ void (*Int8Shift::MultiplyImpl<Callback>::run)(const uint8_t *A, const int8_t *B
     OMPParallelWrap8Shift<Callback, AVX512BW::Kernels8>,
     OMPParallelWrap8Shift<Callback, AVX2::Kernels8>,
     OMPParallelWrap8Shift<Callback, SSSE3::Kernels8>, 
-    Unsupported_8bit::Multiply8Shift<Callback>, Unsupported_8bit::Multiply8Shift<Callback>);
+    OMPParallelWrap8Shift<Callback, SSE2::Kernels8>,
+    OMPParallelWrap8Shift<Callback, Generic::Kernels8>);
 
 template <class Callback>
-void (*Int8Shift::PrepareBiasImpl<Callback>::run)(const int8_t *B, Index width, Index B_cols, Callback callback) = ChooseCPU(AVX512VNNI::Kernels8::PrepareBias<Callback>, AVX512BW::Kernels8::PrepareBias<Callback>, AVX2::Kernels8::PrepareBias<Callback>, SSSE3::Kernels8::PrepareBias<Callback>, SSSE3::Kernels8::PrepareBias<Callback>, Unsupported_8bit::PrepareBias);
+void (*Int8Shift::PrepareBiasImpl<Callback>::run)(const int8_t *B, Index width, Index B_cols, Callback callback) = ChooseCPU(AVX512VNNI::Kernels8::PrepareBias<Callback>, AVX512BW::Kernels8::PrepareBias<Callback>, AVX2::Kernels8::PrepareBias<Callback>, SSSE3::Kernels8::PrepareBias<Callback>, SSE2::Kernels8::PrepareBias<Callback>, Generic::Kernels8::PrepareBias<Callback>);
 
 /*
  * 16-bit matrix multiplication
@@ -336,7 +634,9 @@ struct Int16 {
   // a quantized model on disk then in a CPU-independent fashion.
   static void (*PrepareBTransposed)(const float *input, int16_t *output, float quant_mul, Index inner, Index B_untransposed_cols);
 
-  // Select columns from a prepared B matrix.  The number of selected columns must be a multiple of 8. 
+  // Select columns from a prepared B matrix.  If the number of selected
+  // columns is not a multiple of 8, the output is padded with zero columns to
+  // the next multiple of 8, so it needs space for that many.
   static void (*SelectColumnsB)(const int16_t *input, int16_t *output, Index rows, const Index *cols_begin, const Index *cols_end);
 
   // Multiply C = A * B, presuming A and B have been prepared.
@@ -355,16 +655,29 @@ private:
 };
 
 template <typename Callback>
-void (*Int16::MultiplyImpl<Callback>::run)(const int16_t *A, const int16_t *B, Index A_rows, Index width, Index B_cols, Callback callback) = ChooseCPU(OMPParallelWrap<Callback, AVX512BW::Kernels16> /*TODO VNNI 16-bit. */, OMPParallelWrap<Callback, AVX512BW::Kernels16>, OMPParallelWrap<Callback, AVX2::Kernels16>, OMPParallelWrap<Callback, SSE2::Kernels16>, OMPParallelWrap<Callback, SSE2::Kernels16>, Unsupported_16bit::Multiply<Callback>);
+void (*Int16::MultiplyImpl<Callback>::run)(const int16_t *A, const int16_t *B, Index A_rows, Index width, Index B_cols, Callback callback) = ChooseCPU(OMPParallelWrap<Callback, AVX512BW::Kernels16> /*TODO VNNI 16-bit. */, OMPParallelWrap<Callback, AVX512BW::Kernels16>, OMPParallelWrap<Callback, AVX2::Kernels16>, OMPParallelWrap<Callback, SSE2::Kernels16>, OMPParallelWrap<Callback, SSE2::Kernels16>, OMPParallelWrap<Callback, Generic::Kernels16>);
 
 extern const CPUType kCPU;
 
 // Get the maximum absolute value of an array of floats. The number of floats must be a multiple of 16 and 64-byte aligned.
 extern float (*MaxAbsolute)(const float *begin, const float *end);
 
+// Get the maximum absolute value of each column of a rows x cols row-major
+// matrix, e.g. to choose per-column multipliers for Int8::PrepareBPerColumn.
+// output has cols entries.
+extern void (*ColumnMaxAbsolute)(const float *input, Index rows, Index cols, float *output);
+
 // Get a Quantization value that is equant to the mean of the data +N standard deviations. Use 2 by default
 extern MeanStd (*VectorMeanStd)(const float *begin, const float *end, bool);
 
+// Finish a softmax (or log-softmax) over each row of an output written by
+// callbacks::UnquantizeAndWriteSoftmaxStats, using the row_max and row_sum it
+// collected.  This is one pass over the output instead of the usual two.
+// Row r starts at output + r * ld: pass cols for a dense output, or the ldc
+// given to MultiplyStrided.
+extern void (*FinishSoftmax)(float *output, Index rows, Index cols, Index ld, const float *row_max, const float *row_sum);
+extern void (*FinishLogSoftmax)(float *output, Index rows, Index cols, Index ld, const float *row_max, const float *row_sum);
+
 /* Returns the Mean and the Standard deviation of a vector. 
  * If "absolute" is set to true, it computes the mean and the standard deviation of the absolute values of the vector */
 static inline MeanStd GetVectorMeanStd(const float * begin, const float * end, bool absolute=false) {
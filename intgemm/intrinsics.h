@@ -13,7 +13,12 @@
 #include <wasm_simd128.h>
 #endif
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <limits>
 
 /*
  * NOTE: Please keep intrinsics in alphabetical order.
@@ -34,6 +39,7 @@ template <class Register> static inline Register set1_ps(float to);
 template <class Register> static inline Register setzero_pd();
 template <class Register> static inline Register setzero_ps();
 template <class Register> static inline Register setzero_si();
+template <class Register> static inline void sfence();
 
 /*
  *
@@ -85,9 +91,18 @@ INTGEMM_SSE2 static inline __m128i cvttps_epi32(__m128 a) {
 INTGEMM_SSE2 static inline __m128 div_ps(__m128 a, __m128 b) {
   return _mm_div_ps(a, b);
 }
-/*
- * Missing i32gather_ps for SSE2
- */
+// SSE2 has no gather instruction so load each element.
+template <unsigned Scale>
+INTGEMM_SSE2 static inline __m128 i32gather_ps(float const *base_addr, __m128i vindex) {
+  alignas(16) int32_t indices[4];
+  _mm_store_si128(reinterpret_cast<__m128i*>(indices), vindex);
+  const char *base = reinterpret_cast<const char*>(base_addr);
+  return _mm_setr_ps(
+      *reinterpret_cast<const float*>(base + static_cast<std::ptrdiff_t>(indices[0]) * Scale),
+      *reinterpret_cast<const float*>(base + static_cast<std::ptrdiff_t>(indices[1]) * Scale),
+      *reinterpret_cast<const float*>(base + static_cast<std::ptrdiff_t>(indices[2]) * Scale),
+      *reinterpret_cast<const float*>(base + static_cast<std::ptrdiff_t>(indices[3]) * Scale));
+}
 template <> INTGEMM_SSE2 inline __m128 load_ps<__m128>(const float* from) {
   return _mm_load_ps(from);
 }
@@ -173,6 +188,10 @@ template <> INTGEMM_SSE2 inline __m128 setzero_ps<__m128>() {
 template <> INTGEMM_SSE2 inline __m128i setzero_si<__m128i>() {
   return _mm_setzero_si128();
 }
+// Orders the streaming stores of stream_si before later stores.
+template <> INTGEMM_SSE2 inline void sfence<__m128i>() {
+  _mm_sfence();
+}
 INTGEMM_SSSE3 static inline __m128i sign_epi8(__m128i first, __m128i second) {
   return _mm_sign_epi8(first, second);
 }
@@ -191,6 +210,12 @@ template <int imm8> INTGEMM_SSE2 static inline __m128i srli_epi16(__m128i a) {
 INTGEMM_SSE2 static inline void storeu_ps(float* mem_addr, __m128 a) {
   _mm_storeu_ps(mem_addr, a);
 }
+INTGEMM_SSE2 static inline void stream_si(__m128i* mem_addr, __m128i a) {
+  _mm_stream_si128(mem_addr, a);
+}
+INTGEMM_SSE2 static inline __m128i sub_epi32(__m128i a, __m128i b) {
+  return _mm_sub_epi32(a, b);
+}
 INTGEMM_SSE2 static inline __m128d sub_pd(__m128d a, __m128d b) {
   return _mm_sub_pd(a, b);
 }
@@ -356,6 +381,9 @@ template <> INTGEMM_AVX2 inline __m256 setzero_ps<__m256>() {
 template <> INTGEMM_AVX2 inline __m256i setzero_si<__m256i>() {
   return _mm256_setzero_si256();
 }
+template <> INTGEMM_AVX2 inline void sfence<__m256i>() {
+  _mm_sfence();
+}
 INTGEMM_AVX2 static inline __m256i sign_epi8(__m256i first, __m256i second) {
   return _mm256_sign_epi8(first, second);
 }
@@ -374,6 +402,12 @@ template <int imm8> INTGEMM_AVX2 static inline __m256i srli_epi16(__m256i a) {
 INTGEMM_AVX2 static inline void storeu_ps(float* mem_addr, __m256 a) {
   _mm256_storeu_ps(mem_addr, a);
 }
+INTGEMM_AVX2 static inline void stream_si(__m256i* mem_addr, __m256i a) {
+  _mm256_stream_si256(mem_addr, a);
+}
+INTGEMM_AVX2 static inline __m256i sub_epi32(__m256i a, __m256i b) {
+  return _mm256_sub_epi32(a, b);
+}
 INTGEMM_AVX2 static inline __m256d sub_pd(__m256d a, __m256d b) {
   return _mm256_sub_pd(a, b);
 }
@@ -551,6 +585,9 @@ template <> INTGEMM_AVX512BW inline __m512 setzero_ps<__m512>() {
 template <> INTGEMM_AVX512BW inline __m512i setzero_si<__m512i>() {
   return _mm512_setzero_si512();
 }
+template <> INTGEMM_AVX512BW inline void sfence<__m512i>() {
+  _mm_sfence();
+}
 template <> INTGEMM_AVX512BW inline __m512 load_ps<__m512>(const float* from) {
   return _mm512_load_ps(from);
 }
@@ -572,6 +609,12 @@ template <int imm8> INTGEMM_AVX512BW static inline __m512i srli_epi16(__m512i a)
 INTGEMM_AVX512BW static inline void storeu_ps(float* mem_addr, __m512 a) {
   _mm512_storeu_ps(mem_addr, a);
 }
+INTGEMM_AVX512BW static inline void stream_si(__m512i* mem_addr, __m512i a) {
+  _mm512_stream_si512(mem_addr, a);
+}
+INTGEMM_AVX512BW static inline __m512i sub_epi32(__m512i a, __m512i b) {
+  return _mm512_sub_epi32(a, b);
+}
 INTGEMM_AVX512BW static inline __m512d sub_pd(__m512d a, __m512d b) {
   return _mm512_sub_pd(a, b);
 }
@@ -608,4 +651,433 @@ INTGEMM_AVX512BW static inline __m512i xor_si(__m512i a, __m512i b) {
 
 #endif
 
+/*
+ *
+ * Generic
+ *
+ * Portable versions on Generic registers.  With INTGEMM_GENERIC_VECTORS the
+ * elementwise operations use gcc/clang vector extensions; the rest, and every
+ * operation on other compilers, copy the register into an array of lanes and
+ * loop over it.  Integer arithmetic runs on unsigned lanes so it wraps like
+ * the instructions do.
+ */
+namespace Generic {
+#ifdef INTGEMM_GENERIC_VECTORS
+typedef int8_t Int8x16 __attribute__ ((vector_size (16)));
+typedef uint8_t UInt8x16 __attribute__ ((vector_size (16)));
+typedef int16_t Int16x8 __attribute__ ((vector_size (16)));
+typedef uint16_t UInt16x8 __attribute__ ((vector_size (16)));
+typedef uint32_t UInt32x4 __attribute__ ((vector_size (16)));
+
+// Reinterpret the lanes of a register as another vector type and back.
+template <class Vector, class Reg> static inline Vector As(Reg reg) {
+  return (Vector)reg.lanes;
+}
+template <class Reg, class Vector> static inline Reg To(Vector vector) {
+  Reg ret;
+  ret.lanes = (decltype(ret.lanes))vector;
+  return ret;
+}
+// Lanes of a where mask is set and of b elsewhere.
+template <class Mask, class Vector> static inline Vector Select(Mask mask, Vector a, Vector b) {
+  return (Vector)(((Mask)a & mask) | ((Mask)b & ~mask));
+}
+#endif
+
+template <class Lane, class Reg> struct Lanes {
+  static constexpr Index kCount = sizeof(Reg) / sizeof(Lane);
+  Lane lane[kCount];
+  Lanes() {}
+  explicit Lanes(const Reg &from) { std::memcpy(lane, &from, sizeof(Reg)); }
+  Reg Get() const {
+    Reg ret;
+    std::memcpy(&ret, lane, sizeof(Reg));
+    return ret;
+  }
+};
+
+template <class Lane, class Reg, class Op> static inline Reg Map(Reg a, Op op) {
+  Lanes<Lane, Reg> x(a);
+  for (Index i = 0; i < Lanes<Lane, Reg>::kCount; ++i) x.lane[i] = op(x.lane[i]);
+  return x.Get();
+}
+template <class Lane, class Reg, class Op> static inline Reg Map(Reg a, Reg b, Op op) {
+  Lanes<Lane, Reg> x(a), y(b);
+  for (Index i = 0; i < Lanes<Lane, Reg>::kCount; ++i) x.lane[i] = op(x.lane[i], y.lane[i]);
+  return x.Get();
+}
+template <class Reg, class Lane> static inline Reg Broadcast(Lane value) {
+  Lanes<Lane, Reg> x;
+  for (Index i = 0; i < Lanes<Lane, Reg>::kCount; ++i) x.lane[i] = value;
+  return x.Get();
+}
+template <class To, class From> static inline To Saturate(From value) {
+  return static_cast<To>(std::min<From>(std::max<From>(value, std::numeric_limits<To>::min()), std::numeric_limits<To>::max()));
+}
+// Round half to even like cvtps_epi32 and give INT32_MIN when out of range.
+static inline int32_t ConvertToInt32(float value) {
+  if (!(value >= -2147483648.0f && value < 2147483648.0f)) return std::numeric_limits<int32_t>::min();
+  return static_cast<int32_t>(std::nearbyint(value));
+}
+// Interleave the low or high halves of a and b in Lane sized pieces.
+template <class Lane> static inline Register Unpack(Register a, Register b, Index half) {
+  Lanes<Lane, Register> x(a), y(b), out;
+  const Index count = Lanes<Lane, Register>::kCount / 2;
+  for (Index i = 0; i < count; ++i) {
+    out.lane[2 * i] = x.lane[half * count + i];
+    out.lane[2 * i + 1] = y.lane[half * count + i];
+  }
+  return out.Get();
+}
+} // namespace Generic
+
+static inline Generic::Register abs_epi8(Generic::Register arg) {
+  return Generic::Map<uint8_t>(arg, [](uint8_t x) { return static_cast<uint8_t>(x & 0x80 ? -x : x); });
+}
+static inline Generic::Register add_epi8(Generic::Register a, Generic::Register b) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::Register>(Generic::As<Generic::UInt8x16>(a) + Generic::As<Generic::UInt8x16>(b));
+#else
+  return Generic::Map<uint8_t>(a, b, [](uint8_t x, uint8_t y) { return static_cast<uint8_t>(x + y); });
+#endif
+}
+static inline Generic::Register add_epi16(Generic::Register a, Generic::Register b) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::Register>(Generic::As<Generic::UInt16x8>(a) + Generic::As<Generic::UInt16x8>(b));
+#else
+  return Generic::Map<uint16_t>(a, b, [](uint16_t x, uint16_t y) { return static_cast<uint16_t>(x + y); });
+#endif
+}
+static inline Generic::Register add_epi32(Generic::Register first, Generic::Register second) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::Register>(Generic::As<Generic::UInt32x4>(first) + Generic::As<Generic::UInt32x4>(second));
+#else
+  return Generic::Map<uint32_t>(first, second, [](uint32_t x, uint32_t y) { return x + y; });
+#endif
+}
+static inline Generic::Register adds_epi16(Generic::Register first, Generic::Register second) {
+  return Generic::Map<int16_t>(first, second, [](int16_t x, int16_t y) { return Generic::Saturate<int16_t>(x + y); });
+}
+static inline Generic::DRegister add_pd(Generic::DRegister a, Generic::DRegister b) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::DRegister>(a.lanes + b.lanes);
+#else
+  return Generic::Map<double>(a, b, [](double x, double y) { return x + y; });
+#endif
+}
+static inline Generic::FRegister add_ps(Generic::FRegister a, Generic::FRegister b) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::FRegister>(a.lanes + b.lanes);
+#else
+  return Generic::Map<float>(a, b, [](float x, float y) { return x + y; });
+#endif
+}
+static inline Generic::FRegister and_ps(Generic::FRegister first, Generic::FRegister second) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::FRegister>(Generic::As<Generic::UInt32x4>(first) & Generic::As<Generic::UInt32x4>(second));
+#else
+  return Generic::Map<uint32_t>(first, second, [](uint32_t x, uint32_t y) { return x & y; });
+#endif
+}
+static inline Generic::FRegister andnot_ps(Generic::FRegister a, Generic::FRegister b) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::FRegister>(~Generic::As<Generic::UInt32x4>(a) & Generic::As<Generic::UInt32x4>(b));
+#else
+  return Generic::Map<uint32_t>(a, b, [](uint32_t x, uint32_t y) { return ~x & y; });
+#endif
+}
+static inline Generic::Register and_si(Generic::Register a, Generic::Register b) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::Register>(a.lanes & b.lanes);
+#else
+  return Generic::Map<uint32_t>(a, b, [](uint32_t x, uint32_t y) { return x & y; });
+#endif
+}
+static inline Generic::FRegister cast_ps(Generic::Register a) {
+  Generic::FRegister ret;
+  std::memcpy(&ret, &a, sizeof(ret));
+  return ret;
+}
+static inline Generic::FRegister cvtepi32_ps(Generic::Register arg) {
+  Generic::FRegister ret;
+  for (Index i = 0; i < 4; ++i) ret.lanes[i] = static_cast<float>(arg.lanes[i]);
+  return ret;
+}
+static inline Generic::Register cvtps_epi32(Generic::FRegister arg) {
+  Generic::Register ret;
+  for (Index i = 0; i < 4; ++i) ret.lanes[i] = Generic::ConvertToInt32(arg.lanes[i]);
+  return ret;
+}
+static inline Generic::Register cvttps_epi32(Generic::FRegister a) {
+  Generic::Register ret;
+  for (Index i = 0; i < 4; ++i) ret.lanes[i] = Generic::ConvertToInt32(std::trunc(a.lanes[i]));
+  return ret;
+}
+static inline Generic::FRegister div_ps(Generic::FRegister a, Generic::FRegister b) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::FRegister>(a.lanes / b.lanes);
+#else
+  return Generic::Map<float>(a, b, [](float x, float y) { return x / y; });
+#endif
+}
+template <unsigned Scale>
+static inline Generic::FRegister i32gather_ps(float const *base_addr, Generic::Register vindex) {
+  const char *base = reinterpret_cast<const char*>(base_addr);
+  Generic::FRegister ret;
+  for (Index i = 0; i < 4; ++i) {
+    float value;
+    std::memcpy(&value, base + static_cast<std::ptrdiff_t>(vindex.lanes[i]) * Scale, sizeof(float));
+    ret.lanes[i] = value;
+  }
+  return ret;
+}
+template <> inline Generic::FRegister load_ps<Generic::FRegister>(const float* from) {
+  Generic::FRegister ret;
+  std::memcpy(&ret, from, sizeof(ret));
+  return ret;
+}
+template <> inline Generic::FRegister loadu_ps(const float* mem_addr) {
+  Generic::FRegister ret;
+  std::memcpy(&ret, mem_addr, sizeof(ret));
+  return ret;
+}
+static inline Generic::Register madd_epi16(Generic::Register first, Generic::Register second) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  // Sign extend the even and odd 16-bit halves of each 32-bit lane.
+  Generic::Int32x4 a_even = (Generic::Int32x4)(Generic::As<Generic::UInt32x4>(first) << 16) >> 16;
+  Generic::Int32x4 b_even = (Generic::Int32x4)(Generic::As<Generic::UInt32x4>(second) << 16) >> 16;
+  Generic::Int32x4 a_odd = first.lanes >> 16;
+  Generic::Int32x4 b_odd = second.lanes >> 16;
+  // Only -32768 * -32768 twice overflows; it wraps like the instruction.
+  return Generic::To<Generic::Register>((Generic::UInt32x4)(a_even * b_even) + (Generic::UInt32x4)(a_odd * b_odd));
+#else
+  Generic::Lanes<int16_t, Generic::Register> a(first), b(second);
+  Generic::Register ret;
+  for (Index i = 0; i < 4; ++i) {
+    // Only -32768 * -32768 twice overflows; it wraps like the instruction.
+    ret.lanes[i] = static_cast<int32_t>(
+        static_cast<uint32_t>(a.lane[2 * i] * b.lane[2 * i]) + static_cast<uint32_t>(a.lane[2 * i + 1] * b.lane[2 * i + 1]));
+  }
+  return ret;
+#endif
+}
+static inline Generic::Register maddubs_epi16(Generic::Register first, Generic::Register second) {
+  Generic::Lanes<uint8_t, Generic::Register> a(first);
+  Generic::Lanes<int8_t, Generic::Register> b(second);
+  Generic::Lanes<int16_t, Generic::Register> ret;
+  for (Index i = 0; i < 8; ++i) {
+    ret.lane[i] = Generic::Saturate<int16_t>(a.lane[2 * i] * b.lane[2 * i] + a.lane[2 * i + 1] * b.lane[2 * i + 1]);
+  }
+  return ret.Get();
+}
+static inline Generic::Register max_epi8(Generic::Register first, Generic::Register second) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  Generic::Int8x16 a = Generic::As<Generic::Int8x16>(first), b = Generic::As<Generic::Int8x16>(second);
+  return Generic::To<Generic::Register>(Generic::Select(a > b, a, b));
+#else
+  return Generic::Map<int8_t>(first, second, [](int8_t x, int8_t y) { return std::max(x, y); });
+#endif
+}
+static inline Generic::Register max_epi16(Generic::Register first, Generic::Register second) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  Generic::Int16x8 a = Generic::As<Generic::Int16x8>(first), b = Generic::As<Generic::Int16x8>(second);
+  return Generic::To<Generic::Register>(Generic::Select(a > b, a, b));
+#else
+  return Generic::Map<int16_t>(first, second, [](int16_t x, int16_t y) { return std::max(x, y); });
+#endif
+}
+// Like the instructions, max and min return the second argument unless the first wins the comparison.
+static inline Generic::DRegister max_pd(Generic::DRegister first, Generic::DRegister second) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::DRegister>(Generic::Select(first.lanes > second.lanes, first.lanes, second.lanes));
+#else
+  return Generic::Map<double>(first, second, [](double x, double y) { return x > y ? x : y; });
+#endif
+}
+static inline Generic::FRegister max_ps(Generic::FRegister first, Generic::FRegister second) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::FRegister>(Generic::Select(first.lanes > second.lanes, first.lanes, second.lanes));
+#else
+  return Generic::Map<float>(first, second, [](float x, float y) { return x > y ? x : y; });
+#endif
+}
+static inline Generic::FRegister min_ps(Generic::FRegister a, Generic::FRegister b) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::FRegister>(Generic::Select(a.lanes < b.lanes, a.lanes, b.lanes));
+#else
+  return Generic::Map<float>(a, b, [](float x, float y) { return x < y ? x : y; });
+#endif
+}
+static inline Generic::Register mul_epu32(Generic::Register a, Generic::Register b) {
+  Generic::Lanes<uint32_t, Generic::Register> x(a), y(b);
+  Generic::Lanes<uint64_t, Generic::Register> ret;
+  for (Index i = 0; i < 2; ++i) ret.lane[i] = static_cast<uint64_t>(x.lane[2 * i]) * y.lane[2 * i];
+  return ret.Get();
+}
+static inline Generic::DRegister mul_pd(Generic::DRegister a, Generic::DRegister b) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::DRegister>(a.lanes * b.lanes);
+#else
+  return Generic::Map<double>(a, b, [](double x, double y) { return x * y; });
+#endif
+}
+static inline Generic::FRegister mul_ps(Generic::FRegister a, Generic::FRegister b) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::FRegister>(a.lanes * b.lanes);
+#else
+  return Generic::Map<float>(a, b, [](float x, float y) { return x * y; });
+#endif
+}
+static inline Generic::Register mulhi_epi16(Generic::Register a, Generic::Register b) {
+  return Generic::Map<int16_t>(a, b, [](int16_t x, int16_t y) { return static_cast<int16_t>((x * y) >> 16); });
+}
+static inline Generic::Register mullo_epi16(Generic::Register a, Generic::Register b) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::Register>(Generic::As<Generic::UInt16x8>(a) * Generic::As<Generic::UInt16x8>(b));
+#else
+  return Generic::Map<uint16_t>(a, b, [](uint16_t x, uint16_t y) { return static_cast<uint16_t>(static_cast<uint32_t>(x) * y); });
+#endif
+}
+static inline Generic::Register or_si(Generic::Register a, Generic::Register b) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::Register>(a.lanes | b.lanes);
+#else
+  return Generic::Map<uint32_t>(a, b, [](uint32_t x, uint32_t y) { return x | y; });
+#endif
+}
+static inline Generic::Register packs_epi16(Generic::Register a, Generic::Register b) {
+  Generic::Lanes<int16_t, Generic::Register> x(a), y(b);
+  Generic::Lanes<int8_t, Generic::Register> ret;
+  for (Index i = 0; i < 8; ++i) {
+    ret.lane[i] = Generic::Saturate<int8_t>(x.lane[i]);
+    ret.lane[i + 8] = Generic::Saturate<int8_t>(y.lane[i]);
+  }
+  return ret.Get();
+}
+static inline Generic::Register packs_epi32(Generic::Register a, Generic::Register b) {
+  Generic::Lanes<int16_t, Generic::Register> ret;
+  for (Index i = 0; i < 4; ++i) {
+    ret.lane[i] = Generic::Saturate<int16_t>(a.lanes[i]);
+    ret.lane[i + 4] = Generic::Saturate<int16_t>(b.lanes[i]);
+  }
+  return ret.Get();
+}
+template <> inline Generic::Register set1_epi8<Generic::Register>(int8_t to) {
+  return Generic::Broadcast<Generic::Register>(to);
+}
+template <> inline Generic::Register set1_epi16<Generic::Register>(int16_t to) {
+  return Generic::Broadcast<Generic::Register>(to);
+}
+template <> inline Generic::Register set1_epi32<Generic::Register>(int32_t to) {
+  return Generic::Broadcast<Generic::Register>(to);
+}
+template <> inline Generic::DRegister set1_pd<Generic::DRegister>(double to) {
+  return Generic::Broadcast<Generic::DRegister>(to);
+}
+template <> inline Generic::FRegister set1_ps<Generic::FRegister>(float to) {
+  return Generic::Broadcast<Generic::FRegister>(to);
+}
+template <> inline Generic::DRegister setzero_pd<Generic::DRegister>() {
+  return Generic::Broadcast<Generic::DRegister>(0.0);
+}
+template <> inline Generic::FRegister setzero_ps<Generic::FRegister>() {
+  return Generic::Broadcast<Generic::FRegister>(0.0f);
+}
+template <> inline Generic::Register setzero_si<Generic::Register>() {
+  return Generic::Broadcast<Generic::Register>(int32_t(0));
+}
+// stream_si is an ordinary store here so there is nothing to order.
+template <> inline void sfence<Generic::Register>() {}
+static inline Generic::Register sign_epi8(Generic::Register first, Generic::Register second) {
+  return Generic::Map<int8_t>(first, second, [](int8_t x, int8_t y) {
+    return static_cast<int8_t>(y < 0 ? static_cast<uint8_t>(-static_cast<uint8_t>(x)) : (y == 0 ? 0 : x));
+  });
+}
+template <int imm8> static inline Generic::Register slli_epi16(Generic::Register a) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return imm8 > 15 ? setzero_si<Generic::Register>() : Generic::To<Generic::Register>(Generic::As<Generic::UInt16x8>(a) << (imm8 & 15));
+#else
+  return Generic::Map<uint16_t>(a, [](uint16_t x) { return static_cast<uint16_t>(imm8 > 15 ? 0 : x << imm8); });
+#endif
+}
+template <int imm8> static inline Generic::Register srai_epi16(Generic::Register a) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::Register>(Generic::As<Generic::Int16x8>(a) >> (imm8 > 15 ? 15 : imm8));
+#else
+  return Generic::Map<int16_t>(a, [](int16_t x) { return static_cast<int16_t>(x >> (imm8 > 15 ? 15 : imm8)); });
+#endif
+}
+template <int imm8> static inline Generic::Register srai_epi32(Generic::Register a) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::Register>(a.lanes >> (imm8 > 31 ? 31 : imm8));
+#else
+  return Generic::Map<int32_t>(a, [](int32_t x) { return x >> (imm8 > 31 ? 31 : imm8); });
+#endif
+}
+template <int imm8> static inline Generic::Register srli_epi16(Generic::Register a) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return imm8 > 15 ? setzero_si<Generic::Register>() : Generic::To<Generic::Register>(Generic::As<Generic::UInt16x8>(a) >> (imm8 & 15));
+#else
+  return Generic::Map<uint16_t>(a, [](uint16_t x) { return static_cast<uint16_t>(imm8 > 15 ? 0 : x >> imm8); });
+#endif
+}
+static inline void storeu_ps(float* mem_addr, Generic::FRegister a) {
+  std::memcpy(mem_addr, &a, sizeof(a));
+}
+static inline void stream_si(Generic::Register* mem_addr, Generic::Register a) {
+  *mem_addr = a;
+}
+static inline Generic::Register sub_epi32(Generic::Register a, Generic::Register b) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::Register>(Generic::As<Generic::UInt32x4>(a) - Generic::As<Generic::UInt32x4>(b));
+#else
+  return Generic::Map<uint32_t>(a, b, [](uint32_t x, uint32_t y) { return x - y; });
+#endif
+}
+static inline Generic::DRegister sub_pd(Generic::DRegister a, Generic::DRegister b) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::DRegister>(a.lanes - b.lanes);
+#else
+  return Generic::Map<double>(a, b, [](double x, double y) { return x - y; });
+#endif
+}
+static inline Generic::FRegister sub_ps(Generic::FRegister a, Generic::FRegister b) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::FRegister>(a.lanes - b.lanes);
+#else
+  return Generic::Map<float>(a, b, [](float x, float y) { return x - y; });
+#endif
+}
+static inline Generic::Register unpacklo_epi8(Generic::Register a, Generic::Register b) {
+  return Generic::Unpack<int8_t>(a, b, 0);
+}
+static inline Generic::Register unpackhi_epi8(Generic::Register a, Generic::Register b) {
+  return Generic::Unpack<int8_t>(a, b, 1);
+}
+static inline Generic::Register unpacklo_epi16(Generic::Register a, Generic::Register b) {
+  return Generic::Unpack<int16_t>(a, b, 0);
+}
+static inline Generic::Register unpackhi_epi16(Generic::Register a, Generic::Register b) {
+  return Generic::Unpack<int16_t>(a, b, 1);
+}
+static inline Generic::Register unpacklo_epi32(Generic::Register a, Generic::Register b) {
+  return Generic::Unpack<int32_t>(a, b, 0);
+}
+static inline Generic::Register unpackhi_epi32(Generic::Register a, Generic::Register b) {
+  return Generic::Unpack<int32_t>(a, b, 1);
+}
+static inline Generic::Register unpacklo_epi64(Generic::Register a, Generic::Register b) {
+  return Generic::Unpack<int64_t>(a, b, 0);
+}
+static inline Generic::Register unpackhi_epi64(Generic::Register a, Generic::Register b) {
+  return Generic::Unpack<int64_t>(a, b, 1);
+}
+static inline Generic::Register xor_si(Generic::Register a, Generic::Register b) {
+#ifdef INTGEMM_GENERIC_VECTORS
+  return Generic::To<Generic::Register>(a.lanes ^ b.lanes);
+#else
+  return Generic::Map<uint32_t>(a, b, [](uint32_t x, uint32_t y) { return x ^ y; });
+#endif
+}
+
 }
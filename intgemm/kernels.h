@@ -24,3 +24,7 @@
 #undef KERNELS_THIS_IS_AVX512BW
 #endif
 
+#define KERNELS_THIS_IS_GENERIC
+#include "kernels/implementations.inl"
+#undef KERNELS_THIS_IS_GENERIC
+
@@ -9,8 +9,11 @@
 #elif defined(KERNELS_THIS_IS_AVX512BW)
   #define CPU_NAME AVX512BW
   #define CPU_ATTR INTGEMM_AVX512BW
+#elif defined(KERNELS_THIS_IS_GENERIC)
+  #define CPU_NAME UNSUPPORTED
+  #define CPU_ATTR INTGEMM_GENERIC
 #else
-  #error "Only SSE2, AVX2 and AVX512BW are supported"
+  #error "Only SSE2, AVX2, AVX512BW and Generic are supported"
 #endif
 
 #define vi vector_t<CPUType::CPU_NAME, int>
@@ -88,6 +91,14 @@ CPU_ATTR static inline vd add_bias(vd input, const double* bias_addr, Index bias
   return add_pd(input, bias_term);
 }
 
+/*
+ * Accumulate: input + beta * output[offset...]
+ */
+CPU_ATTR static inline vf accumulate(vf input, const float* output, Index offset, vf beta) {
+  auto existing = *reinterpret_cast<const vf*>(output + offset);
+  return add_ps(input, mul_ps(beta, existing));
+}
+
 /*
  * ReLU
  */
@@ -101,6 +112,8 @@ CPU_ATTR inline vi relu<int8_t>(vi input) {
   return and_si(input, _mm_cmplt_epi8(vconst_zero, input));
 #elif defined(KERNELS_THIS_IS_AVX2)
   return _mm256_max_epi8(input, vconst_zero);
+#elif defined(KERNELS_THIS_IS_GENERIC)
+  return max_epi8(input, vconst_zero);
 #else
   return _mm512_max_epi8(input, vconst_zero);
 #endif
@@ -119,6 +132,8 @@ CPU_ATTR inline vi relu<int>(vi input) {
   return and_si(input, _mm_cmplt_epi32(vconst_zero, input));
 #elif defined(KERNELS_THIS_IS_AVX2)
   return _mm256_max_epi32(input, vconst_zero);
+#elif defined(KERNELS_THIS_IS_GENERIC)
+  return Generic::Map<int32_t>(input, vconst_zero, [](int32_t x, int32_t zero) { return std::max(x, zero); });
 #else
   return _mm512_max_epi32(input, vconst_zero);
 #endif
@@ -162,6 +177,8 @@ CPU_ATTR inline vi multiply<int>(vi a, vi b) {
   return unpacklo_epi32(_mm_shuffle_epi32(even, 0x8 /* = 0 0 2 0 */), _mm_shuffle_epi32(odd, 0x8 /* = 0 0 2 0 */));
 #elif defined(KERNELS_THIS_IS_AVX2)
   return _mm256_mullo_epi32(a, b);
+#elif defined(KERNELS_THIS_IS_GENERIC)
+  return Generic::Map<uint32_t>(a, b, [](uint32_t x, uint32_t y) { return x * y; });
 #else
   return _mm512_mullo_epi32(a, b);
 #endif
@@ -183,7 +200,7 @@ CPU_ATTR inline vd multiply<double>(vd a, vd b) {
 CPU_ATTR static inline vi downcast32to8(vi input1, vi input2, vi input3, vi input4) {
   auto result = packs_epi16(packs_epi32(input1, input2), packs_epi32(input3, input4));
 
-#if defined(KERNELS_THIS_IS_SSE2)
+#if defined(KERNELS_THIS_IS_SSE2) || defined(KERNELS_THIS_IS_GENERIC)
   return result;
 #elif defined(KERNELS_THIS_IS_AVX2)
   return _mm256_shuffle_epi32(_mm256_permute4x64_epi64(result, 0xd8 /* = 0 2 1 3 */), 0xd8 /* = 0 2 1 3 */);
@@ -196,7 +213,7 @@ CPU_ATTR static inline vi downcast32to8(vi input1, vi input2, vi input3, vi inpu
 CPU_ATTR static inline vi downcast32to16(vi input1, vi input2) {
   auto result = packs_epi32(input1, input2);
 
-#if defined(KERNELS_THIS_IS_SSE2)
+#if defined(KERNELS_THIS_IS_SSE2) || defined(KERNELS_THIS_IS_GENERIC)
   return result;
 #elif defined(KERNELS_THIS_IS_AVX2)
   return _mm256_permute4x64_epi64(result, 0xd8 /* = 0 2 1 3 */);
@@ -209,7 +226,7 @@ CPU_ATTR static inline vi downcast32to16(vi input1, vi input2) {
 CPU_ATTR static inline vi downcast16to8(vi input1, vi input2) {
   auto result = packs_epi16(input1, input2);
 
-#if defined(KERNELS_THIS_IS_SSE2)
+#if defined(KERNELS_THIS_IS_SSE2) || defined(KERNELS_THIS_IS_GENERIC)
   return result;
 #elif defined(KERNELS_THIS_IS_AVX2)
   return _mm256_permute4x64_epi64(result, 0xd8 /* = 0 2 1 3 */);
@@ -227,6 +244,8 @@ CPU_ATTR static inline dvector_t<CPUType::CPU_NAME, int16_t> upcast8to16(vi inpu
 
 #if defined(KERNELS_THIS_IS_SSE2)
   auto higher_byte = _mm_cmpgt_epi8(vzero, input);
+#elif defined(KERNELS_THIS_IS_GENERIC)
+  auto higher_byte = Generic::Map<int8_t>(vzero, input, [](int8_t zero, int8_t x) { return static_cast<int8_t>(zero > x ? -1 : 0); });
 #elif defined(KERNELS_THIS_IS_AVX2)
   input = _mm256_permute4x64_epi64(input, 0xd8 /* = 0 2 1 3 */);
   auto higher_byte = _mm256_cmpgt_epi8(vzero, input);
@@ -250,6 +269,8 @@ CPU_ATTR static inline dvector_t<CPUType::CPU_NAME, int> upcast16to32(vi input)
 
 #if defined(KERNELS_THIS_IS_SSE2)
   auto higher_byte = _mm_cmpgt_epi16(vzero, input);
+#elif defined(KERNELS_THIS_IS_GENERIC)
+  auto higher_byte = Generic::Map<int16_t>(vzero, input, [](int16_t zero, int16_t x) { return static_cast<int16_t>(zero > x ? -1 : 0); });
 #elif defined(KERNELS_THIS_IS_AVX2)
   input = _mm256_permute4x64_epi64(input, 0xd8 /* = 0 2 1 3 */);
   auto higher_byte = _mm256_cmpgt_epi16(vzero, input);
@@ -310,6 +331,8 @@ CPU_ATTR static inline vf floor(vf input) {
   return sub_ps(result, and_ps(vconst_one, and_ps(negatives, nonintegers)));
 #elif defined(KERNELS_THIS_IS_AVX2)
   return _mm256_floor_ps(input);
+#elif defined(KERNELS_THIS_IS_GENERIC)
+  return Generic::Map<float>(input, [](float x) { return std::floor(x); });
 #else
   // TODO: It should work but compiler throw the error "incorrect rounding operand"
   // return _mm512_roundscale_round_ps(input, 0, _MM_FROUND_FLOOR);
@@ -328,11 +351,6 @@ CPU_ATTR static inline vf floor(vf input) {
 /*
  * Calculate approximation of e^x using Taylor series and lookup table
  */
-#if defined(KERNELS_THIS_IS_SSE2)
-CPU_ATTR static inline vf exp_approx_taylor(vf) {
-  std::abort();
-}
-#else
 CPU_ATTR static inline vf exp_approx_taylor(vf x) {
   static constexpr int EXP_MIN = -20;
   static constexpr int EXP_MAX = 20;
@@ -385,18 +403,26 @@ CPU_ATTR static inline vf exp_approx_taylor(vf x) {
   auto ea = i32gather_ps<4>(EXP_LOOKUP + EXP_MAX, cvtps_epi32(a));
   return mul_ps(ea, result);
 }
-#endif
 
 /*
  * Sigmoid
  */
-CPU_ATTR static inline vf sigmoid(vf
-#ifndef KERNELS_THIS_IS_SSE2
-    input
-#endif
-    ) {
+CPU_ATTR static inline vf sigmoid(vf input) {
 #if defined(KERNELS_THIS_IS_SSE2)
-  std::abort(); // TODO: missing exp_approx_taylor for SSE2
+  static const auto vconst_zero = setzero_ps<vf>();
+  static const auto vconst_one = set1_ps<vf>(1.f);
+
+  auto x = input;
+  auto minus_x = sub_ps(vconst_zero, x);
+  auto e_x = exp_approx_taylor(x);
+  auto e_minus_x = exp_approx_taylor(minus_x);
+
+  auto sigmoid_case1 = _mm_rcp_ps(add_ps(vconst_one, e_minus_x));
+  auto sigmoid_case2 = mul_ps(e_x, _mm_rcp_ps(add_ps(vconst_one, e_x)));
+
+  // No blendv in SSE2.
+  auto nonnegative_x_mask = _mm_cmplt_ps(vconst_zero, x);
+  return _mm_or_ps(and_ps(nonnegative_x_mask, sigmoid_case2), andnot_ps(nonnegative_x_mask, sigmoid_case1));
 #elif defined(KERNELS_THIS_IS_AVX2)
   static const auto vconst_zero = setzero_ps<vf>();
   static const auto vconst_one = set1_ps<vf>(1.f);
@@ -411,6 +437,24 @@ CPU_ATTR static inline vf sigmoid(vf
 
   auto nonnegative_x_mask = _mm256_cmp_ps(vconst_zero, x, _CMP_LT_OS);
   return _mm256_blendv_ps(sigmoid_case1, sigmoid_case2, nonnegative_x_mask);
+#elif defined(KERNELS_THIS_IS_GENERIC)
+  static const auto vconst_zero = setzero_ps<vf>();
+  static const auto vconst_one = set1_ps<vf>(1.f);
+
+  auto x = input;
+  auto minus_x = sub_ps(vconst_zero, x);
+  auto e_x = exp_approx_taylor(x);
+  auto e_minus_x = exp_approx_taylor(minus_x);
+
+  // There is no reciprocal approximation to lean on, so divide exactly.
+  auto sigmoid_case1 = div_ps(vconst_one, add_ps(vconst_one, e_minus_x));
+  auto sigmoid_case2 = div_ps(e_x, add_ps(vconst_one, e_x));
+
+  vf result;
+  for (Index i = 0; i < 4; ++i) {
+    result.lanes[i] = x.lanes[i] > 0.f ? sigmoid_case2.lanes[i] : sigmoid_case1.lanes[i];
+  }
+  return result;
 #else
   static const auto vconst_zero = setzero_ps<vf>();
   static const auto vconst_one = set1_ps<vf>(1.f);
@@ -431,11 +475,6 @@ CPU_ATTR static inline vf sigmoid(vf
 /*
  * Tanh
  */
-#if defined(KERNELS_THIS_IS_SSE2)
-CPU_ATTR static inline vf tanh(vf) {
-  std::abort(); // TODO: missing exp_approx_taylor for SSE2
-}
-#else
 CPU_ATTR static inline vf tanh(vf input) {
   const static auto vconst_zero = setzero_ps<vf>();
 
@@ -444,6 +483,147 @@ CPU_ATTR static inline vf tanh(vf input) {
 
   return div_ps(sub_ps(e_x, e_minus_x), add_ps(e_x, e_minus_x));
 }
+
+/*
+ * SiLU (swish): x * sigmoid(x)
+ */
+CPU_ATTR static inline vf silu(vf input) {
+  return mul_ps(input, sigmoid(input));
+}
+
+/*
+ * GELU, tanh approximation:
+ *   0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+ * which is x * sigmoid(2 * sqrt(2 / pi) * (x + 0.044715 * x^3)).
+ */
+CPU_ATTR static inline vf gelu(vf input) {
+  static const auto vconst_cubic = set1_ps<vf>(0.044715f);
+  static const auto vconst_scale = set1_ps<vf>(1.5957691216057308f);
+
+  auto x3 = mul_ps(mul_ps(input, input), input);
+  auto inner = mul_ps(vconst_scale, add_ps(input, mul_ps(vconst_cubic, x3)));
+  return mul_ps(input, sigmoid(inner));
+}
+
+/*
+ * Conversion to 16-bit floats, rounding to nearest even.  Both return the
+ * 16-bit values in order in a register of half the width; for SSE2 and Generic
+ * that is the low 64 bits.  The AVX512 multiplies hand their callbacks AVX2
+ * registers, so there are only SSE2, AVX2 and Generic versions.
+ *
+ * bfloat16 is the upper half of a float: add 0x7fff plus the lowest kept bit
+ * and shift.  NaNs are handled separately since rounding could carry them into
+ * infinity.
+ */
+#if defined(KERNELS_THIS_IS_SSE2)
+CPU_ATTR static inline __m128i to_bfloat16(__m128 input) {
+  auto bits = _mm_castps_si128(input);
+  auto lsb = _mm_and_si128(_mm_srli_epi32(bits, 16), _mm_set1_epi32(1));
+  auto rounded = _mm_srai_epi32(_mm_add_epi32(bits, _mm_add_epi32(lsb, _mm_set1_epi32(0x7fff))), 16);
+  auto quiet_nan = _mm_or_si128(_mm_srai_epi32(bits, 16), _mm_set1_epi32(0x40));
+  auto nan_mask = _mm_castps_si128(_mm_cmpunord_ps(input, input));
+  rounded = _mm_or_si128(_mm_and_si128(nan_mask, quiet_nan), _mm_andnot_si128(nan_mask, rounded));
+  // Values are sign extended so the saturating pack keeps all 16 bits.
+  return _mm_packs_epi32(rounded, rounded);
+}
+
+/* IEEE half precision with integer operations, after Fabian Giesen's
+ * float_to_half_fast3_rtne (public domain), since SSE2 has no F16C.  Returns
+ * the bits sign extended in 32-bit lanes.
+ */
+CPU_ATTR static inline __m128i float16_bits(__m128 input) {
+  const __m128i f16max = _mm_set1_epi32((127 + 16) << 23); // Everything this large becomes infinity.
+  const __m128i min_normal = _mm_set1_epi32((127 - 14) << 23); // Smallest float giving a normal half.
+  const __m128i subnorm_magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+  const __m128i normal_bias = _mm_set1_epi32(0xfff - ((127 - 15) << 23)); // Exponent adjustment and rounding.
+
+  auto sign = _mm_and_ps(input, _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u))));
+  auto absf = _mm_xor_ps(input, sign);
+  auto absf_int = _mm_castps_si128(absf);
+  // Infinity or NaN, keeping NaNs quiet.
+  auto is_nan = _mm_castps_si128(_mm_cmpunord_ps(absf, absf));
+  auto inf_or_nan = _mm_or_si128(_mm_and_si128(is_nan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+  auto is_regular = _mm_cmpgt_epi32(f16max, absf_int);
+  auto is_subnormal = _mm_cmpgt_epi32(min_normal, absf_int);
+  // Subnormal results: let the float adder round the mantissa.
+  auto subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absf, _mm_castsi128_ps(subnorm_magic))), subnorm_magic);
+  // Normal results: rebias, round half to even and shift.
+  auto mant_odd = _mm_srai_epi32(_mm_slli_epi32(absf_int, 31 - 13), 31);
+  auto normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absf_int, normal_bias), mant_odd), 13);
+  auto finite = _mm_or_si128(_mm_and_si128(is_subnormal, subnormal), _mm_andnot_si128(is_subnormal, normal));
+  auto magnitude = _mm_or_si128(_mm_and_si128(is_regular, finite), _mm_andnot_si128(is_regular, inf_or_nan));
+  return _mm_or_si128(magnitude, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+}
+
+CPU_ATTR static inline __m128i to_float16(__m128 input) {
+  auto bits = float16_bits(input);
+  return _mm_packs_epi32(bits, bits);
+}
+#elif defined(KERNELS_THIS_IS_AVX2)
+CPU_ATTR static inline __m128i to_bfloat16(__m256 input) {
+  auto bits = _mm256_castps_si256(input);
+  auto lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(1));
+  auto rounded = _mm256_srai_epi32(_mm256_add_epi32(bits, _mm256_add_epi32(lsb, _mm256_set1_epi32(0x7fff))), 16);
+  auto quiet_nan = _mm256_or_si256(_mm256_srai_epi32(bits, 16), _mm256_set1_epi32(0x40));
+  auto nan_mask = _mm256_castps_si256(_mm256_cmp_ps(input, input, _CMP_UNORD_Q));
+  rounded = _mm256_blendv_epi8(rounded, quiet_nan, nan_mask);
+  return _mm_packs_epi32(_mm256_castsi256_si128(rounded), _mm256_extracti128_si256(rounded, 1));
+}
+
+CPU_ATTR static inline __m128i to_float16(__m256 input) {
+  return _mm256_cvtps_ph(input, _MM_FROUND_TO_NEAREST_INT);
+}
+#elif defined(KERNELS_THIS_IS_GENERIC)
+/* Scalar versions of the SSE2 bit manipulation, one lane at a time. */
+static inline uint16_t bfloat16_bits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  if (std::isnan(value)) return static_cast<uint16_t>((bits >> 16) | 0x40);
+  return static_cast<uint16_t>((bits + 0x7fff + ((bits >> 16) & 1)) >> 16);
+}
+
+static inline uint16_t float16_bits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint32_t sign = bits & 0x80000000u;
+  const uint32_t absf_int = bits ^ sign;
+  uint32_t magnitude;
+  if (absf_int >= (127 + 16) << 23) {
+    // Infinity or NaN, keeping NaNs quiet.
+    magnitude = absf_int > 0x7f800000u ? 0x7e00 : 0x7c00;
+  } else if (absf_int < (127 - 14) << 23) {
+    // Subnormal results: let the float adder round the mantissa.
+    const uint32_t subnorm_magic = ((127 - 15) + (23 - 10) + 1) << 23;
+    float absf, magic;
+    std::memcpy(&absf, &absf_int, sizeof(absf));
+    std::memcpy(&magic, &subnorm_magic, sizeof(magic));
+    absf += magic;
+    std::memcpy(&magnitude, &absf, sizeof(magnitude));
+    magnitude -= subnorm_magic;
+  } else {
+    // Normal results: rebias, round half to even and shift.
+    magnitude = (absf_int + 0xfff - ((127 - 15) << 23) + ((absf_int >> 13) & 1)) >> 13;
+  }
+  return static_cast<uint16_t>(magnitude | (sign >> 16));
+}
+
+CPU_ATTR static inline vi to_bfloat16(vf input) {
+  Generic::Lanes<uint16_t, vi> out;
+  for (Index i = 0; i < 4; ++i) {
+    out.lane[i] = bfloat16_bits(input.lanes[i]);
+    out.lane[i + 4] = out.lane[i];
+  }
+  return out.Get();
+}
+
+CPU_ATTR static inline vi to_float16(vf input) {
+  Generic::Lanes<uint16_t, vi> out;
+  for (Index i = 0; i < 4; ++i) {
+    out.lane[i] = float16_bits(input.lanes[i]);
+    out.lane[i + 4] = out.lane[i];
+  }
+  return out.Get();
+}
 #endif
 
 }
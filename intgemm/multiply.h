@@ -1,11 +1,15 @@
 #pragma once
 
 #include "intgemm/intgemm_config.h"
+#include "aligned.h"
 #include "interleave.h"
 #include "intrinsics.h"
 #include "vec_traits.h"
 #include "callbacks.h"
 
+#include <algorithm>
+#include <new>
+
 namespace intgemm {
 
 INTGEMM_SSE2 static inline dvector_t<CPUType::SSE2, int> PermuteSummer(__m128i pack0123, __m128i pack4567) {
@@ -13,6 +17,10 @@ INTGEMM_SSE2 static inline dvector_t<CPUType::SSE2, int> PermuteSummer(__m128i p
   return { pack0123, pack4567 };
 }
 
+static inline dvector_t<CPUType::UNSUPPORTED, int> PermuteSummer(Generic::Register pack0123, Generic::Register pack4567) {
+  return { pack0123, pack4567 };
+}
+
 #ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
 INTGEMM_AVX2 static inline __m256i PermuteSummer(__m256i pack0123, __m256i pack4567) {
   // This instruction generates 1s 2s 3s 4s 5f 6f 7f 8f
@@ -37,12 +45,46 @@ INTGEMM_AVX512BW static inline __m256i PermuteSummer(__m512i pack0123, __m512i p
 }
 #endif
 
+/* The same reductions for float sums, e.g. per-column accumulators that were
+ * unquantized before being added horizontally.
+ */
+INTGEMM_SSE2 static inline dvector_t<CPUType::SSE2, float> PermuteSummer(__m128 pack0123, __m128 pack4567) {
+  return { pack0123, pack4567 };
+}
+
+static inline dvector_t<CPUType::UNSUPPORTED, float> PermuteSummer(Generic::FRegister pack0123, Generic::FRegister pack4567) {
+  return { pack0123, pack4567 };
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+INTGEMM_AVX2 static inline __m256 PermuteSummer(__m256 pack0123, __m256 pack4567) {
+  __m256 rev = _mm256_permute2f128_ps(pack0123, pack4567, 0x21);
+  __m256 blended = _mm256_blend_ps(pack0123, pack4567, 0xf0);
+  return _mm256_add_ps(rev, blended);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+INTGEMM_AVX512BW static inline __m256 PermuteSummer(__m512 pack0123, __m512 pack4567) {
+  __m512d pack0123_64 = _mm512_castps_pd(pack0123);
+  __m512d pack4567_64 = _mm512_castps_pd(pack4567);
+  __m512 mix0 = _mm512_castpd_ps(_mm512_mask_permutex_pd(pack0123_64, 0xcc, pack4567_64, (0 << 4) | (1 << 6)));
+  __m512 mix1 = _mm512_castpd_ps(_mm512_mask_permutex_pd(pack4567_64, 0x33, pack0123_64, 2 | (3 << 2)));
+  __m512 added = _mm512_add_ps(mix0, mix1);
+  return _mm256_add_ps(_mm512_castps512_ps256(added), _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(added), 1)));
+}
+#endif
+
 #ifdef _MSC_VER
 #define INTGEMM_OMP_FOR __pragma(omp for)
 #define INTGEMM_OMP_PARALLEL __pragma(omp parallel)
+#define INTGEMM_OMP_BARRIER __pragma(omp barrier)
+#define INTGEMM_OMP_SINGLE __pragma(omp single)
 #else
 #define INTGEMM_OMP_FOR _Pragma("omp for")
 #define INTGEMM_OMP_PARALLEL _Pragma("omp parallel")
+#define INTGEMM_OMP_BARRIER _Pragma("omp barrier")
+#define INTGEMM_OMP_SINGLE _Pragma("omp single")
 #endif
 
 // Quantize function used for SSSE3 and AVX2.
@@ -85,6 +127,43 @@ target static void Quantize(const float *const input, int8_t *const output, floa
   std::memcpy(output + (size & ~(kBatch - 1)), &result, overhang); \
 }
 
+/* Quantize A with one multiplier per row, chosen so the largest absolute
+ * value in the row maps to max_quant.  row_scales[r] receives the inverse of
+ * the multiplier for unquantizing.  The maximum and the quantization of a row
+ * are done back to back so the row is still in cache for the second read.
+ * Uses QuantizeTile8::Consecutive from the enclosing namespace.
+ */
+#define INTGEMM_PREPARE_A_ROWWISE(target) \
+target static void PrepareARowwiseThread(const float *input, int8_t *output, float *row_scales, float max_quant, Index rows, Index cols) { \
+  const FRegister abs_mask = cast_ps(set1_epi32<Register>(kFloatAbsoluteMask)); \
+  INTGEMM_OMP_FOR \
+  for (Index r = 0; r < rows; ++r) { \
+    const float *row = input + r * cols; \
+    int8_t *output_row = output + r * cols; \
+    FRegister highest = setzero_ps<FRegister>(); \
+    for (Index i = 0; i < cols; i += sizeof(FRegister) / sizeof(float)) { \
+      highest = max_ps(highest, and_ps(abs_mask, load_ps<FRegister>(row + i))); \
+    } \
+    const float row_max = MaxFloat32(highest); \
+    /* An all-zero row quantizes to zeros whatever the multiplier. */ \
+    const float quant_mult = row_max > 0.0f ? max_quant / row_max : 1.0f; \
+    row_scales[r] = 1.0f / quant_mult; \
+    const FRegister q = set1_ps<FRegister>(quant_mult); \
+    for (Index i = 0; i < cols; i += sizeof(Register)) { \
+      *reinterpret_cast<Register*>(output_row + i) = QuantizeTile8::Consecutive(q, row + i); \
+    } \
+  } \
+} \
+target static void PrepareARowwise(const float *input, int8_t *output, float *row_scales, float max_quant, Index rows, Index cols) { \
+  assert(cols % sizeof(Register) == 0); \
+  assert(reinterpret_cast<uintptr_t>(input) % sizeof(Register) == 0); \
+  assert(reinterpret_cast<uintptr_t>(output) % sizeof(Register) == 0); \
+  INTGEMM_OMP_PARALLEL \
+  { \
+    PrepareARowwiseThread(input, output, row_scales, max_quant, rows, cols); \
+  } \
+}
+
 /* Take 4 registers with 32-bit values to be horizontally added.  Reduce them
  * to one register with 32-bit values in the pattern 1 2 3 4 1 2 3 4, leaving
  * the final addition (which crosses 128-bit lanes) to the caller. 
@@ -107,20 +186,387 @@ INTGEMM_PACK0123(INTGEMM_AVX2, __m256i)
 /* Only INTGEMM_AVX512F is necessary but due to GCC 5.4 bug we have to set INTGEMM_AVX512BW */
 INTGEMM_PACK0123(INTGEMM_AVX512BW, __m512i)
 #endif
+INTGEMM_PACK0123(INTGEMM_GENERIC, Generic::Register)
+
+/* Pack0123 for float sums. */
+INTGEMM_SSE2 static inline __m128 Pack0123(__m128 sum0, __m128 sum1, __m128 sum2, __m128 sum3) {
+  __m128 pack01 = _mm_add_ps(_mm_unpacklo_ps(sum0, sum1), _mm_unpackhi_ps(sum0, sum1));
+  __m128 pack23 = _mm_add_ps(_mm_unpacklo_ps(sum2, sum3), _mm_unpackhi_ps(sum2, sum3));
+  return _mm_add_ps(_mm_movelh_ps(pack01, pack23), _mm_movehl_ps(pack23, pack01));
+}
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+INTGEMM_AVX2 static inline __m256 Pack0123(__m256 sum0, __m256 sum1, __m256 sum2, __m256 sum3) {
+  __m256 pack01 = _mm256_add_ps(_mm256_unpacklo_ps(sum0, sum1), _mm256_unpackhi_ps(sum0, sum1));
+  __m256 pack23 = _mm256_add_ps(_mm256_unpacklo_ps(sum2, sum3), _mm256_unpackhi_ps(sum2, sum3));
+  return _mm256_add_ps(_mm256_shuffle_ps(pack01, pack23, 0x44), _mm256_shuffle_ps(pack01, pack23, 0xee));
+}
+#endif
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+INTGEMM_AVX512BW static inline __m512 Pack0123(__m512 sum0, __m512 sum1, __m512 sum2, __m512 sum3) {
+  __m512 pack01 = _mm512_add_ps(_mm512_unpacklo_ps(sum0, sum1), _mm512_unpackhi_ps(sum0, sum1));
+  __m512 pack23 = _mm512_add_ps(_mm512_unpacklo_ps(sum2, sum3), _mm512_unpackhi_ps(sum2, sum3));
+  return _mm512_add_ps(_mm512_shuffle_ps(pack01, pack23, 0x44), _mm512_shuffle_ps(pack01, pack23, 0xee));
+}
+#endif
+static inline Generic::FRegister Pack0123(Generic::FRegister sum0, Generic::FRegister sum1, Generic::FRegister sum2, Generic::FRegister sum3) {
+  const Generic::FRegister *sums[4] = {&sum0, &sum1, &sum2, &sum3};
+  Generic::FRegister ret;
+  for (Index i = 0; i < 4; ++i) {
+    ret.lanes[i] = (sums[i]->lanes[0] + sums[i]->lanes[2]) + (sums[i]->lanes[1] + sums[i]->lanes[3]);
+  }
+  return ret;
+}
+
+template <typename Callback>
+INTGEMM_SSE2 static inline void RunCallback(Callback& callback_impl, dvector_t<CPUType::SSE2, int> total, Index row_idx, Index col_idx, Index rows, Index cols, Index ldc) {
+  callback_impl.Run(total.first, callbacks::OutputBufferInfo(row_idx, col_idx, rows, cols, ldc));
+  callback_impl.Run(total.second, callbacks::OutputBufferInfo(row_idx, col_idx + 4, rows, cols, ldc));
+}
 
 template <typename Callback>
 INTGEMM_SSE2 static inline void RunCallback(Callback& callback_impl, dvector_t<CPUType::SSE2, int> total, Index row_idx, Index col_idx, Index rows, Index cols) {
+  RunCallback(callback_impl, total, row_idx, col_idx, rows, cols, cols);
+}
+
+template <typename Callback>
+static inline void RunCallback(Callback& callback_impl, dvector_t<CPUType::UNSUPPORTED, int> total, Index row_idx, Index col_idx, Index rows, Index cols, Index ldc) {
+  callback_impl.Run(total.first, callbacks::OutputBufferInfo(row_idx, col_idx, rows, cols, ldc));
+  callback_impl.Run(total.second, callbacks::OutputBufferInfo(row_idx, col_idx + 4, rows, cols, ldc));
+}
+
+template <typename Callback>
+static inline void RunCallback(Callback& callback_impl, dvector_t<CPUType::UNSUPPORTED, int> total, Index row_idx, Index col_idx, Index rows, Index cols) {
+  RunCallback(callback_impl, total, row_idx, col_idx, rows, cols, cols);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+template <typename Callback>
+INTGEMM_AVX2 static inline void RunCallback(Callback& callback_impl, vector_t<CPUType::AVX2, int> total, Index row_idx, Index col_idx, Index rows, Index cols, Index ldc) {
+  callback_impl.Run(total, callbacks::OutputBufferInfo(row_idx, col_idx, rows, cols, ldc));
+}
+
+template <typename Callback>
+INTGEMM_AVX2 static inline void RunCallback(Callback& callback_impl, vector_t<CPUType::AVX2, int> total, Index row_idx, Index col_idx, Index rows, Index cols) {
+  callback_impl.Run(total, callbacks::OutputBufferInfo(row_idx, col_idx, rows, cols));
+}
+#endif
+
+/* Tile-granular callbacks.  The multiplies produce one row of 8 output
+ * columns at a time.  Callbacks that implement
+ *   RunTile(const vi* tile, Index tile_rows, const OutputBufferInfo& info)
+ * get up to callbacks::kTileRows consecutive rows of the same 8 columns at once
+ * instead, starting at info.row_idx, in row major order: one register per row,
+ * or two on SSE2 and Generic.  That suits epilogues working on blocks, like
+ * transposes.  The multiplies call RunCallbackTiled for every row with a
+ * buffer for the tile; callbacks without RunTile get the row through Run
+ * straight away, so they are unaffected.  Multiplies that don't tile only call
+ * Run.
+ */
+template <class CallbackImpl> class HasRunTile {
+  template <class C> static auto Test(int) -> decltype(&C::RunTile, std::true_type());
+  template <class C> static std::false_type Test(long);
+public:
+  static constexpr bool value = decltype(Test<CallbackImpl>(0))::value;
+};
+
+template <typename Callback>
+INTGEMM_SSE2 static inline void RunCallbackTiled(Callback& callback_impl, dvector_t<CPUType::SSE2, int>* tile, dvector_t<CPUType::SSE2, int> total, Index row_idx, Index col_idx, Index rows, Index cols, Index ldc, std::true_type) {
+  const Index tile_row = row_idx % callbacks::kTileRows;
+  tile[tile_row] = total;
+  if (tile_row + 1 == callbacks::kTileRows || row_idx + 1 == rows) {
+    callback_impl.RunTile(reinterpret_cast<const __m128i*>(tile), tile_row + 1, callbacks::OutputBufferInfo(row_idx - tile_row, col_idx, rows, cols, ldc));
+  }
+}
+
+template <typename Callback>
+INTGEMM_SSE2 static inline void RunCallbackTiled(Callback& callback_impl, dvector_t<CPUType::SSE2, int>*, dvector_t<CPUType::SSE2, int> total, Index row_idx, Index col_idx, Index rows, Index cols, Index ldc, std::false_type) {
+  RunCallback(callback_impl, total, row_idx, col_idx, rows, cols, ldc);
+}
+
+template <typename Callback>
+INTGEMM_SSE2 static inline void RunCallbackTiled(Callback& callback_impl, dvector_t<CPUType::SSE2, int>* tile, dvector_t<CPUType::SSE2, int> total, Index row_idx, Index col_idx, Index rows, Index cols, Index ldc) {
+  RunCallbackTiled(callback_impl, tile, total, row_idx, col_idx, rows, cols, ldc, std::integral_constant<bool, HasRunTile<Callback>::value>());
+}
+
+template <typename Callback>
+static inline void RunCallbackTiled(Callback& callback_impl, dvector_t<CPUType::UNSUPPORTED, int>* tile, dvector_t<CPUType::UNSUPPORTED, int> total, Index row_idx, Index col_idx, Index rows, Index cols, Index ldc, std::true_type) {
+  const Index tile_row = row_idx % callbacks::kTileRows;
+  tile[tile_row] = total;
+  if (tile_row + 1 == callbacks::kTileRows || row_idx + 1 == rows) {
+    callback_impl.RunTile(reinterpret_cast<const Generic::Register*>(tile), tile_row + 1, callbacks::OutputBufferInfo(row_idx - tile_row, col_idx, rows, cols, ldc));
+  }
+}
+
+template <typename Callback>
+static inline void RunCallbackTiled(Callback& callback_impl, dvector_t<CPUType::UNSUPPORTED, int>*, dvector_t<CPUType::UNSUPPORTED, int> total, Index row_idx, Index col_idx, Index rows, Index cols, Index ldc, std::false_type) {
+  RunCallback(callback_impl, total, row_idx, col_idx, rows, cols, ldc);
+}
+
+template <typename Callback>
+static inline void RunCallbackTiled(Callback& callback_impl, dvector_t<CPUType::UNSUPPORTED, int>* tile, dvector_t<CPUType::UNSUPPORTED, int> total, Index row_idx, Index col_idx, Index rows, Index cols, Index ldc) {
+  RunCallbackTiled(callback_impl, tile, total, row_idx, col_idx, rows, cols, ldc, std::integral_constant<bool, HasRunTile<Callback>::value>());
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+template <typename Callback>
+INTGEMM_AVX2 static inline void RunCallbackTiled(Callback& callback_impl, vector_t<CPUType::AVX2, int>* tile, vector_t<CPUType::AVX2, int> total, Index row_idx, Index col_idx, Index rows, Index cols, Index ldc, std::true_type) {
+  const Index tile_row = row_idx % callbacks::kTileRows;
+  tile[tile_row] = total;
+  if (tile_row + 1 == callbacks::kTileRows || row_idx + 1 == rows) {
+    callback_impl.RunTile(reinterpret_cast<const __m256i*>(tile), tile_row + 1, callbacks::OutputBufferInfo(row_idx - tile_row, col_idx, rows, cols, ldc));
+  }
+}
+
+template <typename Callback>
+INTGEMM_AVX2 static inline void RunCallbackTiled(Callback& callback_impl, vector_t<CPUType::AVX2, int>*, vector_t<CPUType::AVX2, int> total, Index row_idx, Index col_idx, Index rows, Index cols, Index ldc, std::false_type) {
+  RunCallback(callback_impl, total, row_idx, col_idx, rows, cols, ldc);
+}
+
+template <typename Callback>
+INTGEMM_AVX2 static inline void RunCallbackTiled(Callback& callback_impl, vector_t<CPUType::AVX2, int>* tile, vector_t<CPUType::AVX2, int> total, Index row_idx, Index col_idx, Index rows, Index cols, Index ldc) {
+  RunCallbackTiled(callback_impl, tile, total, row_idx, col_idx, rows, cols, ldc, std::integral_constant<bool, HasRunTile<Callback>::value>());
+}
+#endif
+
+/* Versions for multiplies that unquantize inside the kernel and hand floats to
+ * the callback.
+ */
+template <typename Callback>
+INTGEMM_SSE2 static inline void RunCallback(Callback& callback_impl, dvector_t<CPUType::SSE2, float> total, Index row_idx, Index col_idx, Index rows, Index cols) {
+  callback_impl.Run(total.first, callbacks::OutputBufferInfo(row_idx, col_idx, rows, cols));
+  callback_impl.Run(total.second, callbacks::OutputBufferInfo(row_idx, col_idx + 4, rows, cols));
+}
+
+template <typename Callback>
+static inline void RunCallback(Callback& callback_impl, dvector_t<CPUType::UNSUPPORTED, float> total, Index row_idx, Index col_idx, Index rows, Index cols) {
   callback_impl.Run(total.first, callbacks::OutputBufferInfo(row_idx, col_idx, rows, cols));
   callback_impl.Run(total.second, callbacks::OutputBufferInfo(row_idx, col_idx + 4, rows, cols));
 }
 
 #ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
 template <typename Callback>
-INTGEMM_AVX2 static inline void RunCallback(Callback& callback_impl, vector_t<CPUType::AVX2, int> total, Index row_idx, Index col_idx, Index rows, Index cols) {
+INTGEMM_AVX2 static inline void RunCallback(Callback& callback_impl, vector_t<CPUType::AVX2, float> total, Index row_idx, Index col_idx, Index rows, Index cols) {
   callback_impl.Run(total, callbacks::OutputBufferInfo(row_idx, col_idx, rows, cols));
 }
 #endif
 
+/* Versions for MultiplyGated, which hands the callback the gate and up sums
+ * of the same output columns.
+ */
+template <typename Callback>
+INTGEMM_SSE2 static inline void RunCallback(Callback& callback_impl, dvector_t<CPUType::SSE2, int> gate, dvector_t<CPUType::SSE2, int> up, Index row_idx, Index col_idx, Index rows, Index cols) {
+  callback_impl.Run(gate.first, up.first, callbacks::OutputBufferInfo(row_idx, col_idx, rows, cols));
+  callback_impl.Run(gate.second, up.second, callbacks::OutputBufferInfo(row_idx, col_idx + 4, rows, cols));
+}
+
+template <typename Callback>
+static inline void RunCallback(Callback& callback_impl, dvector_t<CPUType::UNSUPPORTED, int> gate, dvector_t<CPUType::UNSUPPORTED, int> up, Index row_idx, Index col_idx, Index rows, Index cols) {
+  callback_impl.Run(gate.first, up.first, callbacks::OutputBufferInfo(row_idx, col_idx, rows, cols));
+  callback_impl.Run(gate.second, up.second, callbacks::OutputBufferInfo(row_idx, col_idx + 4, rows, cols));
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+template <typename Callback>
+INTGEMM_AVX2 static inline void RunCallback(Callback& callback_impl, vector_t<CPUType::AVX2, int> gate, vector_t<CPUType::AVX2, int> up, Index row_idx, Index col_idx, Index rows, Index cols) {
+  callback_impl.Run(gate, up, callbacks::OutputBufferInfo(row_idx, col_idx, rows, cols));
+}
+#endif
+
+/* Versions for MultiplyCell, which hands the callback the sums of all four
+ * gate projections for the same output columns.
+ */
+template <typename Callback>
+INTGEMM_SSE2 static inline void RunCallback(Callback& callback_impl, dvector_t<CPUType::SSE2, int> gate0, dvector_t<CPUType::SSE2, int> gate1, dvector_t<CPUType::SSE2, int> gate2, dvector_t<CPUType::SSE2, int> gate3, Index row_idx, Index col_idx, Index rows, Index cols) {
+  callback_impl.Run(gate0.first, gate1.first, gate2.first, gate3.first, callbacks::OutputBufferInfo(row_idx, col_idx, rows, cols));
+  callback_impl.Run(gate0.second, gate1.second, gate2.second, gate3.second, callbacks::OutputBufferInfo(row_idx, col_idx + 4, rows, cols));
+}
+
+template <typename Callback>
+static inline void RunCallback(Callback& callback_impl, dvector_t<CPUType::UNSUPPORTED, int> gate0, dvector_t<CPUType::UNSUPPORTED, int> gate1, dvector_t<CPUType::UNSUPPORTED, int> gate2, dvector_t<CPUType::UNSUPPORTED, int> gate3, Index row_idx, Index col_idx, Index rows, Index cols) {
+  callback_impl.Run(gate0.first, gate1.first, gate2.first, gate3.first, callbacks::OutputBufferInfo(row_idx, col_idx, rows, cols));
+  callback_impl.Run(gate0.second, gate1.second, gate2.second, gate3.second, callbacks::OutputBufferInfo(row_idx, col_idx + 4, rows, cols));
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+template <typename Callback>
+INTGEMM_AVX2 static inline void RunCallback(Callback& callback_impl, vector_t<CPUType::AVX2, int> gate0, vector_t<CPUType::AVX2, int> gate1, vector_t<CPUType::AVX2, int> gate2, vector_t<CPUType::AVX2, int> gate3, Index row_idx, Index col_idx, Index rows, Index cols) {
+  callback_impl.Run(gate0, gate1, gate2, gate3, callbacks::OutputBufferInfo(row_idx, col_idx, rows, cols));
+}
+#endif
+
+/* Row preparation.  Callbacks that accumulate into the caller's buffers
+ * across threads, like TopK, implement Reset(rows) to clear them.  The
+ * multiplies call BeginRows before their column loop; one thread resets while
+ * the others wait, so a config can be used for any number of multiplies.
+ * Other callbacks get the empty overload.
+ */
+template <typename CallbackImpl>
+static inline auto BeginRows(CallbackImpl& callback_impl, Index rows, int) -> decltype(callback_impl.Reset(rows)) {
+  INTGEMM_OMP_SINGLE
+  callback_impl.Reset(rows);
+}
+
+template <typename CallbackImpl>
+static inline void BeginRows(CallbackImpl&, Index, long) {}
+
+/* Row completion.  Threads divide the multiplies by blocks of columns, so a
+ * row is only complete once every thread has left the column loop.  Callbacks
+ * that need whole rows, like LayerNorm, implement Merge to publish what their
+ * thread collected and FinishRow(row, cols, ldc) to finish one row of the output.
+ * The multiplies call FinishRows after their column loop; it merges, waits for
+ * the other threads, then divides the rows among them.  Other callbacks get
+ * the empty overload.
+ */
+template <typename CallbackImpl>
+static inline auto FinishRows(CallbackImpl& callback_impl, Index rows, Index cols, Index ldc, int) -> decltype(callback_impl.FinishRow(rows, cols, ldc)) {
+  callback_impl.Merge();
+  INTGEMM_OMP_BARRIER
+  INTGEMM_OMP_FOR
+  for (Index row = 0; row < rows; ++row) {
+    callback_impl.FinishRow(row, cols, ldc);
+  }
+}
+
+template <typename CallbackImpl>
+static inline void FinishRows(CallbackImpl&, Index, Index, Index, long) {}
+
+/* Holds the callback of one group at a time for loops that move between
+ * groups with their own callbacks.  Emplace destroys the previous callback
+ * before constructing the next in place, so a thread builds (and stateful
+ * callbacks merge) once per group it visits rather than once per block.
+ */
+template <class CallbackImpl> class CallbackSlot {
+  public:
+    CallbackSlot() : mem_(sizeof(CallbackImpl)), live_(false) {}
+
+    ~CallbackSlot() { Clear(); }
+
+    template <class Config> CallbackImpl &Emplace(const Config &config) {
+      Clear();
+      new (mem_.begin()) CallbackImpl(config);
+      live_ = true;
+      return **this;
+    }
+
+    void Clear() {
+      if (live_) {
+        (**this).~CallbackImpl();
+        live_ = false;
+      }
+    }
+
+    CallbackImpl &operator*() { return *mem_.as<CallbackImpl>(); }
+
+  private:
+    AlignedVector<char> mem_;
+    bool live_;
+};
+
+/* BeginRows and FinishRows for MultiplyShortlistBatch, where every group of
+ * rows has its own callback and width.  BeginGroupRows divides the groups
+ * among the threads.  The caller merges each of its group callbacks before
+ * FinishGroupRows, which divides the rows of all groups among the threads.
+ */
+template <typename CallbackImpl, typename Callback>
+static inline auto BeginGroupRows(CallbackSlot<CallbackImpl>& callback_impl, Index groups, const Index *row_offsets, const Callback *group_callbacks, int) -> decltype((*callback_impl).Reset(groups)) {
+  INTGEMM_OMP_FOR
+  for (Index group = 0; group < groups; ++group) {
+    callback_impl.Emplace(group_callbacks[group]).Reset(row_offsets[group + 1] - row_offsets[group]);
+  }
+  callback_impl.Clear();
+}
+
+template <typename CallbackImpl, typename Callback>
+static inline void BeginGroupRows(CallbackSlot<CallbackImpl>&, Index, const Index *, const Callback *, long) {}
+
+template <typename CallbackImpl>
+static inline auto MergeRows(CallbackImpl& callback_impl, int) -> decltype(callback_impl.Merge()) {
+  callback_impl.Merge();
+}
+
+template <typename CallbackImpl>
+static inline void MergeRows(CallbackImpl&, long) {}
+
+template <typename CallbackImpl, typename Callback>
+static inline auto FinishGroupRows(CallbackSlot<CallbackImpl>& callback_impl, Index groups, const Index *row_offsets, const Index *col_offsets, const Callback *group_callbacks, int) -> decltype((*callback_impl).FinishRow(groups, groups, groups)) {
+  INTGEMM_OMP_BARRIER
+  Index impl_group = groups;
+  INTGEMM_OMP_FOR
+  for (Index row = 0; row < row_offsets[groups]; ++row) {
+    const Index group = static_cast<Index>(std::upper_bound(row_offsets + 1, row_offsets + groups + 1, row) - (row_offsets + 1));
+    if (group != impl_group) {
+      callback_impl.Emplace(group_callbacks[group]);
+      impl_group = group;
+    }
+    const Index group_cols = col_offsets[group + 1] - col_offsets[group];
+    (*callback_impl).FinishRow(row - row_offsets[group], group_cols, group_cols);
+  }
+}
+
+template <typename CallbackImpl, typename Callback>
+static inline void FinishGroupRows(CallbackSlot<CallbackImpl>&, Index, const Index *, const Index *, const Callback *, long) {}
+
+/* Convert the 8 32-bit sums produced by PermuteSummer to float and multiply
+ * them by 8 consecutive per-column multipliers.
+ */
+INTGEMM_SSE2 static inline dvector_t<CPUType::SSE2, float> UnquantizeColumns8(dvector_t<CPUType::SSE2, int> total, const float *unquant) {
+  return {
+    kernels::unquantize(total.first, loadu_ps<__m128>(unquant)),
+    kernels::unquantize(total.second, loadu_ps<__m128>(unquant + 4)),
+  };
+}
+
+INTGEMM_SSE2 static inline dvector_t<CPUType::SSE2, float> UnquantizeColumns8(dvector_t<CPUType::SSE2, int> total, float unquant) {
+  __m128 unquant_reg = set1_ps<__m128>(unquant);
+  return {
+    kernels::unquantize(total.first, unquant_reg),
+    kernels::unquantize(total.second, unquant_reg),
+  };
+}
+
+INTGEMM_SSE2 static inline dvector_t<CPUType::SSE2, float> AddColumns8(dvector_t<CPUType::SSE2, float> first, dvector_t<CPUType::SSE2, float> second) {
+  return {
+    add_ps(first.first, second.first),
+    add_ps(first.second, second.second),
+  };
+}
+
+static inline dvector_t<CPUType::UNSUPPORTED, float> UnquantizeColumns8(dvector_t<CPUType::UNSUPPORTED, int> total, const float *unquant) {
+  return {
+    kernels::unquantize(total.first, loadu_ps<Generic::FRegister>(unquant)),
+    kernels::unquantize(total.second, loadu_ps<Generic::FRegister>(unquant + 4)),
+  };
+}
+
+static inline dvector_t<CPUType::UNSUPPORTED, float> UnquantizeColumns8(dvector_t<CPUType::UNSUPPORTED, int> total, float unquant) {
+  Generic::FRegister unquant_reg = set1_ps<Generic::FRegister>(unquant);
+  return {
+    kernels::unquantize(total.first, unquant_reg),
+    kernels::unquantize(total.second, unquant_reg),
+  };
+}
+
+static inline dvector_t<CPUType::UNSUPPORTED, float> AddColumns8(dvector_t<CPUType::UNSUPPORTED, float> first, dvector_t<CPUType::UNSUPPORTED, float> second) {
+  return {
+    add_ps(first.first, second.first),
+    add_ps(first.second, second.second),
+  };
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+INTGEMM_AVX2 static inline __m256 UnquantizeColumns8(__m256i total, const float *unquant) {
+  return kernels::unquantize(total, loadu_ps<__m256>(unquant));
+}
+
+INTGEMM_AVX2 static inline __m256 UnquantizeColumns8(__m256i total, float unquant) {
+  return kernels::unquantize(total, set1_ps<__m256>(unquant));
+}
+
+INTGEMM_AVX2 static inline __m256 AddColumns8(__m256 first, __m256 second) {
+  return add_ps(first, second);
+}
+#endif
+
 // 16-bit multiplier for INTGEMM_SSE2, INTGEMM_AVX2, and AVX512.
 // C = A * B * unquant_mult
 //
@@ -166,6 +612,7 @@ template <typename Callback> target static void Multiply(const int16_t *A, const
   assert(reinterpret_cast<uintptr_t>(B) % sizeof(Register) == 0); \
   const Index simd_width = width / (sizeof(Register) / sizeof(int16_t)); \
   auto callback_impl = callbacks::CallbackImpl<cpu_type, Callback>(callback); \
+  BeginRows(callback_impl, A_rows, 0); \
   INTGEMM_OMP_FOR \
   for (Index B0_colidx = 0; B0_colidx < B_cols; B0_colidx += 8) { \
     const Register *B0_col = reinterpret_cast<const Register *>(B) + simd_width * B0_colidx; \
@@ -213,7 +660,8 @@ template <typename Callback> target static void Multiply(const int16_t *A, const
       RunCallback(callback_impl, total, A_rowidx, B0_colidx, A_rows, B_cols); \
     } \
   } \
-} \
+  FinishRows(callback_impl, A_rows, B_cols, B_cols, 0); \
+}
 
 //An int8_prepbias version of the above code, using the add 127 technique
 #define INTGEMM_PREPAREBIASFOR8(Register, target, cpu_type) \
@@ -298,6 +746,7 @@ template <typename Callback> target static void Multiply(const int16_t *A, const
   assert(reinterpret_cast<uintptr_t>(B) % sizeof(Register) == 0); \
   const Index simd_width = width / (sizeof(Register) / sizeof(int8_t)); \
   auto callback_impl = callbacks::CallbackImpl<cpu_type, Callback>(callback); \
+  BeginRows(callback_impl, A_rows, 0); \
   INTGEMM_OMP_FOR \
   for (Index B0_colidx = 0; B0_colidx < B_cols; B0_colidx += 8) { \
     const Register *B0_col = reinterpret_cast<const Register *>(B) + simd_width * B0_colidx; \
@@ -365,7 +814,8 @@ template <typename Callback> target static void Multiply(const int16_t *A, const
       RunCallback(callback_impl, total, A_rowidx, B0_colidx, A_rows, B_cols); \
     } \
   } \
-} \
+  FinishRows(callback_impl, A_rows, B_cols, B_cols, 0); \
+}
 
 /* 8-bit matrix multiply used by AVX and AVX2.
  * These have two peculiar properties:
@@ -536,22 +986,48 @@ INTGEMM_SSSE3 inline static void InnerINTGEMM_SSSE3(
   sum6 = adds_epi16(sum6, maddubs_epi16(a_positive, sign_epi8(b[6], a)));
   sum7 = adds_epi16(sum7, maddubs_epi16(a_positive, sign_epi8(b[7], a)));
 }
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+// AVX512 has no vpsignb so negate b with a mask where a is negative.
+INTGEMM_AVX512BW inline static void InnerINTGEMM_AVX512BW(
+    __m512i a, const __m512i *b,
+    __m512i &sum0, __m512i &sum1, __m512i &sum2, __m512i &sum3,
+    __m512i &sum4, __m512i &sum5, __m512i &sum6, __m512i &sum7) {
+  const __m512i zeros = _mm512_setzero_si512();
+  __mmask64 neg_mask = _mm512_test_epi8_mask(a, _mm512_set1_epi8(-128));
+  __m512i a_positive = _mm512_abs_epi8(a);
+  sum0 = adds_epi16(sum0, maddubs_epi16(a_positive, _mm512_mask_sub_epi8(b[0], neg_mask, zeros, b[0])));
+  sum1 = adds_epi16(sum1, maddubs_epi16(a_positive, _mm512_mask_sub_epi8(b[1], neg_mask, zeros, b[1])));
+  sum2 = adds_epi16(sum2, maddubs_epi16(a_positive, _mm512_mask_sub_epi8(b[2], neg_mask, zeros, b[2])));
+  sum3 = adds_epi16(sum3, maddubs_epi16(a_positive, _mm512_mask_sub_epi8(b[3], neg_mask, zeros, b[3])));
+  sum4 = adds_epi16(sum4, maddubs_epi16(a_positive, _mm512_mask_sub_epi8(b[4], neg_mask, zeros, b[4])));
+  sum5 = adds_epi16(sum5, maddubs_epi16(a_positive, _mm512_mask_sub_epi8(b[5], neg_mask, zeros, b[5])));
+  sum6 = adds_epi16(sum6, maddubs_epi16(a_positive, _mm512_mask_sub_epi8(b[6], neg_mask, zeros, b[6])));
+  sum7 = adds_epi16(sum7, maddubs_epi16(a_positive, _mm512_mask_sub_epi8(b[7], neg_mask, zeros, b[7])));
+}
+#endif
+
 //INTGEMM_AVX2 or INTGEMM_SSSE3 multiply
 #define INTGEMM_MULTIPLY8(Register, target, cpu_type) \
   template <typename Callback> target static void Multiply(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) { \
+  MultiplyStrided(A, width, B, A_rows, width, B_cols, B_cols, callback); \
+} \
+  template <typename Callback> target static void MultiplyStrided(const int8_t *A, Index lda, const int8_t *B, Index A_rows, Index width, Index B_cols, Index ldc, Callback callback) { \
   assert(width % sizeof(Register) == 0); \
+  assert(lda % sizeof(Register) == 0); \
   assert(B_cols % 8 == 0); \
   assert(reinterpret_cast<uintptr_t>(A) % sizeof(Register) == 0); \
   assert(reinterpret_cast<uintptr_t>(B) % sizeof(Register) == 0); \
   const Index simd_width = width / sizeof(Register); \
   auto callback_impl = callbacks::CallbackImpl<cpu_type, Callback>(callback); \
+  BeginRows(callback_impl, A_rows, 0); \
   INTGEMM_OMP_FOR \
   for (Index B0_colidx = 0; B0_colidx < B_cols; B0_colidx += 8) { \
     const Register *B0_col = reinterpret_cast<const Register *>(B) + simd_width * B0_colidx; \
+    decltype(PermuteSummer(Register(), Register())) tile[callbacks::kTileRows]; \
     /*Process one row of A at a time.  Doesn't seem to be faster to do multiple rows of A at once.*/ \
     for (Index A_rowidx = 0; A_rowidx < A_rows; ++A_rowidx) { \
       /*Iterate over shared (inner) dimension.*/ \
-      const Register *A_live = reinterpret_cast<const Register *>(A + A_rowidx * width); \
+      const Register *A_live = reinterpret_cast<const Register *>(A + A_rowidx * lda); \
       const Register *A_end = A_live + simd_width; \
       const Register *B_live = B0_col; \
       /* Rather than initializing as zeros and adding, just initialize the first.*/ \
@@ -600,9 +1076,307 @@ INTGEMM_SSSE3 inline static void InnerINTGEMM_SSSE3(
       Register pack0123 = Pack0123(sum0, sum1, sum2, sum3); \
       Register pack4567 = Pack0123(sum4, sum5, sum6, sum7); \
       auto total = PermuteSummer(pack0123, pack4567); \
+      RunCallbackTiled(callback_impl, tile, total, A_rowidx, B0_colidx, A_rows, B_cols, ldc); \
+    } \
+  } \
+  FinishRows(callback_impl, A_rows, B_cols, ldc, 0); \
+}
+
+/* Dot products of one row of A with one block of 8 columns of prepared B.
+ * A_live points to the row of A and B_live to the block of B, both already
+ * offset to the first register of the inner dimension to use.  simd_width is
+ * the number of registers of the inner dimension to sum over.
+ *
+ * DotColumns8 returns the 8 sums in the format RunCallback takes.  This is the
+ * building block for multiplies that don't simply walk over every column of B
+ * once.  DotColumns8Vertical stops before the horizontal reduction and leaves
+ * 32-bit partial sums for column i in sums[i], for callers that scale each
+ * column before adding.
+ */
+#define INTGEMM_DOT_COLUMNS8(Register, target) \
+target static inline void DotColumns8Vertical(const Register *A_live, const Register *B_live, Index simd_width, Register *sums) { \
+  const Register *A_end = A_live + simd_width; \
+  /* These will be packed 16-bit integers containing sums for each column of B multiplied by the row of A.*/ \
+  Register sum0 = setzero_si<Register>(), sum1 = sum0, sum2 = sum0, sum3 = sum0, sum4 = sum0, sum5 = sum0, sum6 = sum0, sum7 = sum0; \
+  for (; A_live != A_end; ++A_live, B_live += 8) { \
+    Inner##target(*A_live, B_live, sum0, sum1, sum2, sum3, sum4, sum5, sum6, sum7); \
+  } \
+  Register ones = set1_epi16<Register>(1); \
+  sums[0] = madd_epi16(sum0, ones); \
+  sums[1] = madd_epi16(sum1, ones); \
+  sums[2] = madd_epi16(sum2, ones); \
+  sums[3] = madd_epi16(sum3, ones); \
+  sums[4] = madd_epi16(sum4, ones); \
+  sums[5] = madd_epi16(sum5, ones); \
+  sums[6] = madd_epi16(sum6, ones); \
+  sums[7] = madd_epi16(sum7, ones); \
+} \
+target static inline auto DotColumns8(const Register *A_live, const Register *B_live, Index simd_width) -> decltype(PermuteSummer(Register(), Register())) { \
+  Register sums[8]; \
+  DotColumns8Vertical(A_live, B_live, simd_width, sums); \
+  Register pack0123 = Pack0123(sums[0], sums[1], sums[2], sums[3]); \
+  Register pack4567 = Pack0123(sums[4], sums[5], sums[6], sums[7]); \
+  return PermuteSummer(pack0123, pack4567); \
+}
+
+/* 8-bit multiply with a separate unquantization multiplier for every group of
+ * group_size rows of B and every column of B.
+ *
+ * group_unquant is a (width / group_size) x B_cols row-major matrix.  Each
+ * entry is typically 1.0 / (A_quant_mult * B_quant_mult) for that group and
+ * column.  group_size must be a multiple of the register size so groups end
+ * on register boundaries.  Each column keeps its own float accumulator: at the
+ * end of a group the 32-bit sums are converted, multiplied by the column's
+ * scale and added, and the 8 accumulators are reduced horizontally once per
+ * row.  The callback receives already unquantized floats (i.e. use callbacks
+ * that take floats, like callbacks::Write<float>).
+ *
+ * Uses DotColumns8Vertical from the enclosing namespace.
+ */
+#define INTGEMM_MULTIPLY8_GROUPWISE(Register, target, cpu_type) \
+  template <typename Callback> target static void MultiplyGroupwise(const int8_t *A, const int8_t *B, const float *group_unquant, Index group_size, Index A_rows, Index width, Index B_cols, Callback callback) { \
+  assert(width % sizeof(Register) == 0); \
+  assert(group_size % sizeof(Register) == 0); \
+  assert(width % group_size == 0); \
+  assert(B_cols % 8 == 0); \
+  assert(reinterpret_cast<uintptr_t>(A) % sizeof(Register) == 0); \
+  assert(reinterpret_cast<uintptr_t>(B) % sizeof(Register) == 0); \
+  const Index simd_width = width / sizeof(Register); \
+  const Index simd_group = group_size / sizeof(Register); \
+  auto callback_impl = callbacks::CallbackImpl<cpu_type, Callback>(callback); \
+  BeginRows(callback_impl, A_rows, 0); \
+  INTGEMM_OMP_FOR \
+  for (Index B0_colidx = 0; B0_colidx < B_cols; B0_colidx += 8) { \
+    const Register *B0_col = reinterpret_cast<const Register *>(B) + simd_width * B0_colidx; \
+    for (Index A_rowidx = 0; A_rowidx < A_rows; ++A_rowidx) { \
+      const Register *A_row = reinterpret_cast<const Register *>(A + A_rowidx * width); \
+      const float *unquant = group_unquant + B0_colidx; \
+      FRegister totals[8]; \
+      for (Index i = 0; i < 8; ++i) totals[i] = setzero_ps<FRegister>(); \
+      for (Index k = 0; k < simd_width; k += simd_group, unquant += B_cols) { \
+        Register sums[8]; \
+        DotColumns8Vertical(A_row + k, B0_col + k * 8, simd_group, sums); \
+        for (Index i = 0; i < 8; ++i) { \
+          totals[i] = add_ps(totals[i], mul_ps(cvtepi32_ps(sums[i]), set1_ps<FRegister>(unquant[i]))); \
+        } \
+      } \
+      auto total = PermuteSummer(Pack0123(totals[0], totals[1], totals[2], totals[3]), Pack0123(totals[4], totals[5], totals[6], totals[7])); \
       RunCallback(callback_impl, total, A_rowidx, B0_colidx, A_rows, B_cols); \
     } \
   } \
+  FinishRows(callback_impl, A_rows, B_cols, B_cols, 0); \
+}
+
+/* Fused C = A1 * B1 * unquant_mult1 + A2 * B2 * unquant_mult2 where A1 and A2
+ * have the same number of rows and B1 and B2 the same number of columns, but
+ * width1 and width2 may differ.  This is the sum of input and recurrent
+ * products in RNN cells.  Both products for a block of 8 columns are
+ * unquantized and added in registers, then the callback gets floats once
+ * (i.e. use callbacks that take floats, like callbacks::Write<float>).
+ */
+#define INTGEMM_MULTIPLY8_DUAL(Register, target, cpu_type) \
+  template <typename Callback> target static void MultiplyDual(const int8_t *A1, const int8_t *B1, float unquant_mult1, Index width1, const int8_t *A2, const int8_t *B2, float unquant_mult2, Index width2, Index A_rows, Index B_cols, Callback callback) { \
+  assert(width1 % sizeof(Register) == 0); \
+  assert(width2 % sizeof(Register) == 0); \
+  assert(B_cols % 8 == 0); \
+  assert(reinterpret_cast<uintptr_t>(A1) % sizeof(Register) == 0); \
+  assert(reinterpret_cast<uintptr_t>(B1) % sizeof(Register) == 0); \
+  assert(reinterpret_cast<uintptr_t>(A2) % sizeof(Register) == 0); \
+  assert(reinterpret_cast<uintptr_t>(B2) % sizeof(Register) == 0); \
+  const Index simd_width1 = width1 / sizeof(Register); \
+  const Index simd_width2 = width2 / sizeof(Register); \
+  auto callback_impl = callbacks::CallbackImpl<cpu_type, Callback>(callback); \
+  BeginRows(callback_impl, A_rows, 0); \
+  INTGEMM_OMP_FOR \
+  for (Index B0_colidx = 0; B0_colidx < B_cols; B0_colidx += 8) { \
+    const Register *B1_col = reinterpret_cast<const Register *>(B1) + simd_width1 * B0_colidx; \
+    const Register *B2_col = reinterpret_cast<const Register *>(B2) + simd_width2 * B0_colidx; \
+    for (Index A_rowidx = 0; A_rowidx < A_rows; ++A_rowidx) { \
+      const Register *A1_row = reinterpret_cast<const Register *>(A1 + A_rowidx * width1); \
+      const Register *A2_row = reinterpret_cast<const Register *>(A2 + A_rowidx * width2); \
+      auto total = AddColumns8( \
+          UnquantizeColumns8(DotColumns8(A1_row, B1_col, simd_width1), unquant_mult1), \
+          UnquantizeColumns8(DotColumns8(A2_row, B2_col, simd_width2), unquant_mult2)); \
+      RunCallback(callback_impl, total, A_rowidx, B0_colidx, A_rows, B_cols); \
+    } \
+  } \
+  FinishRows(callback_impl, A_rows, B_cols, B_cols, 0); \
+}
+
+/* Gated linear unit.  B has B_cols columns whose blocks of 8 alternate
+ * between the gate and up projections, e.g. from Int8::InterleaveGatedB.
+ * Each pair of blocks is multiplied together and the callback gets both sums
+ * for the same 8 of the B_cols / 2 output columns, so only the gated result is
+ * written.
+ */
+#define INTGEMM_MULTIPLY8_GATED(Register, target, cpu_type) \
+  template <typename Callback> target static void MultiplyGated(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) { \
+  assert(width % sizeof(Register) == 0); \
+  assert(B_cols % 16 == 0); \
+  assert(reinterpret_cast<uintptr_t>(A) % sizeof(Register) == 0); \
+  assert(reinterpret_cast<uintptr_t>(B) % sizeof(Register) == 0); \
+  const Index simd_width = width / sizeof(Register); \
+  const Index C_cols = B_cols / 2; \
+  auto callback_impl = callbacks::CallbackImpl<cpu_type, Callback>(callback); \
+  BeginRows(callback_impl, A_rows, 0); \
+  INTGEMM_OMP_FOR \
+  for (Index C0_colidx = 0; C0_colidx < C_cols; C0_colidx += 8) { \
+    const Register *gate_col = reinterpret_cast<const Register *>(B) + simd_width * C0_colidx * 2; \
+    const Register *up_col = gate_col + simd_width * 8; \
+    for (Index A_rowidx = 0; A_rowidx < A_rows; ++A_rowidx) { \
+      const Register *A_row = reinterpret_cast<const Register *>(A + A_rowidx * width); \
+      RunCallback(callback_impl, DotColumns8(A_row, gate_col, simd_width), DotColumns8(A_row, up_col, simd_width), A_rowidx, C0_colidx, A_rows, C_cols); \
+    } \
+  } \
+  FinishRows(callback_impl, A_rows, C_cols, C_cols, 0); \
+}
+
+/* Recurrent cell.  B has B_cols columns whose blocks of 8 cycle through four
+ * gate projections, e.g. from Int8::InterleaveCellB.  The callback gets the
+ * four sums for the same 8 of the B_cols / 4 output columns and does the whole
+ * cell update, so the gate matrix is never written.
+ */
+#define INTGEMM_MULTIPLY8_CELL(Register, target, cpu_type) \
+  template <typename Callback> target static void MultiplyCell(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) { \
+  assert(width % sizeof(Register) == 0); \
+  assert(B_cols % 32 == 0); \
+  assert(reinterpret_cast<uintptr_t>(A) % sizeof(Register) == 0); \
+  assert(reinterpret_cast<uintptr_t>(B) % sizeof(Register) == 0); \
+  const Index simd_width = width / sizeof(Register); \
+  const Index C_cols = B_cols / 4; \
+  auto callback_impl = callbacks::CallbackImpl<cpu_type, Callback>(callback); \
+  BeginRows(callback_impl, A_rows, 0); \
+  INTGEMM_OMP_FOR \
+  for (Index C0_colidx = 0; C0_colidx < C_cols; C0_colidx += 8) { \
+    const Register *gate0_col = reinterpret_cast<const Register *>(B) + simd_width * C0_colidx * 4; \
+    const Register *gate1_col = gate0_col + simd_width * 8; \
+    const Register *gate2_col = gate1_col + simd_width * 8; \
+    const Register *gate3_col = gate2_col + simd_width * 8; \
+    for (Index A_rowidx = 0; A_rowidx < A_rows; ++A_rowidx) { \
+      const Register *A_row = reinterpret_cast<const Register *>(A + A_rowidx * width); \
+      RunCallback(callback_impl, DotColumns8(A_row, gate0_col, simd_width), DotColumns8(A_row, gate1_col, simd_width), DotColumns8(A_row, gate2_col, simd_width), DotColumns8(A_row, gate3_col, simd_width), A_rowidx, C0_colidx, A_rows, C_cols); \
+    } \
+  } \
+  FinishRows(callback_impl, A_rows, C_cols, C_cols, 0); \
+}
+
+/* 8-bit multiply by a B that has not been prepared, e.g. because it changes
+ * every call.  B is int8_t (already quantized) or float (quantized here with
+ * B_quant_mult) and row major, or column major if B_transposed.  Each thread
+ * packs one block of 8 columns at a time into a small scratch panel with
+ * PackBPanel, then multiplies every row of A by it while it is in cache, so
+ * B is only read once rather than written and read again by PrepareB.
+ */
+#define INTGEMM_MULTIPLY8_DYNAMIC_B(Register, target, cpu_type) \
+  template <typename BType, typename Callback> target static void MultiplyDynamicB(const int8_t *A, const BType *B, float B_quant_mult, bool B_transposed, Index A_rows, Index width, Index B_cols, Callback callback) { \
+  assert(width % sizeof(Register) == 0); \
+  assert(B_cols % 8 == 0); \
+  assert(reinterpret_cast<uintptr_t>(A) % sizeof(Register) == 0); \
+  assert(reinterpret_cast<uintptr_t>(B) % sizeof(Register) == 0); \
+  const Index simd_width = width / sizeof(Register); \
+  auto callback_impl = callbacks::CallbackImpl<cpu_type, Callback>(callback); \
+  BeginRows(callback_impl, A_rows, 0); \
+  /* Per-thread scratch holding one packed block of columns. */ \
+  AlignedVector<int8_t> panel_mem(width * 8); \
+  Register *panel = panel_mem.as<Register>(); \
+  INTGEMM_OMP_FOR \
+  for (Index B0_colidx = 0; B0_colidx < B_cols; B0_colidx += 8) { \
+    PackBPanel(B, B_transposed, B_quant_mult, panel, width, B_cols, B0_colidx); \
+    for (Index A_rowidx = 0; A_rowidx < A_rows; ++A_rowidx) { \
+      const Register *A_row = reinterpret_cast<const Register *>(A + A_rowidx * width); \
+      RunCallback(callback_impl, DotColumns8(A_row, panel, simd_width), A_rowidx, B0_colidx, A_rows, B_cols); \
+    } \
+  } \
+  FinishRows(callback_impl, A_rows, B_cols, B_cols, 0); \
+}
+
+/* Multiply A by the columns of a prepared B listed in [cols_begin, cols_end),
+ * as if B had first been passed through SelectColumnsB, but without copying
+ * B.  Each group of 8 listed columns that is an aligned block of B (i.e. 8
+ * consecutive columns starting at a multiple of 8) is read in place.  Other
+ * groups are gathered into a small per-thread panel that stays in cache while
+ * every row of A is multiplied by it.
+ *
+ * The output has cols_end - cols_begin columns in shortlist order, so
+ * callbacks see col_idx as the position in the shortlist; the original column
+ * of B is cols_begin[col_idx].
+ *
+ * MultiplyShortlistBatch does the same for several groups of rows of A, each
+ * with its own shortlist and callback, in one parallel loop over all groups'
+ * blocks of 8 columns.  Group g is rows [row_offsets[g], row_offsets[g+1]) of
+ * A and columns cols[col_offsets[g]], ..., cols[col_offsets[g+1] - 1] of B.
+ * group_callbacks[g] sees the group as its own matrix: row_idx counts from the
+ * group's first row and cols is the size of the group's shortlist.
+ */
+#define INTGEMM_MULTIPLY8_SHORTLIST(Register, target, cpu_type) \
+  /* Block of 8 shortlisted columns starting at cols, either in place or gathered into panel. */ \
+  target static inline const Register *ShortlistPanel(const int8_t *B, Index simd_width, const Index *cols, Register *panel) { \
+    Index consecutive = 1; \
+    while (consecutive < 8 && cols[consecutive] == cols[0] + consecutive) ++consecutive; \
+    if (consecutive == 8 && cols[0] % 8 == 0) { \
+      return reinterpret_cast<const Register *>(B) + simd_width * cols[0]; \
+    } \
+    for (Index k = 0; k < 8; ++k) { \
+      const Register *start = reinterpret_cast<const Register *>(B) + (cols[k] & 7) + (cols[k] & ~7) * simd_width; \
+      for (Index r = 0; r < simd_width; ++r) { \
+        panel[r * 8 + k] = start[r * 8]; \
+      } \
+    } \
+    return panel; \
+  } \
+  template <typename Callback> target static void MultiplyShortlist(const int8_t *A, const int8_t *B, Index A_rows, Index width, const Index *cols_begin, const Index *cols_end, Callback callback) { \
+  assert(width % sizeof(Register) == 0); \
+  assert((cols_end - cols_begin) % 8 == 0); \
+  assert(reinterpret_cast<uintptr_t>(A) % sizeof(Register) == 0); \
+  assert(reinterpret_cast<uintptr_t>(B) % sizeof(Register) == 0); \
+  const Index simd_width = width / sizeof(Register); \
+  const Index selected = static_cast<Index>(cols_end - cols_begin); \
+  auto callback_impl = callbacks::CallbackImpl<cpu_type, Callback>(callback); \
+  BeginRows(callback_impl, A_rows, 0); \
+  /* Per-thread scratch for groups that have to be gathered. */ \
+  AlignedVector<int8_t> panel_mem(width * 8); \
+  Register *panel = panel_mem.as<Register>(); \
+  INTGEMM_OMP_FOR \
+  for (Index C0_colidx = 0; C0_colidx < selected; C0_colidx += 8) { \
+    const Register *B0_col = ShortlistPanel(B, simd_width, cols_begin + C0_colidx, panel); \
+    for (Index A_rowidx = 0; A_rowidx < A_rows; ++A_rowidx) { \
+      const Register *A_row = reinterpret_cast<const Register *>(A + A_rowidx * width); \
+      RunCallback(callback_impl, DotColumns8(A_row, B0_col, simd_width), A_rowidx, C0_colidx, A_rows, selected); \
+    } \
+  } \
+  FinishRows(callback_impl, A_rows, selected, selected, 0); \
+} \
+  template <typename Callback> target static void MultiplyShortlistBatch(const int8_t *A, const int8_t *B, Index width, Index groups, const Index *row_offsets, const Index *col_offsets, const Index *cols, const Callback *group_callbacks) { \
+  assert(width % sizeof(Register) == 0); \
+  assert(reinterpret_cast<uintptr_t>(A) % sizeof(Register) == 0); \
+  assert(reinterpret_cast<uintptr_t>(B) % sizeof(Register) == 0); \
+  const Index simd_width = width / sizeof(Register); \
+  AlignedVector<int8_t> panel_mem(width * 8); \
+  Register *panel = panel_mem.as<Register>(); \
+  /* Consecutive blocks usually belong to the same group, so build a group's callback when the thread reaches it. */ \
+  CallbackSlot<callbacks::CallbackImpl<cpu_type, Callback>> callback_impl; \
+  BeginGroupRows(callback_impl, groups, row_offsets, group_callbacks, 0); \
+  Index impl_group = groups; \
+  /* Every group's shortlist is a multiple of 8 so blocks of 8 never straddle groups. */ \
+  INTGEMM_OMP_FOR \
+  for (Index C0_colidx = 0; C0_colidx < col_offsets[groups]; C0_colidx += 8) { \
+    const Index group = static_cast<Index>(std::upper_bound(col_offsets + 1, col_offsets + groups + 1, C0_colidx) - (col_offsets + 1)); \
+    assert((col_offsets[group + 1] - col_offsets[group]) % 8 == 0); \
+    const Index group_rows = row_offsets[group + 1] - row_offsets[group]; \
+    const Index group_cols = col_offsets[group + 1] - col_offsets[group]; \
+    if (group != impl_group) { \
+      if (impl_group != groups) MergeRows(*callback_impl, 0); \
+      callback_impl.Emplace(group_callbacks[group]); \
+      impl_group = group; \
+    } \
+    const Register *B0_col = ShortlistPanel(B, simd_width, cols + C0_colidx, panel); \
+    for (Index A_rowidx = 0; A_rowidx < group_rows; ++A_rowidx) { \
+      const Register *A_row = reinterpret_cast<const Register *>(A + (row_offsets[group] + A_rowidx) * width); \
+      RunCallback(*callback_impl, DotColumns8(A_row, B0_col, simd_width), A_rowidx, C0_colidx - col_offsets[group], group_rows, group_cols); \
+    } \
+  } \
+  if (impl_group != groups) MergeRows(*callback_impl, 0); \
+  FinishGroupRows(callback_impl, groups, row_offsets, col_offsets, group_callbacks, 0); \
 }
 
 /* Wrap a multiply call in OMP parallelism.  Here it launches threads then
@@ -622,5 +1396,38 @@ template <class Callback, class Backend> static inline void OMPParallelWrap8Shif
 #pragma omp parallel
   Backend::template Multiply8Shift<Callback>(A, B, A_rows, width, B_cols, callback);
 }
+template <class BType, class Callback, class Backend> static inline void OMPParallelWrapDynamicB(const int8_t *A, const BType *B, float B_quant_mult, bool B_transposed, Index A_rows, Index width, Index B_cols, Callback callback) {
+#pragma omp parallel
+  Backend::template MultiplyDynamicB<BType, Callback>(A, B, B_quant_mult, B_transposed, A_rows, width, B_cols, callback);
+}
+template <class Callback, class Backend> static inline void OMPParallelWrapDual(const int8_t *A1, const int8_t *B1, float unquant_mult1, Index width1, const int8_t *A2, const int8_t *B2, float unquant_mult2, Index width2, Index A_rows, Index B_cols, Callback callback) {
+#pragma omp parallel
+  Backend::template MultiplyDual<Callback>(A1, B1, unquant_mult1, width1, A2, B2, unquant_mult2, width2, A_rows, B_cols, callback);
+}
+template <class Callback, class Backend> static inline void OMPParallelWrapStrided(const int8_t *A, Index lda, const int8_t *B, Index A_rows, Index width, Index B_cols, Index ldc, Callback callback) {
+#pragma omp parallel
+  Backend::template MultiplyStrided<Callback>(A, lda, B, A_rows, width, B_cols, ldc, callback);
+}
+template <class Callback, class Backend> static inline void OMPParallelWrapGated(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) {
+#pragma omp parallel
+  Backend::template MultiplyGated<Callback>(A, B, A_rows, width, B_cols, callback);
+}
+
+template <class Callback, class Backend> static inline void OMPParallelWrapCell(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) {
+#pragma omp parallel
+  Backend::template MultiplyCell<Callback>(A, B, A_rows, width, B_cols, callback);
+}
+template <class Callback, class Backend> static inline void OMPParallelWrapShortlist(const int8_t *A, const int8_t *B, Index A_rows, Index width, const Index *cols_begin, const Index *cols_end, Callback callback) {
+#pragma omp parallel
+  Backend::template MultiplyShortlist<Callback>(A, B, A_rows, width, cols_begin, cols_end, callback);
+}
+template <class Callback, class Backend> static inline void OMPParallelWrapShortlistBatch(const int8_t *A, const int8_t *B, Index width, Index groups, const Index *row_offsets, const Index *col_offsets, const Index *cols, const Callback *group_callbacks) {
+#pragma omp parallel
+  Backend::template MultiplyShortlistBatch<Callback>(A, B, width, groups, row_offsets, col_offsets, cols, group_callbacks);
+}
+template <class Callback, class Backend> static inline void OMPParallelWrapGroupwise(const int8_t *A, const int8_t *B, const float *group_unquant, Index group_size, Index A_rows, Index width, Index B_cols, Callback callback) {
+#pragma omp parallel
+  Backend::template MultiplyGroupwise<Callback>(A, B, group_unquant, group_size, A_rows, width, B_cols, callback);
+}
 
 } // namespace intgemm
@@ -5,8 +5,10 @@
 #include "types.h"
 
 #include <cstdint>
+#include <cstring>
 
-// 8 bit is in ssse3_gemm.h
+// Fast 8 bit is in ssse3_gemm.h.  The 8-bit version here is a fallback for
+// CPUs without SSSE3.
 
 namespace intgemm {
 namespace SSE2 {
@@ -80,5 +82,220 @@ struct Kernels16 {
   static const CPUType kUses = CPUType::SSE2;
 };
 
+/* 8-bit for CPUs with only SSE2.  Slower than SSSE3 but uses the same prepared
+ * layout so prepared matrices can be shared with SSSE3.
+ */
+class QuantizeTile8 {
+  public:
+    INTGEMM_SSE2 static inline Register ForReshape(FRegister mult_reg, const float *input, Index cols) {
+      // Skip a row.
+      return Tile(mult_reg, input, input + 4, input + 2 * cols, input + 2 * cols + 4);
+    }
+
+    INTGEMM_SSE2 static inline Register Consecutive(FRegister mult_reg, const float *input) {
+      return Tile(mult_reg, input, input + 4, input + 8, input + 12);
+    }
+
+    INTGEMM_SSE2 static inline Register ConsecutiveU(FRegister mult_reg, const float *input) {
+      const __m128i pos127 = _mm_set1_epi8(127);
+      return _mm_add_epi8(Tile(mult_reg, input, input + 4, input + 8, input + 12), pos127);
+    }
+
+    INTGEMM_SSE2 static inline Register ConsecutiveWithWrapping(FRegister mult_reg, const float *input, Index cols_left, Index cols, Index row_step) {
+      const float* inputs[4];
+      for (Index i = 0; i < sizeof(inputs) / sizeof(inputs[0]); ++i) {
+        while (cols_left < sizeof(Register) / sizeof(float)) {
+          input += cols * (row_step - 1);
+          cols_left += cols;
+        }
+        inputs[i] = input;
+        input += sizeof(Register) / sizeof(float);
+        cols_left -= sizeof(Register) / sizeof(float);
+      }
+      return Tile(mult_reg, inputs[0], inputs[1], inputs[2], inputs[3]);
+    }
+
+    // Quantize 16xfloat into 16xint8_t
+    INTGEMM_SSE2 static inline __m128i Tile(FRegister mult_reg, const float *input0, const float *input1, const float *input2, const float *input3) {
+      const __m128i neg128 = _mm_set1_epi8(-128);
+      __m128i g0 = QuantizerGrab(input0, mult_reg);
+      __m128i g1 = QuantizerGrab(input1, mult_reg);
+      __m128i g2 = QuantizerGrab(input2, mult_reg);
+      __m128i g3 = QuantizerGrab(input3, mult_reg);
+      __m128i packed0 = _mm_packs_epi32(g0, g1);
+      __m128i packed1 = _mm_packs_epi32(g2, g3);
+      __m128i packed = _mm_packs_epi16(packed0, packed1);
+      // Ban -128 without SSE4.1's _mm_max_epi8: cmpeq is 0xff for -128 and subtracting that adds 1.
+      __m128i evils = _mm_cmpeq_epi8(packed, neg128);
+      return _mm_sub_epi8(packed, evils);
+    }
+};
+
+// Sign extend 8-bit integers to two registers of 16-bit integers.
+INTGEMM_SSE2 static inline void Widen8(__m128i in, __m128i &lo, __m128i &hi) {
+  lo = _mm_srai_epi16(unpacklo_epi8(in, in), 8);
+  hi = _mm_srai_epi16(unpackhi_epi8(in, in), 8);
+}
+
+/* There is no 8-bit multiply in SSE2 so widen to 16-bit and use madd_epi16.
+ * Unlike maddubs_epi16 this does not saturate.  If a_unsigned, A is uint8_t
+ * as in Multiply8Shift.
+ */
+INTGEMM_SSE2 static inline void DotColumns8WidenedVertical(const __m128i *A_live, const __m128i *B_live, Index simd_width, bool a_unsigned, __m128i *sums) {
+  const __m128i *A_end = A_live + simd_width;
+  const __m128i zeros = setzero_si<__m128i>();
+  for (Index i = 0; i < 8; ++i) sums[i] = zeros;
+  for (; A_live != A_end; ++A_live, B_live += 8) {
+    __m128i a_lo, a_hi;
+    if (a_unsigned) {
+      a_lo = unpacklo_epi8(*A_live, zeros);
+      a_hi = unpackhi_epi8(*A_live, zeros);
+    } else {
+      Widen8(*A_live, a_lo, a_hi);
+    }
+    for (Index i = 0; i < 8; ++i) {
+      __m128i b_lo, b_hi;
+      Widen8(B_live[i], b_lo, b_hi);
+      sums[i] = add_epi32(sums[i], add_epi32(madd_epi16(a_lo, b_lo), madd_epi16(a_hi, b_hi)));
+    }
+  }
+}
+
+INTGEMM_SSE2 static inline dvector_t<CPUType::SSE2, int> DotColumns8Widened(const __m128i *A_live, const __m128i *B_live, Index simd_width, bool a_unsigned) {
+  __m128i sums[8];
+  DotColumns8WidenedVertical(A_live, B_live, simd_width, a_unsigned, sums);
+  __m128i pack0123 = Pack0123(sums[0], sums[1], sums[2], sums[3]);
+  __m128i pack4567 = Pack0123(sums[4], sums[5], sums[6], sums[7]);
+  return PermuteSummer(pack0123, pack4567);
+}
+
+INTGEMM_SSE2 static inline dvector_t<CPUType::SSE2, int> DotColumns8(const __m128i *A_live, const __m128i *B_live, Index simd_width) {
+  return DotColumns8Widened(A_live, B_live, simd_width, false);
+}
+
+INTGEMM_SSE2 static inline void DotColumns8Vertical(const __m128i *A_live, const __m128i *B_live, Index simd_width, __m128i *sums) {
+  DotColumns8WidenedVertical(A_live, B_live, simd_width, false, sums);
+}
+
+struct Kernels8 {
+  typedef int8_t Integer;
+
+  // Currently A is prepared by quantization but this could theoretically change.
+  INTGEMM_SSE2 static inline void PrepareA(const float *input, int8_t *output, float quant_mult, Index rows, Index cols) {
+    Quantize(input, output, quant_mult, rows * cols);
+  }
+
+ private:
+  INTGEMM_QUANTIZE_THREAD(INTGEMM_SSE2)
+ public:
+  INTGEMM_QUANTIZE(INTGEMM_SSE2)
+
+  INTGEMM_PREPARE_A_ROWWISE(INTGEMM_SSE2)
+
+  // Version with unsigned int + 127
+  INTGEMM_SSE2 static inline void PrepareA(const float *input, uint8_t *output, float quant_mult, Index rows, Index cols) {
+    QuantizeU(input, output, quant_mult, rows * cols);
+  }
+
+  INTGEMM_SSE2 static void QuantizeU(const float *input, uint8_t *output, float quant_mult, Index size) {
+    assert(size % 16 == 0);
+    assert(reinterpret_cast<uintptr_t>(input) % 16 == 0);
+    assert(reinterpret_cast<uintptr_t>(output) % 16 == 0);
+    FRegister q = set1_ps<FRegister>(quant_mult);
+    const float *end = input + size;
+    for (; input != end; input += 16, output += 16) {
+      *reinterpret_cast<__m128i*>(output) = QuantizeTile8::ConsecutiveU(q, input);
+    }
+  }
+
+  // Asymmetric version: round(input * quant_mult) + zero_point saturated to [0, 255].
+  INTGEMM_SSE2 static void QuantizeZeroPoint(const float *input, uint8_t *output, float quant_mult, int32_t zero_point, Index size) {
+    assert(size % 16 == 0);
+    assert(reinterpret_cast<uintptr_t>(input) % 16 == 0);
+    assert(reinterpret_cast<uintptr_t>(output) % 16 == 0);
+    FRegister q = set1_ps<FRegister>(quant_mult);
+    const __m128i zero_point_reg = set1_epi32<__m128i>(zero_point);
+    const float *end = input + size;
+    for (; input != end; input += 16, output += 16) {
+      __m128i g0 = add_epi32(QuantizerGrab(input, q), zero_point_reg);
+      __m128i g1 = add_epi32(QuantizerGrab(input + 4, q), zero_point_reg);
+      __m128i g2 = add_epi32(QuantizerGrab(input + 8, q), zero_point_reg);
+      __m128i g3 = add_epi32(QuantizerGrab(input + 12, q), zero_point_reg);
+      __m128i packed0 = _mm_packs_epi32(g0, g1);
+      __m128i packed1 = _mm_packs_epi32(g2, g3);
+      *reinterpret_cast<__m128i*>(output) = _mm_packus_epi16(packed0, packed1);
+    }
+  }
+
+  // Tile size for B; B must be a multiple of this block size.
+  static const Index kBTileRow = 16;
+  static const Index kBTileCol = 8;
+
+  INTGEMM_PREPARE_B_8(INTGEMM_SSE2, QuantizeTile8)
+  INTGEMM_PREPARE_B_QUANTIZED_TRANSPOSED(INTGEMM_SSE2, int8_t)
+  INTGEMM_PREPARE_B_TRANSPOSED(INTGEMM_SSE2, QuantizeTile8, int8_t)
+  INTGEMM_PACK_B_PANEL_8(INTGEMM_SSE2, QuantizeTile8)
+
+  INTGEMM_SSE2 static void SelectColumnsB(const int8_t *input, int8_t *output, Index rows, const Index *cols_begin, const Index *cols_end) {
+    SSE2::SelectColumnsOfB((const __m128i*)input, (__m128i*)output, rows, cols_begin, cols_end);
+  }
+
+  template <typename Callback> INTGEMM_SSE2 static void Multiply(const int8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) {
+    MultiplyWidened(A, width, B, false, A_rows, width, B_cols, B_cols, callback);
+  }
+
+  template <typename Callback> INTGEMM_SSE2 static void MultiplyStrided(const int8_t *A, Index lda, const int8_t *B, Index A_rows, Index width, Index B_cols, Index ldc, Callback callback) {
+    MultiplyWidened(A, lda, B, false, A_rows, width, B_cols, ldc, callback);
+  }
+
+  template <class Callback> INTGEMM_SSE2 static void Multiply8Shift(const uint8_t *A, const int8_t *B, Index A_rows, Index width, Index B_cols, Callback callback) {
+    MultiplyWidened(reinterpret_cast<const int8_t*>(A), width, B, true, A_rows, width, B_cols, B_cols, callback);
+  }
+
+  // Column sums of B, as PrepareBias does with the other backends.
+  template <class Callback> INTGEMM_SSE2 static void PrepareBias(const int8_t *B, Index width, Index B_cols, Callback callback) {
+    AlignedVector<int8_t> ones(width);
+    for (Index i = 0; i < width; ++i) ones[i] = 1;
+    MultiplyWidened(ones.begin(), width, B, false, 1, width, B_cols, B_cols, callback);
+  }
+
+  INTGEMM_MULTIPLY8_GROUPWISE(__m128i, INTGEMM_SSE2, CPUType::SSE2)
+
+  INTGEMM_MULTIPLY8_DYNAMIC_B(__m128i, INTGEMM_SSE2, CPUType::SSE2)
+
+  INTGEMM_MULTIPLY8_DUAL(__m128i, INTGEMM_SSE2, CPUType::SSE2)
+
+  INTGEMM_MULTIPLY8_GATED(__m128i, INTGEMM_SSE2, CPUType::SSE2)
+  INTGEMM_MULTIPLY8_CELL(__m128i, INTGEMM_SSE2, CPUType::SSE2)
+
+  INTGEMM_MULTIPLY8_SHORTLIST(__m128i, INTGEMM_SSE2, CPUType::SSE2)
+
+  constexpr static const char *const kName = "8-bit SSE2";
+
+  static const CPUType kUses = CPUType::SSE2;
+
+ private:
+  template <typename Callback> INTGEMM_SSE2 static void MultiplyWidened(const int8_t *A, Index lda, const int8_t *B, bool a_unsigned, Index A_rows, Index width, Index B_cols, Index ldc, Callback callback) {
+    assert(width % sizeof(__m128i) == 0);
+    assert(lda % sizeof(__m128i) == 0);
+    assert(B_cols % 8 == 0);
+    assert(reinterpret_cast<uintptr_t>(A) % sizeof(__m128i) == 0);
+    assert(reinterpret_cast<uintptr_t>(B) % sizeof(__m128i) == 0);
+    const Index simd_width = width / sizeof(__m128i);
+    auto callback_impl = callbacks::CallbackImpl<CPUType::SSE2, Callback>(callback);
+    BeginRows(callback_impl, A_rows, 0);
+    INTGEMM_OMP_FOR
+    for (Index B0_colidx = 0; B0_colidx < B_cols; B0_colidx += 8) {
+      const __m128i *B0_col = reinterpret_cast<const __m128i *>(B) + simd_width * B0_colidx;
+      dvector_t<CPUType::SSE2, int> tile[callbacks::kTileRows];
+      for (Index A_rowidx = 0; A_rowidx < A_rows; ++A_rowidx) {
+        const __m128i *A_row = reinterpret_cast<const __m128i *>(A + A_rowidx * lda);
+        RunCallbackTiled(callback_impl, tile, DotColumns8Widened(A_row, B0_col, simd_width, a_unsigned), A_rowidx, B0_colidx, A_rows, B_cols, ldc);
+      }
+    }
+    FinishRows(callback_impl, A_rows, B_cols, ldc, 0);
+  }
+};
+
 } // namespace SSE2
 } // namespace intgemm
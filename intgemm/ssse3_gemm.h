@@ -19,6 +19,8 @@ INTGEMM_SSSE3 inline __m128i QuantizerGrab(const float *input, const __m128 quan
 
 INTGEMM_SELECT_COL_B(INTGEMM_SSSE3, __m128i)
 
+INTGEMM_DOT_COLUMNS8(__m128i, INTGEMM_SSSE3)
+
 class QuantizeTile8 {
   public:
     INTGEMM_SSSE3 static inline Register ForReshape(FRegister mult_reg, const float *input, Index cols) {
@@ -110,6 +112,8 @@ struct Kernels8 {
  public:
   INTGEMM_QUANTIZE(INTGEMM_SSSE3)
 
+  INTGEMM_PREPARE_A_ROWWISE(INTGEMM_SSSE3)
+
   // Version with unsigned int + 127
   // Currently A is prepared by quantization but this could theoretically change.
   INTGEMM_SSSE3 static inline void PrepareA(const float *input, uint8_t *output, float quant_mult, Index rows, Index cols) {
@@ -127,6 +131,26 @@ struct Kernels8 {
     }
   }
 
+  // Asymmetric version: round(input * quant_mult) + zero_point saturated to [0, 255].
+  INTGEMM_SSSE3 static void QuantizeZeroPoint(const float *input, uint8_t *output, float quant_mult, int32_t zero_point, Index size) {
+    assert(size % 16 == 0);
+    assert(reinterpret_cast<uintptr_t>(input) % 16 == 0);
+    assert(reinterpret_cast<uintptr_t>(output) % 16 == 0);
+    FRegister q = set1_ps<FRegister>(quant_mult);
+    const __m128i zero_point_reg = set1_epi32<__m128i>(zero_point);
+    const float *end = input + size;
+    for (; input != end; input += 16, output += 16) {
+      __m128i g0 = add_epi32(QuantizerGrab(input, q), zero_point_reg);
+      __m128i g1 = add_epi32(QuantizerGrab(input + 4, q), zero_point_reg);
+      __m128i g2 = add_epi32(QuantizerGrab(input + 8, q), zero_point_reg);
+      __m128i g3 = add_epi32(QuantizerGrab(input + 12, q), zero_point_reg);
+      __m128i packed0 = _mm_packs_epi32(g0, g1);
+      __m128i packed1 = _mm_packs_epi32(g2, g3);
+      // Unsigned saturation clips to [0, 255].  No permute needed for SSE.
+      *reinterpret_cast<__m128i*>(output) = _mm_packus_epi16(packed0, packed1);
+    }
+  }
+
   // Tile size for B; B must be a multiple of this block size.
   static const Index kBTileRow = 16;
   static const Index kBTileCol = 8;
@@ -134,6 +158,7 @@ struct Kernels8 {
   INTGEMM_PREPARE_B_8(INTGEMM_SSSE3, SSSE3::QuantizeTile8)
   INTGEMM_PREPARE_B_QUANTIZED_TRANSPOSED(INTGEMM_SSSE3, int8_t)
   INTGEMM_PREPARE_B_TRANSPOSED(INTGEMM_SSSE3, QuantizeTile8, int8_t)
+  INTGEMM_PACK_B_PANEL_8(INTGEMM_SSSE3, QuantizeTile8)
 
   INTGEMM_SSSE3 static void SelectColumnsB(const int8_t *input, int8_t *output, Index rows, const Index *cols_begin, const Index *cols_end) {
     SSSE3::SelectColumnsOfB((const __m128i*)input, (__m128i*)output, rows, cols_begin, cols_end);
@@ -145,6 +170,17 @@ struct Kernels8 {
 
   INTGEMM_PREPAREBIASFOR8(__m128i, INTGEMM_SSSE3, CPUType::SSE2)
 
+  INTGEMM_MULTIPLY8_GROUPWISE(__m128i, INTGEMM_SSSE3, CPUType::SSE2)
+
+  INTGEMM_MULTIPLY8_DYNAMIC_B(__m128i, INTGEMM_SSSE3, CPUType::SSE2)
+
+  INTGEMM_MULTIPLY8_DUAL(__m128i, INTGEMM_SSSE3, CPUType::SSE2)
+
+  INTGEMM_MULTIPLY8_GATED(__m128i, INTGEMM_SSSE3, CPUType::SSE2)
+  INTGEMM_MULTIPLY8_CELL(__m128i, INTGEMM_SSSE3, CPUType::SSE2)
+
+  INTGEMM_MULTIPLY8_SHORTLIST(__m128i, INTGEMM_SSSE3, CPUType::SSE2)
+
   constexpr static const char *const kName = "8-bit SSSE3";
 
   static const CPUType kUses = CPUType::SSSE3;
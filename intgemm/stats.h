@@ -1,7 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include "intrinsics.h"
+#include "kernels.h"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -55,6 +57,14 @@ INTGEMM_AVX512F static inline float AddFloat32(__m512 a) {
 }
 #endif
 
+// Same folding order as SSE2 so the portable backend gets identical results.
+static inline float MaxFloat32(Generic::FRegister a) {
+  return std::max(std::max(a.lanes[0], a.lanes[2]), std::max(a.lanes[1], a.lanes[3]));
+}
+static inline float AddFloat32(Generic::FRegister a) {
+  return (a.lanes[0] + a.lanes[2]) + (a.lanes[1] + a.lanes[3]);
+}
+
 constexpr int32_t kFloatAbsoluteMask = 0x7fffffff;
 
 } // namespace intgemm
@@ -74,3 +84,7 @@ constexpr int32_t kFloatAbsoluteMask = 0x7fffffff;
 #include "stats.inl"
 #undef INTGEMM_THIS_IS_AVX512DQ
 #endif
+
+#define INTGEMM_THIS_IS_GENERIC
+#include "stats.inl"
+#undef INTGEMM_THIS_IS_GENERIC
@@ -8,6 +8,9 @@
 #elif defined(INTGEMM_THIS_IS_SSE2)
 #define INTGEMM_ARCH SSE2
 #define INTGEMM_TARGET INTGEMM_SSE2
+#elif defined(INTGEMM_THIS_IS_GENERIC)
+#define INTGEMM_ARCH Generic
+#define INTGEMM_TARGET INTGEMM_GENERIC
 #else
 #error Included with unexpected architecture
 #endif
@@ -60,6 +63,26 @@ INTGEMM_TARGET static inline float MaxAbsolute(const float *begin_float, const f
   return ret;
 }
 
+/* Compute the maximum absolute value of each column of a rows x cols
+ * row-major matrix into output, which has cols entries.  Rows are read in
+ * order and the running maxima for a row stay in cache.
+ */
+INTGEMM_TARGET static inline void ColumnMaxAbsolute(const float *input, Index rows, Index cols, float *output) {
+  const FRegister abs_mask = cast_ps(set1_epi32<Register>(kFloatAbsoluteMask));
+  const Index cols_reg = cols - cols % (sizeof(FRegister) / sizeof(float));
+  std::fill(output, output + cols, 0.0f);
+  for (Index r = 0; r < rows; ++r) {
+    const float *row = input + r * cols;
+    Index c = 0;
+    for (; c < cols_reg; c += sizeof(FRegister) / sizeof(float)) {
+      storeu_ps(output + c, max_ps(loadu_ps<FRegister>(output + c), and_ps(abs_mask, loadu_ps<FRegister>(row + c))));
+    }
+    for (; c < cols; ++c) {
+      output[c] = std::max(output[c], std::fabs(row[c]));
+    }
+  }
+}
+
 /* Computes the euclidean norm and returns the mean and the standard deviation. Optionally it can be the mean and standard deviation in absolute terms. */
 INTGEMM_TARGET static inline MeanStd VectorMeanStd(const float *begin_float, const float *end_float, bool absolute) {
   assert(end_float > begin_float);
@@ -91,6 +114,44 @@ INTGEMM_TARGET static inline MeanStd VectorMeanStd(const float *begin_float, con
   return ret;
 }
 
+/* Finish a softmax over the rows of output given the statistics collected by
+ * callbacks::UnquantizeAndWriteSoftmaxStats:
+ *   output[r][c] = exp(output[r][c] - row_max[r]) / row_sum[r]
+ * Row r starts at output + r * ld.
+ */
+INTGEMM_TARGET static inline void FinishSoftmax(float *output, Index rows, Index cols, Index ld, const float *row_max, const float *row_sum) {
+  for (Index r = 0; r < rows; ++r) {
+    float *row = output + r * ld;
+    Index c = 0;
+    const FRegister max_reg = set1_ps<FRegister>(row_max[r]);
+    const FRegister scale = set1_ps<FRegister>(1.0f / row_sum[r]);
+    for (; c + sizeof(FRegister) / sizeof(float) <= cols; c += sizeof(FRegister) / sizeof(float)) {
+      storeu_ps(row + c, mul_ps(kernels::exp_approx_taylor(sub_ps(loadu_ps<FRegister>(row + c), max_reg)), scale));
+    }
+    for (; c < cols; ++c) {
+      row[c] = std::exp(row[c] - row_max[r]) / row_sum[r];
+    }
+  }
+}
+
+/* Same for log-softmax:
+ *   output[r][c] = output[r][c] - row_max[r] - log(row_sum[r])
+ */
+INTGEMM_TARGET static inline void FinishLogSoftmax(float *output, Index rows, Index cols, Index ld, const float *row_max, const float *row_sum) {
+  for (Index r = 0; r < rows; ++r) {
+    float *row = output + r * ld;
+    const float shift = row_max[r] + std::log(row_sum[r]);
+    const FRegister shift_reg = set1_ps<FRegister>(shift);
+    Index c = 0;
+    for (; c + sizeof(FRegister) / sizeof(float) <= cols; c += sizeof(FRegister) / sizeof(float)) {
+      storeu_ps(row + c, sub_ps(loadu_ps<FRegister>(row + c), shift_reg));
+    }
+    for (; c < cols; ++c) {
+      row[c] -= shift;
+    }
+  }
+}
+
 } // namespace INTGEMM_ARCH
 } // namespace intgemm
 
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <exception>
 #ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
 #include <immintrin.h>
@@ -29,19 +30,27 @@
   #define INTGEMM_AVX512BW
   #define INTGEMM_AVX512DQ
   #define INTGEMM_AVX512VNNI
+  #define INTGEMM_MAY_ALIAS
 #else
-  /* gcc and clang take lists of all the flavors */
+  /* gcc and clang take lists of all the flavors.  Every AVX2 CPU has F16C; the
+   * AVX512 targets list it too so AVX2 callbacks still inline into them. */
   #define INTGEMM_SSE2 __attribute__ ((target ("sse2")))
   #define INTGEMM_SSSE3 __attribute__ ((target ("ssse3")))
-  #define INTGEMM_AVX2 __attribute__ ((target ("avx2")))
-  #define INTGEMM_AVX512F __attribute__ ((target ("avx512f")))
-  #define INTGEMM_AVX512BW __attribute__ ((target ("avx512f,avx512bw,avx512dq")))
-  #define INTGEMM_AVX512DQ __attribute__ ((target ("avx512f,avx512bw,avx512dq")))
-  #define INTGEMM_AVX512VNNI __attribute__ ((target ("avx512f,avx512bw,avx512dq,avx512vnni")))
+  #define INTGEMM_AVX2 __attribute__ ((target ("avx2,f16c")))
+  #define INTGEMM_AVX512F __attribute__ ((target ("avx512f,f16c")))
+  #define INTGEMM_AVX512BW __attribute__ ((target ("avx512f,avx512bw,avx512dq,f16c")))
+  #define INTGEMM_AVX512DQ __attribute__ ((target ("avx512f,avx512bw,avx512dq,f16c")))
+  #define INTGEMM_AVX512VNNI __attribute__ ((target ("avx512f,avx512bw,avx512dq,avx512vnni,f16c")))
+  #define INTGEMM_MAY_ALIAS __attribute__ ((__may_alias__))
 #endif
+/* The portable backend needs no instruction set extension. */
+#define INTGEMM_GENERIC
 namespace intgemm {
 
-// This will be thrown if a CPU isn't supported by the routines (16-bit without SSE2 or 8-bit without SSSE3).
+/* Thrown by routines that have no implementation for the requested CPU.  The
+ * dispatcher falls back to the portable Generic backend instead, so this only
+ * comes from code that names an architecture explicitly.
+ */
 class UnsupportedCPU : public std::exception {
   public:
     UnsupportedCPU() {}
@@ -57,7 +66,7 @@ typedef unsigned int Index;
 
 // If you want to detect the CPU and dispatch yourself, here's what to use:
 enum class CPUType {
-  UNSUPPORTED = 0,
+  UNSUPPORTED = 0, // No SSE2; served by the portable Generic backend.
   SSE2 = 1,
   SSSE3 = 2,
   AVX2 = 3,
@@ -99,5 +108,28 @@ namespace SSE2 {
 typedef __m128i Register;
 typedef __m128 FRegister;
 } // namespace SSE2
+/* Registers of the portable backend.  They are 16 bytes like SSE2 so prepared
+ * matrices share the SSE2 layout, but need no instruction set extension.  gcc
+ * and clang hold the lanes in vector extension types, which the compiler lowers
+ * to whatever SIMD the target has; other compilers get plain arrays.  Distinct
+ * structs keep their overloads from colliding with __m128.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define INTGEMM_GENERIC_VECTORS
+#endif
+namespace Generic {
+#ifdef INTGEMM_GENERIC_VECTORS
+typedef int32_t Int32x4 __attribute__ ((vector_size (16)));
+typedef float Float32x4 __attribute__ ((vector_size (16)));
+typedef double Float64x2 __attribute__ ((vector_size (16)));
+struct INTGEMM_MAY_ALIAS Register { Int32x4 lanes; };
+struct INTGEMM_MAY_ALIAS FRegister { Float32x4 lanes; };
+struct INTGEMM_MAY_ALIAS DRegister { Float64x2 lanes; };
+#else
+struct INTGEMM_MAY_ALIAS Register { alignas(16) int32_t lanes[4]; };
+struct INTGEMM_MAY_ALIAS FRegister { alignas(16) float lanes[4]; };
+struct INTGEMM_MAY_ALIAS DRegister { alignas(16) double lanes[2]; };
+#endif
+} // namespace Generic
 
 } // namespace intgemm
@@ -8,6 +8,11 @@ namespace intgemm {
  * Vector traits
  */
 template <CPUType CPUType_, typename ElemType_> struct vector_s;
+template <> struct vector_s<CPUType::UNSUPPORTED, int8_t> { using type = Generic::Register; };
+template <> struct vector_s<CPUType::UNSUPPORTED, int16_t> { using type = Generic::Register; };
+template <> struct vector_s<CPUType::UNSUPPORTED, int> { using type = Generic::Register; };
+template <> struct vector_s<CPUType::UNSUPPORTED, float> { using type = Generic::FRegister; };
+template <> struct vector_s<CPUType::UNSUPPORTED, double> { using type = Generic::DRegister; };
 template <> struct vector_s<CPUType::SSE2, int8_t> { using type = __m128i; };
 template <> struct vector_s<CPUType::SSE2, int16_t> { using type = __m128i; };
 template <> struct vector_s<CPUType::SSE2, int> { using type = __m128i; };
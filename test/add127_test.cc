@@ -280,6 +280,17 @@ template <class Routine> void TestMultiplyShiftInt(Index A_rows, Index width, In
 
 
 // Bias
+TEST_CASE("PrepareBias SSE2", "[Add127]") {
+	if (kCPU < CPUType::SSE2) return;
+	TestPrepareBias<SSE2::Kernels8>(256,256);
+	TestPrepareBias<SSE2::Kernels8>(512,512);
+}
+
+TEST_CASE("PrepareBias Generic", "[Add127]") {
+	TestPrepareBias<Generic::Kernels8>(256,256);
+	TestPrepareBias<Generic::Kernels8>(512,512);
+}
+
 TEST_CASE("PrepareBias SSSE3", "[Add127]") {
 	if (kCPU < CPUType::SSSE3) return;
 	TestPrepareBias<SSSE3::Kernels8>(256,256);
@@ -438,6 +449,19 @@ TEST_CASE ("Multiply AVX512F 8bit Shift vs nonshift", "[Add127]") {
 #endif
 
 //Multiply Shift vs int shift implementation
+TEST_CASE ("Multiply SSE2 8bit Shift vs Int", "[Add127]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyShiftInt<SSE2::Kernels8>(1, 64, 8, 0.0001f, 0.05f, 0.03f, 0.0001f);
+  TestMultiplyShiftInt<SSE2::Kernels8>(8, 256, 256, 0.0001f, 0.22f, 0.06f, 0.0001f);
+  TestMultiplyShiftInt<SSE2::Kernels8>(200, 256, 256, 0.0001f, 0.28f, 0.06f, 0.0001f);
+}
+
+TEST_CASE ("Multiply Generic 8bit Shift vs Int", "[Add127]") {
+  TestMultiplyShiftInt<Generic::Kernels8>(1, 64, 8, 0.0001f, 0.05f, 0.03f, 0.0001f);
+  TestMultiplyShiftInt<Generic::Kernels8>(8, 256, 256, 0.0001f, 0.22f, 0.06f, 0.0001f);
+  TestMultiplyShiftInt<Generic::Kernels8>(200, 256, 256, 0.0001f, 0.28f, 0.06f, 0.0001f);
+}
+
 TEST_CASE ("Multiply SSSE3 8bit Shift vs Int", "[Add127]") {
   if (kCPU < CPUType::SSSE3) return;
   TestMultiplyShiftInt<SSSE3::Kernels8>(1, 64, 8, 0.0001f, 0.1f, 0.06f, 0.0001f);
@@ -488,5 +512,303 @@ TEST_CASE ("Multiply AVX512VNNI 8bit Shift vs Int", "[Add127]") {
 }
 #endif
 
+/*
+ * Zero point quantization
+ */
+template <class Routine> void TestQuantizeZeroPoint(Index size, int32_t zero_point) {
+  std::mt19937 gen;
+  // Go somewhat out of range too.
+  std::uniform_real_distribution<float> dist(-2.5f, 2.5f);
+  AlignedVector<float> input(size);
+  for (auto& it : input) {
+    it = dist(gen);
+  }
+  const float quant_mult = 255.0f / 4.0f;
+  AlignedVector<uint8_t> test(size);
+  Routine::QuantizeZeroPoint(input.begin(), test.begin(), quant_mult, zero_point, size);
+  for (Index i = 0; i < size; ++i) {
+    float expected = std::nearbyint(input[i] * quant_mult) + zero_point;
+    expected = std::min(255.0f, std::max(0.0f, expected));
+    INFO("Inaccurate at " << i << ' ' << input[i]);
+    CHECK(static_cast<int>(expected) == static_cast<int>(test[i]));
+  }
+}
+
+template <class Routine> void TestMultiplyZeroPoint(Index A_rows, Index width, Index B_cols, bool per_row) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\t' << per_row << '\n';
+  INFO(info.str());
+
+  // Mostly positive A, as if after ReLU.
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  AlignedVector<float> bias(B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::uniform_real_distribution<float> A_dist(-0.4f, 1.4f);
+  for (auto& it : A) {
+    it = A_dist(gen);
+  }
+  for (auto& it : B) {
+    it = dist(gen);
+  }
+  for (auto& it : bias) {
+    it = dist(gen);
+  }
+
+  const float A_quant_mult = 255.0f / 2.0f;
+  // Keep 2 * 255 * 64 within 16 bits.
+  const float B_quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (A_quant_mult * B_quant_mult);
+  AlignedVector<int32_t> zero_points(A_rows);
+  for (Index r = 0; r < A_rows; ++r) {
+    zero_points[r] = per_row ? static_cast<int32_t>(56 + 6 * (r % 4)) : 64;
+  }
+
+  AlignedVector<uint8_t> A_prep(A.size());
+  for (Index r = 0; r < A_rows; ++r) {
+    Routine::QuantizeZeroPoint(A.begin() + r * width, A_prep.begin() + r * width, A_quant_mult, zero_points[r], width);
+  }
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareB(B.begin(), B_prep.begin(), B_quant_mult, width, B_cols);
+  AlignedVector<int32_t> column_sums(B_cols);
+  Routine::PrepareBias(B_prep.begin(), width, B_cols, callbacks::Write<int>(column_sums.begin()));
+
+  AlignedVector<float> test_C(A_rows * B_cols);
+  if (per_row) {
+    Routine::Multiply8Shift(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeZeroPointAndAddBiasAndWrite(unquant_mult, column_sums.begin(), zero_points.begin(), bias.begin(), test_C.begin()));
+  } else {
+    AlignedVector<int32_t> zero_point_sums(B_cols);
+    for (Index c = 0; c < B_cols; ++c) {
+      zero_point_sums[c] = zero_points[0] * column_sums[c];
+    }
+    Routine::Multiply8Shift(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeZeroPointAndAddBiasAndWrite(unquant_mult, zero_point_sums.begin(), bias.begin(), test_C.begin()));
+  }
+
+  AlignedVector<int8_t> B_quant(B.size());
+  Routine::Quantize(B.begin(), B_quant.begin(), B_quant_mult, static_cast<Index>(B.size()));
+  AlignedVector<float> slowint_C(test_C.size());
+  references::Multiply(A_prep.begin(), B_quant.begin(), slowint_C.begin(), A_rows, width, B_cols, [&](int32_t sum, const callbacks::OutputBufferInfo& info) {
+    int32_t column_sum = 0;
+    for (Index k = 0; k < width; ++k) {
+      column_sum += B_quant[k * B_cols + info.col_idx];
+    }
+    return (sum - zero_points[info.row_idx] * column_sum) * unquant_mult + bias[info.col_idx];
+  });
+  CompareEps(slowint_C.begin(), test_C.begin(), test_C.size(), 0.0001f);
+
+  // And close to the float product.
+  AlignedVector<float> float_C(test_C.size());
+  references::Multiply(A.begin(), B.begin(), float_C.begin(), A_rows, width, B_cols, [&](double sum, const callbacks::OutputBufferInfo& info) {
+    return static_cast<float>(sum) + bias[info.col_idx];
+  });
+  for (Index i = 0; i < test_C.size(); ++i) {
+    CHECK(std::fabs(float_C[i] - test_C[i]) < 0.3f);
+  }
+}
+
+/* Sums and zero_point * column sums above 2^24, where float loses integers.
+ * A sits near the zero point so the difference is small and the output must be
+ * exact.  per_row rows use zero_point, zero_point - 1 and zero_point - 2.
+ */
+template <class Routine> void TestMultiplyZeroPointExact(Index A_rows, Index width, Index B_cols, bool per_row, int32_t zero_point = 252) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\t' << per_row << '\t' << zero_point << '\n';
+  INFO(info.str());
+
+  // Integers so quantizing with a multiplier of 1 is exact.
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  std::mt19937 gen;
+  std::uniform_int_distribution<int> A_dist(-2, 255 - zero_point);
+  std::uniform_int_distribution<int> B_dist(60, 64);
+  for (auto& it : A) {
+    it = static_cast<float>(A_dist(gen));
+  }
+  for (auto& it : B) {
+    it = static_cast<float>(B_dist(gen));
+  }
+  AlignedVector<int32_t> zero_points(A_rows);
+  for (Index r = 0; r < A_rows; ++r) {
+    zero_points[r] = per_row ? zero_point - static_cast<int32_t>(r % 3) : zero_point;
+  }
+
+  AlignedVector<uint8_t> A_prep(A.size());
+  for (Index r = 0; r < A_rows; ++r) {
+    Routine::QuantizeZeroPoint(A.begin() + r * width, A_prep.begin() + r * width, 1.0f, zero_points[r], width);
+  }
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareB(B.begin(), B_prep.begin(), 1.0f, width, B_cols);
+  AlignedVector<int32_t> column_sums(B_cols);
+  Routine::PrepareBias(B_prep.begin(), width, B_cols, callbacks::Write<int>(column_sums.begin()));
+  AlignedVector<float> bias(B_cols);
+  std::fill(bias.begin(), bias.end(), 0.0f);
+
+  AlignedVector<float> test_C(A_rows * B_cols);
+  if (per_row) {
+    Routine::Multiply8Shift(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeZeroPointAndAddBiasAndWrite(1.0f, column_sums.begin(), zero_points.begin(), bias.begin(), test_C.begin()));
+  } else {
+    AlignedVector<int32_t> zero_point_sums(B_cols);
+    for (Index c = 0; c < B_cols; ++c) {
+      zero_point_sums[c] = zero_points[0] * column_sums[c];
+    }
+    Routine::Multiply8Shift(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeZeroPointAndAddBiasAndWrite(1.0f, zero_point_sums.begin(), bias.begin(), test_C.begin()));
+  }
+
+  for (Index r = 0; r < A_rows; ++r) {
+    for (Index c = 0; c < B_cols; ++c) {
+      int64_t expected = 0;
+      for (Index k = 0; k < width; ++k) {
+        expected += static_cast<int64_t>(A_prep[r * width + k] - zero_points[r]) * static_cast<int64_t>(B[k * B_cols + c]);
+      }
+      INFO("Inaccurate at row " << r << " column " << c);
+      CHECK(test_C[r * B_cols + c] == static_cast<float>(expected));
+    }
+  }
+}
+
+TEST_CASE("QuantizeZeroPoint SSE2", "[ZeroPoint]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestQuantizeZeroPoint<SSE2::Kernels8>(256, 0);
+  TestQuantizeZeroPoint<SSE2::Kernels8>(512, 100);
+}
+
+TEST_CASE("QuantizeZeroPoint Generic", "[ZeroPoint]") {
+  TestQuantizeZeroPoint<Generic::Kernels8>(256, 0);
+  TestQuantizeZeroPoint<Generic::Kernels8>(512, 100);
+}
+
+TEST_CASE("QuantizeZeroPoint SSSE3", "[ZeroPoint]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestQuantizeZeroPoint<SSSE3::Kernels8>(256, 0);
+  TestQuantizeZeroPoint<SSSE3::Kernels8>(512, 100);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE("QuantizeZeroPoint AVX2", "[ZeroPoint]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestQuantizeZeroPoint<AVX2::Kernels8>(256, 0);
+  TestQuantizeZeroPoint<AVX2::Kernels8>(512, 100);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE("QuantizeZeroPoint AVX512F", "[ZeroPoint]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestQuantizeZeroPoint<AVX512BW::Kernels8>(256, 0);
+  TestQuantizeZeroPoint<AVX512BW::Kernels8>(512, 100);
+}
+#endif
+
+TEST_CASE ("Multiply SSE2 8bit zero point", "[ZeroPoint]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyZeroPoint<SSE2::Kernels8>(8, 256, 256, false);
+  TestMultiplyZeroPoint<SSE2::Kernels8>(200, 256, 64, true);
+  TestMultiplyZeroPointExact<SSE2::Kernels8>(8, 2048, 64, false);
+  TestMultiplyZeroPointExact<SSE2::Kernels8>(8, 2048, 64, true);
+  TestMultiplyZeroPointExact<SSE2::Kernels8>(8, 4096, 64, true, 255);
+}
+
+TEST_CASE ("Multiply Generic 8bit zero point", "[ZeroPoint]") {
+  TestMultiplyZeroPoint<Generic::Kernels8>(8, 256, 256, false);
+  TestMultiplyZeroPoint<Generic::Kernels8>(200, 256, 64, true);
+  TestMultiplyZeroPointExact<Generic::Kernels8>(8, 2048, 64, false);
+  TestMultiplyZeroPointExact<Generic::Kernels8>(8, 2048, 64, true);
+  TestMultiplyZeroPointExact<Generic::Kernels8>(8, 4096, 64, true, 255);
+}
+
+TEST_CASE ("Multiply SSSE3 8bit zero point", "[ZeroPoint]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyZeroPoint<SSSE3::Kernels8>(8, 256, 256, false);
+  TestMultiplyZeroPoint<SSSE3::Kernels8>(200, 256, 64, true);
+  TestMultiplyZeroPointExact<SSSE3::Kernels8>(8, 2048, 64, false);
+  TestMultiplyZeroPointExact<SSSE3::Kernels8>(8, 2048, 64, true);
+  TestMultiplyZeroPointExact<SSSE3::Kernels8>(8, 4096, 64, true, 255);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply AVX2 8bit zero point", "[ZeroPoint]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyZeroPoint<AVX2::Kernels8>(8, 256, 256, false);
+  TestMultiplyZeroPoint<AVX2::Kernels8>(200, 256, 64, true);
+  TestMultiplyZeroPointExact<AVX2::Kernels8>(8, 2048, 64, false);
+  TestMultiplyZeroPointExact<AVX2::Kernels8>(8, 2048, 64, true);
+  TestMultiplyZeroPointExact<AVX2::Kernels8>(8, 4096, 64, true, 255);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply AVX512F 8bit zero point", "[ZeroPoint]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyZeroPoint<AVX512BW::Kernels8>(8, 256, 256, false);
+  TestMultiplyZeroPoint<AVX512BW::Kernels8>(200, 256, 64, true);
+  TestMultiplyZeroPointExact<AVX512BW::Kernels8>(8, 2048, 64, false);
+  TestMultiplyZeroPointExact<AVX512BW::Kernels8>(8, 2048, 64, true);
+  TestMultiplyZeroPointExact<AVX512BW::Kernels8>(8, 4096, 64, true, 255);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply AVX512VNNI 8bit zero point", "[ZeroPoint]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyZeroPoint<AVX512VNNI::Kernels8>(8, 256, 256, false);
+  TestMultiplyZeroPoint<AVX512VNNI::Kernels8>(200, 256, 64, true);
+  TestMultiplyZeroPointExact<AVX512VNNI::Kernels8>(8, 2048, 64, false);
+  TestMultiplyZeroPointExact<AVX512VNNI::Kernels8>(8, 2048, 64, true);
+  TestMultiplyZeroPointExact<AVX512VNNI::Kernels8>(8, 4096, 64, true, 255);
+}
+#endif
+
+TEST_CASE ("Int8Shift zero point dispatch", "[ZeroPoint]") {
+  const Index A_rows = 4, width = 128, B_cols = 16;
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  AlignedVector<float> bias(B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+  // Row r spans [-0.1 * r, 1 - 0.1 * r], so every row needs a zero point and
+  // a different one.
+  for (Index r = 0; r < A_rows; ++r) {
+    for (Index c = 0; c < width; ++c) A[r * width + c] = dist(gen) - 0.1f * r;
+  }
+  for (auto& it : B) it = dist(gen) - 0.5f;
+  for (auto& it : bias) it = dist(gen);
+
+  AlignedVector<float> float_C(A_rows * B_cols);
+  references::Multiply(A.begin(), B.begin(), float_C.begin(), A_rows, width, B_cols, [&](double sum, const callbacks::OutputBufferInfo& info) {
+    return static_cast<float>(sum + bias[info.col_idx]);
+  });
+
+  const float quant_mult = 255.0f / 1.3f;
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Int8Shift::PrepareB(B.begin(), B_prep.begin(), 64.0f, width, B_cols);
+  AlignedVector<float> test_C(A_rows * B_cols);
+
+  // One zero point for all of A, covering the lowest row.
+  const int32_t zero_point = static_cast<int32_t>(std::round(0.3f * quant_mult));
+  AlignedVector<int32_t> zero_point_sums(B_cols);
+  Int8Shift::PrepareBZeroPointSums(B_prep.begin(), zero_point, zero_point_sums.begin(), width, B_cols);
+  Int8Shift::PrepareAZeroPoint(A.begin(), A_prep.begin(), quant_mult, zero_point, A_rows, width);
+  Int8Shift::Multiply(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeZeroPointAndAddBiasAndWrite(1.0f / (quant_mult * 64.0f), zero_point_sums.begin(), bias.begin(), test_C.begin()));
+  for (Index i = 0; i < test_C.size(); ++i) {
+    CHECK(std::fabs(float_C[i] - test_C[i]) < 0.1f);
+  }
+
+  // One zero point per row.
+  AlignedVector<int32_t> zero_points(A_rows);
+  for (Index r = 0; r < A_rows; ++r) {
+    zero_points[r] = static_cast<int32_t>(std::round(0.1f * r * quant_mult));
+  }
+  AlignedVector<int32_t> column_sums(B_cols);
+  Int8Shift::PrepareBColumnSums(B_prep.begin(), column_sums.begin(), width, B_cols);
+  std::fill(test_C.begin(), test_C.end(), 0.0f);
+  Int8Shift::PrepareAZeroPoint(A.begin(), A_prep.begin(), quant_mult, zero_points.begin(), A_rows, width);
+  Int8Shift::Multiply(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeZeroPointAndAddBiasAndWrite(1.0f / (quant_mult * 64.0f), column_sums.begin(), zero_points.begin(), bias.begin(), test_C.begin()));
+  for (Index i = 0; i < test_C.size(); ++i) {
+    CHECK(std::fabs(float_C[i] - test_C[i]) < 0.1f);
+  }
+}
+
 } // namespace
 } // namespace intgemm
@@ -0,0 +1,44 @@
+#include "../test.h"
+#include "../../intgemm/aligned.h"
+#include "../../intgemm/kernels.h"
+
+#include <numeric>
+
+namespace intgemm {
+
+template <CPUType CPUType_>
+void kernel_accumulate_test() {
+  if (kCPU < CPUType_)
+    return;
+
+  using vec_t = vector_t<CPUType_, float>;
+  constexpr static auto VECTOR_LENGTH = sizeof(vec_t) / sizeof(float);
+
+  AlignedVector<float> input(VECTOR_LENGTH);
+  AlignedVector<float> output(VECTOR_LENGTH);
+
+  std::iota(input.begin(), input.end(), 0.0f);
+  std::fill(output.begin(), output.end(), 100.0f);
+
+  *output.template as<vec_t>() = kernels::accumulate(*input.template as<vec_t>(), output.begin(), 0, set1_ps<vec_t>(0.5f));
+  for (std::size_t i = 0; i < output.size(); ++i)
+    CHECK(output[i] == float(50 + i));
+}
+
+template void kernel_accumulate_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("accumulate Generic") { return kernel_accumulate_test<CPUType::UNSUPPORTED>(); }
+
+template INTGEMM_SSE2 void kernel_accumulate_test<CPUType::SSE2>();
+KERNEL_TEST_CASE("accumulate SSE2") { return kernel_accumulate_test<CPUType::SSE2>(); }
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+template INTGEMM_AVX2 void kernel_accumulate_test<CPUType::AVX2>();
+KERNEL_TEST_CASE("accumulate AVX2") { return kernel_accumulate_test<CPUType::AVX2>(); }
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+template INTGEMM_AVX512BW void kernel_accumulate_test<CPUType::AVX512BW>();
+KERNEL_TEST_CASE("accumulate AVX512BW") { return kernel_accumulate_test<CPUType::AVX512BW>(); }
+#endif
+
+}
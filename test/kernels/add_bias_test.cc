@@ -26,6 +26,17 @@ void kernel_add_bias_test() {
     CHECK(output[i] == ElemType_(100 + i));
 }
 
+template void kernel_add_bias_test<CPUType::UNSUPPORTED, int8_t>();
+template void kernel_add_bias_test<CPUType::UNSUPPORTED, int16_t>();
+template void kernel_add_bias_test<CPUType::UNSUPPORTED, int>();
+template void kernel_add_bias_test<CPUType::UNSUPPORTED, float>();
+template void kernel_add_bias_test<CPUType::UNSUPPORTED, double>();
+KERNEL_TEST_CASE("add_bias/int8 Generic") { return kernel_add_bias_test<CPUType::UNSUPPORTED, int8_t>(); }
+KERNEL_TEST_CASE("add_bias/int16 Generic") { return kernel_add_bias_test<CPUType::UNSUPPORTED, int16_t>(); }
+KERNEL_TEST_CASE("add_bias/int Generic") { return kernel_add_bias_test<CPUType::UNSUPPORTED, int>(); }
+KERNEL_TEST_CASE("add_bias/float Generic") { return kernel_add_bias_test<CPUType::UNSUPPORTED, float>(); }
+KERNEL_TEST_CASE("add_bias/double Generic") { return kernel_add_bias_test<CPUType::UNSUPPORTED, double>(); }
+
 template INTGEMM_SSE2 void kernel_add_bias_test<CPUType::SSE2, int8_t>();
 template INTGEMM_SSE2 void kernel_add_bias_test<CPUType::SSE2, int16_t>();
 template INTGEMM_SSE2 void kernel_add_bias_test<CPUType::SSE2, int>();
@@ -25,6 +25,9 @@ void kernel_bitwise_not_test() {
     CHECK(output[i] == ~input[i]);
 }
 
+template void kernel_bitwise_not_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("bitwise_not Generic") { return kernel_bitwise_not_test<CPUType::UNSUPPORTED>(); }
+
 template INTGEMM_SSE2 void kernel_bitwise_not_test<CPUType::SSE2>();
 KERNEL_TEST_CASE("bitwise_not SSE2") { return kernel_bitwise_not_test<CPUType::SSE2>(); }
 
@@ -27,6 +27,9 @@ void kernel_downcast32to8_test() {
     CHECK(output[i] == int8_t(input[i]));
 }
 
+template void kernel_downcast32to8_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("downcast32to8 Generic") { return kernel_downcast32to8_test<CPUType::UNSUPPORTED>(); }
+
 template INTGEMM_SSE2 void kernel_downcast32to8_test<CPUType::SSE2>();
 KERNEL_TEST_CASE("downcast32to8 SSE2") { return kernel_downcast32to8_test<CPUType::SSE2>(); }
 
@@ -59,6 +62,9 @@ void kernel_downcast32to16_test() {
     CHECK(output[i] == int16_t(input[i]));
 }
 
+template void kernel_downcast32to16_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("downcast32to16 Generic") { return kernel_downcast32to16_test<CPUType::UNSUPPORTED>(); }
+
 template INTGEMM_SSE2 void kernel_downcast32to16_test<CPUType::SSE2>();
 KERNEL_TEST_CASE("downcast32to16 SSE2") { return kernel_downcast32to16_test<CPUType::SSE2>(); }
 
@@ -91,6 +97,9 @@ void kernel_downcast16to8_test() {
     CHECK(output[i] == int8_t(input[i]));
 }
 
+template void kernel_downcast16to8_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("downcast16to8 Generic") { return kernel_downcast16to8_test<CPUType::UNSUPPORTED>(); }
+
 template INTGEMM_SSE2 void kernel_downcast16to8_test<CPUType::SSE2>();
 KERNEL_TEST_CASE("downcast16to8 SSE2") { return kernel_downcast16to8_test<CPUType::SSE2>(); }
 
@@ -25,6 +25,12 @@ void kernel_exp_approx_taylor_test() {
     CHECK_EPS(output[i], exp(input[i]), 0.001f);
 }
 
+template void kernel_exp_approx_taylor_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("exp_approx_taylor Generic") { return kernel_exp_approx_taylor_test<CPUType::UNSUPPORTED>(); }
+
+template INTGEMM_SSE2 void kernel_exp_approx_taylor_test<CPUType::SSE2>();
+KERNEL_TEST_CASE("exp_approx_taylor SSE2") { return kernel_exp_approx_taylor_test<CPUType::SSE2>(); }
+
 #ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
 template INTGEMM_AVX2 void kernel_exp_approx_taylor_test<CPUType::AVX2>();
 KERNEL_TEST_CASE("exp_approx_taylor AVX2") { return kernel_exp_approx_taylor_test<CPUType::AVX2>(); }
@@ -0,0 +1,98 @@
+#include "../test.h"
+#include "../../intgemm/aligned.h"
+#include "../../intgemm/kernels.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace intgemm {
+
+namespace {
+
+float FromBits(uint32_t bits) {
+  float ret;
+  std::memcpy(&ret, &bits, sizeof(ret));
+  return ret;
+}
+
+const std::vector<std::pair<float, uint16_t>>& BFloat16Cases() {
+  static const std::vector<std::pair<float, uint16_t>> cases = {
+    {0.0f, 0x0000}, {-0.0f, 0x8000}, {1.0f, 0x3f80}, {-2.5f, 0xc020},
+    {FromBits(0x3f808000), 0x3f80}, // Tie, round down to even.
+    {FromBits(0x3f818000), 0x3f82}, // Tie, round up to even.
+    {FromBits(0x3f808001), 0x3f81},
+    {std::numeric_limits<float>::max(), 0x7f80},
+    {std::numeric_limits<float>::infinity(), 0x7f80},
+    {-std::numeric_limits<float>::infinity(), 0xff80},
+    {std::numeric_limits<float>::quiet_NaN(), 0x7fc0},
+    {FromBits(0x7f800001), 0x7fc0}, // NaN with only low bits must not become infinity.
+    {std::numeric_limits<float>::denorm_min(), 0x0000},
+    {-3.0e38f, 0xff62},
+  };
+  return cases;
+}
+
+const std::vector<std::pair<float, uint16_t>>& Float16Cases() {
+  static const std::vector<std::pair<float, uint16_t>> cases = {
+    {0.0f, 0x0000}, {-0.0f, 0x8000}, {1.0f, 0x3c00}, {-2.5f, 0xc100},
+    {1.0f + 1.0f / 2048, 0x3c00}, // Tie, round down to even.
+    {1.0f + 3.0f / 2048, 0x3c02}, // Tie, round up to even.
+    {65504.0f, 0x7bff}, {65519.0f, 0x7bff}, {65520.0f, 0x7c00}, {-1.0e6f, 0xfc00},
+    {6.103515625e-5f, 0x0400}, // Smallest normal.
+    {1.0e-7f, 0x0002}, {3.0e-8f, 0x0001}, {2.0e-8f, 0x0000}, // Subnormals.
+    {std::numeric_limits<float>::infinity(), 0x7c00},
+    {-std::numeric_limits<float>::infinity(), 0xfc00},
+    {std::numeric_limits<float>::quiet_NaN(), 0x7e00},
+  };
+  return cases;
+}
+
+} // namespace
+
+template <CPUType CPUType_>
+void kernel_float16_test() {
+  if (kCPU < CPUType_)
+    return;
+
+  using vec_t = vector_t<CPUType_, float>;
+  constexpr static auto VECTOR_LENGTH = sizeof(vec_t) / sizeof(float);
+
+  AlignedVector<float> input(VECTOR_LENGTH);
+  uint16_t output[VECTOR_LENGTH];
+
+  const auto& bfloat16_cases = BFloat16Cases();
+  for (std::size_t start = 0; start < bfloat16_cases.size(); start += VECTOR_LENGTH) {
+    for (std::size_t i = 0; i < VECTOR_LENGTH; ++i)
+      input[i] = bfloat16_cases[(start + i) % bfloat16_cases.size()].first;
+    auto converted = kernels::to_bfloat16(*input.template as<vec_t>());
+    std::memcpy(output, &converted, sizeof(output));
+    for (std::size_t i = 0; i < VECTOR_LENGTH; ++i)
+      CHECK_MESSAGE(output[i] == bfloat16_cases[(start + i) % bfloat16_cases.size()].second, "bfloat16 of " << input[i] << " is " << std::hex << output[i]);
+  }
+
+  const auto& float16_cases = Float16Cases();
+  for (std::size_t start = 0; start < float16_cases.size(); start += VECTOR_LENGTH) {
+    for (std::size_t i = 0; i < VECTOR_LENGTH; ++i)
+      input[i] = float16_cases[(start + i) % float16_cases.size()].first;
+    auto converted = kernels::to_float16(*input.template as<vec_t>());
+    std::memcpy(output, &converted, sizeof(output));
+    for (std::size_t i = 0; i < VECTOR_LENGTH; ++i)
+      CHECK_MESSAGE(output[i] == float16_cases[(start + i) % float16_cases.size()].second, "float16 of " << input[i] << " is " << std::hex << output[i]);
+  }
+}
+
+template void kernel_float16_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("float16 Generic") { return kernel_float16_test<CPUType::UNSUPPORTED>(); }
+
+template INTGEMM_SSE2 void kernel_float16_test<CPUType::SSE2>();
+KERNEL_TEST_CASE("float16 SSE2") { return kernel_float16_test<CPUType::SSE2>(); }
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+template INTGEMM_AVX2 void kernel_float16_test<CPUType::AVX2>();
+KERNEL_TEST_CASE("float16 AVX2") { return kernel_float16_test<CPUType::AVX2>(); }
+#endif
+
+}
@@ -25,6 +25,9 @@ void kernel_floor_test() {
     CHECK(output[i] == std::floor(input[i]));
 }
 
+template void kernel_floor_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("floor Generic") { return kernel_floor_test<CPUType::UNSUPPORTED>(); }
+
 template INTGEMM_SSE2 void kernel_floor_test<CPUType::SSE2>();
 KERNEL_TEST_CASE("floor SSE2") { return kernel_floor_test<CPUType::SSE2>(); }
 
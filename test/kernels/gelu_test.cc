@@ -0,0 +1,50 @@
+#include "../test.h"
+#include "../../intgemm/aligned.h"
+#include "../../intgemm/kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+
+namespace intgemm {
+
+float gelu_ref(float x) {
+  return 0.5f * x * (1 + std::tanh(std::sqrt(2 / 3.14159265358979f) * (x + 0.044715f * x * x * x)));
+}
+
+template <CPUType CPUType_>
+void kernel_gelu_test() {
+  if (kCPU < CPUType_)
+    return;
+
+  using vec_t = vector_t<CPUType_, float>;
+  constexpr static std::size_t VECTOR_LENGTH = sizeof(vec_t) / sizeof(float);
+
+  AlignedVector<float> input(VECTOR_LENGTH);
+  AlignedVector<float> output(VECTOR_LENGTH);
+
+  std::generate(input.begin(), input.end(), [] () { static int n = -int(VECTOR_LENGTH / 2); return n++ / float(VECTOR_LENGTH / 4); });
+
+  *output.template as<vec_t>() = kernels::gelu(*input.template as<vec_t>());
+  for (std::size_t i = 0; i < output.size(); ++i)
+    CHECK_EPS(output[i], gelu_ref(input[i]), 0.002f);
+}
+
+template void kernel_gelu_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("gelu Generic") { return kernel_gelu_test<CPUType::UNSUPPORTED>(); }
+
+template INTGEMM_SSE2 void kernel_gelu_test<CPUType::SSE2>();
+KERNEL_TEST_CASE("gelu SSE2") { return kernel_gelu_test<CPUType::SSE2>(); }
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+template INTGEMM_AVX2 void kernel_gelu_test<CPUType::AVX2>();
+KERNEL_TEST_CASE("gelu AVX2") { return kernel_gelu_test<CPUType::AVX2>(); }
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+template INTGEMM_AVX512BW void kernel_gelu_test<CPUType::AVX512BW>();
+KERNEL_TEST_CASE("gelu AVX512BW") { return kernel_gelu_test<CPUType::AVX512BW>(); }
+#endif
+
+}
@@ -27,6 +27,17 @@ void kernel_multiply_test() {
     CHECK(output[i] == Type_(input1[i] * input2[i]));
 }
 
+template void kernel_multiply_test<CPUType::UNSUPPORTED, int8_t>();
+template void kernel_multiply_test<CPUType::UNSUPPORTED, int16_t>();
+template void kernel_multiply_test<CPUType::UNSUPPORTED, int>();
+template void kernel_multiply_test<CPUType::UNSUPPORTED, float>();
+template void kernel_multiply_test<CPUType::UNSUPPORTED, double>();
+KERNEL_TEST_CASE("multiply/int8 Generic") { return kernel_multiply_test<CPUType::UNSUPPORTED, int8_t>(); }
+KERNEL_TEST_CASE("multiply/int16 Generic") { return kernel_multiply_test<CPUType::UNSUPPORTED, int16_t>(); }
+KERNEL_TEST_CASE("multiply/int Generic") { return kernel_multiply_test<CPUType::UNSUPPORTED, int>(); }
+KERNEL_TEST_CASE("multiply/float Generic") { return kernel_multiply_test<CPUType::UNSUPPORTED, float>(); }
+KERNEL_TEST_CASE("multiply/double Generic") { return kernel_multiply_test<CPUType::UNSUPPORTED, double>(); }
+
 template INTGEMM_SSE2 void kernel_multiply_test<CPUType::SSE2, int8_t>();
 template INTGEMM_SSE2 void kernel_multiply_test<CPUType::SSE2, int16_t>();
 template INTGEMM_SSE2 void kernel_multiply_test<CPUType::SSE2, int>();
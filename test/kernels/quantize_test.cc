@@ -25,6 +25,9 @@ void kernel_quantize_test() {
     CHECK(output[i] == int(i*2.f));
 }
 
+template void kernel_quantize_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("quantize Generic") { return kernel_quantize_test<CPUType::UNSUPPORTED>(); }
+
 template INTGEMM_SSE2 void kernel_quantize_test<CPUType::SSE2>();
 KERNEL_TEST_CASE("quantize SSE2") { return kernel_quantize_test<CPUType::SSE2>(); }
 
@@ -25,6 +25,17 @@ void kernel_relu_test() {
     CHECK(output[i] == (input[i] < 0 ? 0 : input[i]));
 }
 
+template void kernel_relu_test<CPUType::UNSUPPORTED, int8_t>();
+template void kernel_relu_test<CPUType::UNSUPPORTED, int16_t>();
+template void kernel_relu_test<CPUType::UNSUPPORTED, int>();
+template void kernel_relu_test<CPUType::UNSUPPORTED, float>();
+template void kernel_relu_test<CPUType::UNSUPPORTED, double>();
+KERNEL_TEST_CASE("relu/int8 Generic") { return kernel_relu_test<CPUType::UNSUPPORTED, int8_t>(); }
+KERNEL_TEST_CASE("relu/int16 Generic") { return kernel_relu_test<CPUType::UNSUPPORTED, int16_t>(); }
+KERNEL_TEST_CASE("relu/int Generic") { return kernel_relu_test<CPUType::UNSUPPORTED, int>(); }
+KERNEL_TEST_CASE("relu/float Generic") { return kernel_relu_test<CPUType::UNSUPPORTED, float>(); }
+KERNEL_TEST_CASE("relu/double Generic") { return kernel_relu_test<CPUType::UNSUPPORTED, double>(); }
+
 template INTGEMM_SSE2 void kernel_relu_test<CPUType::SSE2, int8_t>();
 template INTGEMM_SSE2 void kernel_relu_test<CPUType::SSE2, int16_t>();
 template INTGEMM_SSE2 void kernel_relu_test<CPUType::SSE2, int>();
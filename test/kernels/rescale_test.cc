@@ -27,6 +27,9 @@ void kernel_rescale_test() {
     CHECK(output[i] == std::round(input[i] * scale));
 }
 
+template void kernel_rescale_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("rescale Generic") { return kernel_rescale_test<CPUType::UNSUPPORTED>(); }
+
 template INTGEMM_SSE2 void kernel_rescale_test<CPUType::SSE2>();
 KERNEL_TEST_CASE("rescale SSE2") { return kernel_rescale_test<CPUType::SSE2>(); }
 
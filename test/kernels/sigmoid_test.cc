@@ -32,6 +32,12 @@ void kernel_sigmoid_test() {
     CHECK_EPS(output[i], sigmoid_ref(input[i]), 0.001f);
 }
 
+template void kernel_sigmoid_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("sigmoid Generic") { return kernel_sigmoid_test<CPUType::UNSUPPORTED>(); }
+
+template INTGEMM_SSE2 void kernel_sigmoid_test<CPUType::SSE2>();
+KERNEL_TEST_CASE("sigmoid SSE2") { return kernel_sigmoid_test<CPUType::SSE2>(); }
+
 #ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
 template INTGEMM_AVX2 void kernel_sigmoid_test<CPUType::AVX2>();
 KERNEL_TEST_CASE("sigmoid AVX2") { return kernel_sigmoid_test<CPUType::AVX2>(); }
@@ -25,6 +25,12 @@ void kernel_tanh_test() {
     CHECK_EPS(output[i], tanh(input[i]), 0.001f);
 }
 
+template void kernel_tanh_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("tanh Generic") { return kernel_tanh_test<CPUType::UNSUPPORTED>(); }
+
+template INTGEMM_SSE2 void kernel_tanh_test<CPUType::SSE2>();
+KERNEL_TEST_CASE("tanh SSE2") { return kernel_tanh_test<CPUType::SSE2>(); }
+
 #ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
 template INTGEMM_AVX2 void kernel_tanh_test<CPUType::AVX2>();
 KERNEL_TEST_CASE("tanh AVX2") { return kernel_tanh_test<CPUType::AVX2>(); }
@@ -25,6 +25,9 @@ void kernel_unquantize_test() {
     CHECK(output[i] == i * 0.5f);
 }
 
+template void kernel_unquantize_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("unquantize Generic") { return kernel_unquantize_test<CPUType::UNSUPPORTED>(); }
+
 template INTGEMM_SSE2 void kernel_unquantize_test<CPUType::SSE2>();
 KERNEL_TEST_CASE("unquantize SSE2") { return kernel_unquantize_test<CPUType::SSE2>(); }
 
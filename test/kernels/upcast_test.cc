@@ -30,6 +30,9 @@ void kernel_upcast8to16_test() {
     CHECK(output[i] == int16_t(input[i]));
 }
 
+template void kernel_upcast8to16_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("upcast8to16 Generic") { return kernel_upcast8to16_test<CPUType::UNSUPPORTED>(); }
+
 template INTGEMM_SSE2 void kernel_upcast8to16_test<CPUType::SSE2>();
 KERNEL_TEST_CASE("upcast8to16 SSE2") { return kernel_upcast8to16_test<CPUType::SSE2>(); }
 
@@ -64,6 +67,9 @@ void kernel_upcast16to32_test() {
     CHECK(output[i] == int32_t(input[i]));
 }
 
+template void kernel_upcast16to32_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("upcast16to32 Generic") { return kernel_upcast16to32_test<CPUType::UNSUPPORTED>(); }
+
 template INTGEMM_SSE2 void kernel_upcast16to32_test<CPUType::SSE2>();
 KERNEL_TEST_CASE("upcast16to32 SSE2") { return kernel_upcast16to32_test<CPUType::SSE2>(); }
 
@@ -101,6 +107,9 @@ void kernel_upcast8to32_test() {
     CHECK(output[i] == int32_t(input[i]));
 }
 
+template void kernel_upcast8to32_test<CPUType::UNSUPPORTED>();
+KERNEL_TEST_CASE("upcast8to32 Generic") { return kernel_upcast8to32_test<CPUType::UNSUPPORTED>(); }
+
 template INTGEMM_SSE2 void kernel_upcast8to32_test<CPUType::SSE2>();
 KERNEL_TEST_CASE("upcast8to32 SSE2") { return kernel_upcast8to32_test<CPUType::SSE2>(); }
 
@@ -25,6 +25,17 @@ void kernel_write_test() {
     CHECK(output[i] == ElemType_(i));
 }
 
+template void kernel_write_test<CPUType::UNSUPPORTED, int8_t>();
+template void kernel_write_test<CPUType::UNSUPPORTED, int16_t>();
+template void kernel_write_test<CPUType::UNSUPPORTED, int>();
+template void kernel_write_test<CPUType::UNSUPPORTED, float>();
+template void kernel_write_test<CPUType::UNSUPPORTED, double>();
+KERNEL_TEST_CASE("write/int8 Generic") { return kernel_write_test<CPUType::UNSUPPORTED, int8_t>(); }
+KERNEL_TEST_CASE("write/int16 Generic") { return kernel_write_test<CPUType::UNSUPPORTED, int16_t>(); }
+KERNEL_TEST_CASE("write/int Generic") { return kernel_write_test<CPUType::UNSUPPORTED, int>(); }
+KERNEL_TEST_CASE("write/float Generic") { return kernel_write_test<CPUType::UNSUPPORTED, float>(); }
+KERNEL_TEST_CASE("write/double Generic") { return kernel_write_test<CPUType::UNSUPPORTED, double>(); }
+
 template INTGEMM_SSE2 void kernel_write_test<CPUType::SSE2, int8_t>();
 template INTGEMM_SSE2 void kernel_write_test<CPUType::SSE2, int16_t>();
 template INTGEMM_SSE2 void kernel_write_test<CPUType::SSE2, int>();
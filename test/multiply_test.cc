@@ -115,11 +115,20 @@ TEST_CASE("Prepare SSSE3", "[prepare]") {
 
 TEST_CASE("Prepare SSE2", "[prepare]") {
   if (kCPU < CPUType::SSE2) return;
+  TestPrepare<SSE2::Kernels8>(16, 8);
+  TestPrepare<SSE2::Kernels8>(32, 32);
   TestPrepare<SSE2::Kernels16>(8, 8);
   TestPrepare<SSE2::Kernels16>(32, 32);
 }
 
-template <class Routine> void TestSelectColumnsB(Index rows = 64, Index cols = 16) {
+TEST_CASE("Prepare Generic", "[prepare]") {
+  TestPrepare<Generic::Kernels16>(8, 8);
+  TestPrepare<Generic::Kernels16>(32, 32);
+  TestPrepare<Generic::Kernels8>(16, 8);
+  TestPrepare<Generic::Kernels8>(32, 32);
+}
+
+template <class Routine> void TestSelectColumnsB(Index rows = 64, Index cols = 16, Index select_count = 24) {
   std::mt19937 gen;
   // Go somewhat out of range too.
   std::uniform_real_distribution<float> dist(-129.0, 129.0);
@@ -131,28 +140,28 @@ template <class Routine> void TestSelectColumnsB(Index rows = 64, Index cols = 1
   AlignedVector<Integer> prepared(input.size());
   Routine::PrepareB(input.begin(), prepared.begin(), 1, rows, cols);
 
-  const int kSelectCols = 24;
-  Index select_cols[kSelectCols];
+  std::vector<Index> select_cols(select_count);
   std::uniform_int_distribution<Index> col_dist(0, cols - 1);
   for (auto& it : select_cols) {
     it = col_dist(gen);
   }
+  // Output is padded with zero columns to a multiple of 8.
+  const Index padded = (select_count + 7) & ~7;
 
-  AlignedVector<Integer> test(rows * kSelectCols);
-  Routine::SelectColumnsB(prepared.begin(), test.begin(), rows, select_cols, select_cols + kSelectCols);
+  AlignedVector<Integer> test(rows * padded);
+  Routine::SelectColumnsB(prepared.begin(), test.begin(), rows, select_cols.data(), select_cols.data() + select_count);
 
   // Select columns manually in float space.
-  AlignedVector<float> selected(rows * kSelectCols);
+  AlignedVector<float> selected(rows * padded);
   for (Index r = 0; r < rows; ++r) {
-    for (int c = 0; c < kSelectCols; ++c) {
-      assert(c + r * kSelectCols < rows * kSelectCols);
-      selected[c + r * kSelectCols] = input[select_cols[c] + r * cols];
+    for (Index c = 0; c < padded; ++c) {
+      selected[c + r * padded] = c < select_count ? input[select_cols[c] + r * cols] : 0.0f;
     }
   }
-  AlignedVector<Integer> ref(rows * kSelectCols);
-  Routine::PrepareB(selected.begin(), ref.begin(), 1, rows, kSelectCols);
-  CHECK_MESSAGE(memcmp(ref.begin(), test.begin(), sizeof(Integer) * rows * kSelectCols) == 0, "Reference:\n" <<
-  	PrintMatrix(ref.begin(), rows, kSelectCols) << PrintMatrix(test.begin(), rows, kSelectCols));
+  AlignedVector<Integer> ref(rows * padded);
+  Routine::PrepareB(selected.begin(), ref.begin(), 1, rows, padded);
+  CHECK_MESSAGE(memcmp(ref.begin(), test.begin(), sizeof(Integer) * rows * padded) == 0, "Reference:\n" <<
+  	PrintMatrix(ref.begin(), rows, padded) << PrintMatrix(test.begin(), rows, padded));
 }
 
 #ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
@@ -160,6 +169,8 @@ TEST_CASE("SelectColumnsB AVX512", "[select]") {
   if (kCPU < CPUType::AVX512BW) return;
     TestSelectColumnsB<AVX512BW::Kernels8>();
     TestSelectColumnsB<AVX512BW::Kernels16>(256, 256);
+    TestSelectColumnsB<AVX512BW::Kernels8>(256, 256, 1001);
+    TestSelectColumnsB<AVX512BW::Kernels16>(256, 256, 21);
 }
 #endif
 
@@ -168,6 +179,8 @@ TEST_CASE("SelectColumnsB AVX2", "[select]") {
   if (kCPU < CPUType::AVX2) return;
   TestSelectColumnsB<AVX2::Kernels8>(256, 256);
   TestSelectColumnsB<AVX2::Kernels16>(256, 256);
+  TestSelectColumnsB<AVX2::Kernels8>(256, 256, 1001);
+  TestSelectColumnsB<AVX2::Kernels16>(256, 256, 21);
 }
 #endif
 
@@ -175,12 +188,26 @@ TEST_CASE("SelectColumnsB SSSE3", "[select]") {
   if (kCPU < CPUType::SSSE3) return;
   TestSelectColumnsB<SSSE3::Kernels8>();
   TestSelectColumnsB<SSSE3::Kernels8>(256, 256);
+  TestSelectColumnsB<SSSE3::Kernels8>(256, 256, 1001);
 }
 
 TEST_CASE("SelectColumnsB SSE2", "[select]") {
   if (kCPU < CPUType::SSE2) return;
+  TestSelectColumnsB<SSE2::Kernels8>();
+  TestSelectColumnsB<SSE2::Kernels8>(256, 256);
   TestSelectColumnsB<SSE2::Kernels16>();
   TestSelectColumnsB<SSE2::Kernels16>(256, 256);
+  TestSelectColumnsB<SSE2::Kernels8>(256, 256, 1001);
+  TestSelectColumnsB<SSE2::Kernels16>(256, 256, 21);
+}
+
+TEST_CASE("SelectColumnsB Generic", "[select]") {
+  TestSelectColumnsB<Generic::Kernels16>();
+  TestSelectColumnsB<Generic::Kernels16>(256, 256);
+  TestSelectColumnsB<Generic::Kernels16>(256, 256, 21);
+  TestSelectColumnsB<Generic::Kernels8>();
+  TestSelectColumnsB<Generic::Kernels8>(256, 256);
+  TestSelectColumnsB<Generic::Kernels8>(256, 256, 1001);
 }
 
 template <class Register> void TestMax() {
@@ -242,6 +269,47 @@ TEST_CASE("MaxAbsolute AVX512BW", "[max]") {
 }
 #endif
 
+template <void (*Backend) (const float *, Index, Index, float *)> void TestColumnMaxAbsolute() {
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-8.0, 8.0);
+  for (Index cols = 1; cols < 70; cols += 3) {
+    const Index rows = 5;
+    AlignedVector<float> input(rows * cols);
+    for (auto& it : input) {
+      it = dist(gen);
+    }
+    input[(cols % rows) * cols + cols / 2] = -32.0;
+    std::vector<float> test(cols);
+    Backend(input.begin(), rows, cols, test.data());
+    for (Index c = 0; c < cols; ++c) {
+      float expected = 0.0f;
+      for (Index r = 0; r < rows; ++r) {
+        expected = std::max(expected, std::fabs(input[r * cols + c]));
+      }
+      CHECK_MESSAGE(expected == test[c], "Error: " << expected << " versus " << test[c] << " in column " << c << " of " << cols);
+    }
+  }
+}
+
+TEST_CASE("ColumnMaxAbsolute SSE2", "[max]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestColumnMaxAbsolute<SSE2::ColumnMaxAbsolute>();
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE("ColumnMaxAbsolute AVX2", "[max]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestColumnMaxAbsolute<AVX2::ColumnMaxAbsolute>();
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE("ColumnMaxAbsolute AVX512BW", "[max]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestColumnMaxAbsolute<AVX512BW::ColumnMaxAbsolute>();
+}
+#endif
+
 // Based on https://arxiv.org/abs/1705.01991
 
 // Copyright (c) 2017 Microsoft Corporation
@@ -510,6 +578,43 @@ TEST_CASE ("Multiply SSE2 16bit with bias and relu", "[biased_multiply_relu]") {
   TestMultiplyBiasRelu<SSE2::Kernels16>(200, 256, 256, .1f, 1, 0.01f);
 }
 
+TEST_CASE ("Multiply Generic 16bit", "[multiply]") {
+  TestMultiply<Generic::Kernels16>(8, 256, 256, .1f, 1, 0.01f);
+  TestMultiply<Generic::Kernels16>(8, 2048, 256, .1f, 1, 0.02f);
+  TestMultiply<Generic::Kernels16>(200, 256, 256, .1f, 1, 0.01f);
+}
+
+TEST_CASE ("Multiply Generic 16bit with bias and relu", "[biased_multiply_relu]") {
+  TestMultiplyBiasRelu<Generic::Kernels16>(8, 256, 256, .1f, 1, 0.01f);
+  TestMultiplyBiasRelu<Generic::Kernels16>(200, 256, 256, .1f, 1, 0.01f);
+}
+
+TEST_CASE ("Multiply SSE2 8bit", "[multiply]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiply<SSE2::Kernels8>(8, 256, 256, 0, 0.25f, 0.062f);
+  TestMultiply<SSE2::Kernels8>(8, 2048, 256, 0, 0.55f, 0.25f);
+  TestMultiply<SSE2::Kernels8>(320, 256, 256, 0, 0.26f, 0.059f);
+  TestMultiply<SSE2::Kernels8>(200, 256, 256, 0, 0.28f, 0.06f);
+}
+
+TEST_CASE ("Multiply Generic 8bit", "[multiply]") {
+  TestMultiply<Generic::Kernels8>(8, 256, 256, 0, 0.25f, 0.062f);
+  TestMultiply<Generic::Kernels8>(8, 2048, 256, 0, 0.55f, 0.25f);
+  TestMultiply<Generic::Kernels8>(320, 256, 256, 0, 0.26f, 0.059f);
+  TestMultiply<Generic::Kernels8>(200, 256, 256, 0, 0.28f, 0.06f);
+}
+
+TEST_CASE ("Multiply SSE2 8bit with bias and relu", "[biased_multiply_relu]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyBiasRelu<SSE2::Kernels8>(8, 256, 256, 0, 0.25f, 0.062f);
+  TestMultiplyBiasRelu<SSE2::Kernels8>(320, 256, 256, 0, 0.26f, 0.059f);
+}
+
+TEST_CASE ("Multiply Generic 8bit with bias and relu", "[biased_multiply_relu]") {
+  TestMultiplyBiasRelu<Generic::Kernels8>(8, 256, 256, 0, 0.25f, 0.062f);
+  TestMultiplyBiasRelu<Generic::Kernels8>(320, 256, 256, 0, 0.26f, 0.059f);
+}
+
 TEST_CASE ("Multiply SSSE3 8bit", "[multiply]") {
   if (kCPU < CPUType::SSSE3) return;
   TestMultiply<SSSE3::Kernels8>(8, 256, 256, 1.2f, 1.2f, 0.064f, 0.026f);
@@ -758,4 +863,2227 @@ TEST_CASE ("Multiply AVX2 16bit with bias and relu", "[biased_multiply_relu]") {
   }
 #endif
 
+// Top-k: compare with sorting the full unquantized output.
+template <class Routine> void TestMultiplyTopK(Index A_rows, Index width, Index B_cols, Index k) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\t' << k << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto& it : A) {
+    it = dist(gen);
+  }
+  for (auto& it : B) {
+    it = dist(gen);
+  }
+  const float quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (quant_mult * quant_mult);
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, width);
+  Routine::PrepareB(B.begin(), B_prep.begin(), quant_mult, width, B_cols);
+
+  AlignedVector<float> full(A_rows * B_cols);
+  std::vector<Index> indices(A_rows * k);
+  std::vector<float> scores(A_rows * k);
+  OMPParallelWrap<callbacks::UnquantizeAndTopK, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndTopK(unquant_mult, k, indices.data(), scores.data(), full.begin()));
+
+  for (Index r = 0; r < A_rows; ++r) {
+    std::vector<Index> order(B_cols);
+    std::iota(order.begin(), order.end(), 0);
+    const float *row = full.begin() + r * B_cols;
+    std::stable_sort(order.begin(), order.end(), [row](Index a, Index b) { return row[a] > row[b]; });
+    for (Index i = 0; i < k; ++i) {
+      CHECK(indices[r * k + i] == order[i]);
+      CHECK(scores[r * k + i] == row[order[i]]);
+    }
+  }
+
+  // Without writing the full output.
+  std::vector<Index> indices_only(A_rows * k);
+  std::vector<float> scores_only(A_rows * k);
+  OMPParallelWrap<callbacks::UnquantizeAndTopK, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndTopK(unquant_mult, k, indices_only.data(), scores_only.data()));
+  CHECK(indices_only == indices);
+  CHECK(scores_only == scores);
+
+  // Reusing a config starts from empty heaps: nothing is left over from -B.
+  for (auto& it : B) {
+    it = -it;
+  }
+  AlignedVector<int8_t> B_neg(B.size());
+  Routine::PrepareB(B.begin(), B_neg.begin(), quant_mult, width, B_cols);
+  const callbacks::UnquantizeAndTopK reused(unquant_mult, k, indices_only.data(), scores_only.data());
+  OMPParallelWrap<callbacks::UnquantizeAndTopK, Routine>(A_prep.begin(), B_neg.begin(), A_rows, width, B_cols, reused);
+  OMPParallelWrap<callbacks::UnquantizeAndTopK, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, reused);
+  CHECK(indices_only == indices);
+  CHECK(scores_only == scores);
+}
+
+TEST_CASE ("Multiply top-k SSE2 8bit", "[multiply_topk]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyTopK<SSE2::Kernels8>(5, 256, 256, 1);
+  TestMultiplyTopK<SSE2::Kernels8>(9, 256, 1024, 12);
+}
+
+TEST_CASE ("Multiply top-k Generic 8bit", "[multiply_topk]") {
+  TestMultiplyTopK<Generic::Kernels8>(5, 256, 256, 1);
+  TestMultiplyTopK<Generic::Kernels8>(9, 256, 1024, 12);
+}
+
+TEST_CASE ("Multiply top-k SSSE3 8bit", "[multiply_topk]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyTopK<SSSE3::Kernels8>(5, 256, 256, 1);
+  TestMultiplyTopK<SSSE3::Kernels8>(9, 256, 1024, 12);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply top-k AVX2 8bit", "[multiply_topk]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyTopK<AVX2::Kernels8>(5, 256, 256, 1);
+  TestMultiplyTopK<AVX2::Kernels8>(9, 256, 1024, 12);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply top-k AVX512 8bit", "[multiply_topk]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyTopK<AVX512BW::Kernels8>(5, 256, 256, 1);
+  TestMultiplyTopK<AVX512BW::Kernels8>(9, 256, 1024, 12);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply top-k AVX512VNNI 8bit", "[multiply_topk]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyTopK<AVX512VNNI::Kernels8>(5, 256, 256, 1);
+  TestMultiplyTopK<AVX512VNNI::Kernels8>(9, 256, 1024, 12);
+}
+#endif
+
+// Softmax statistics: finishing should match softmax over the full output.
+template <class Routine> void TestMultiplySoftmax(Index A_rows, Index width, Index B_cols) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto& it : A) {
+    it = dist(gen);
+  }
+  for (auto& it : B) {
+    it = dist(gen);
+  }
+  const float quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (quant_mult * quant_mult);
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, width);
+  Routine::PrepareB(B.begin(), B_prep.begin(), quant_mult, width, B_cols);
+
+  AlignedVector<float> logits(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndWrite(unquant_mult, logits.begin()));
+  AlignedVector<float> ref_softmax(logits.size());
+  AlignedVector<float> ref_log_softmax(logits.size());
+  for (Index r = 0; r < A_rows; ++r) {
+    const float *row = logits.begin() + r * B_cols;
+    double max = *std::max_element(row, row + B_cols);
+    double sum = 0;
+    for (Index c = 0; c < B_cols; ++c) {
+      sum += std::exp(row[c] - max);
+    }
+    for (Index c = 0; c < B_cols; ++c) {
+      ref_softmax[r * B_cols + c] = static_cast<float>(std::exp(row[c] - max) / sum);
+      ref_log_softmax[r * B_cols + c] = static_cast<float>(row[c] - max - std::log(sum));
+    }
+  }
+
+  AlignedVector<float> test_C(logits.size());
+  std::vector<float> row_max(A_rows), row_sum(A_rows);
+  const callbacks::UnquantizeAndWriteSoftmaxStats stats(unquant_mult, test_C.begin(), row_max.data(), row_sum.data());
+  OMPParallelWrap<callbacks::UnquantizeAndWriteSoftmaxStats, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, stats);
+  CompareEps(logits.begin(), test_C.begin(), test_C.size(), 0.000001f);
+  FinishSoftmax(test_C.begin(), A_rows, B_cols, B_cols, row_max.data(), row_sum.data());
+  CompareEps(ref_softmax.begin(), test_C.begin(), test_C.size(), 0.0001f);
+
+  // The same config again: the statistics start over.
+  OMPParallelWrap<callbacks::UnquantizeAndWriteSoftmaxStats, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, stats);
+  FinishLogSoftmax(test_C.begin(), A_rows, B_cols, B_cols, row_max.data(), row_sum.data());
+  CompareEps(ref_log_softmax.begin(), test_C.begin(), test_C.size(), 0.0005f);
+
+  // Strided: the output is columns [8, 8 + B_cols) of a wider matrix and
+  // finishing leaves the other columns alone.
+  const Index ldc = B_cols + 16;
+  AlignedVector<float> strided_C(A_rows * ldc);
+  std::fill(strided_C.begin(), strided_C.end(), 42.0f);
+  const callbacks::UnquantizeAndWriteSoftmaxStats strided_stats(unquant_mult, strided_C.begin() + 8, row_max.data(), row_sum.data());
+  OMPParallelWrapStrided<callbacks::UnquantizeAndWriteSoftmaxStats, Routine>(A_prep.begin(), width, B_prep.begin(), A_rows, width, B_cols, ldc, strided_stats);
+  FinishSoftmax(strided_C.begin() + 8, A_rows, B_cols, ldc, row_max.data(), row_sum.data());
+  for (Index r = 0; r < A_rows; ++r) {
+    for (Index c = 0; c < ldc; ++c) {
+      if (c >= 8 && c < 8 + B_cols) {
+        CHECK(std::fabs(strided_C[r * ldc + c] - ref_softmax[r * B_cols + c - 8]) < 0.0001f * std::max(0.01f, ref_softmax[r * B_cols + c - 8]));
+      } else {
+        CHECK(strided_C[r * ldc + c] == 42.0f);
+      }
+    }
+  }
+}
+
+TEST_CASE ("Multiply softmax SSE2 8bit", "[multiply_softmax]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplySoftmax<SSE2::Kernels8>(5, 256, 256);
+  TestMultiplySoftmax<SSE2::Kernels8>(9, 512, 1032);
+}
+
+TEST_CASE ("Multiply softmax Generic 8bit", "[multiply_softmax]") {
+  TestMultiplySoftmax<Generic::Kernels8>(5, 256, 256);
+  TestMultiplySoftmax<Generic::Kernels8>(9, 512, 1032);
+}
+
+TEST_CASE ("Multiply softmax SSSE3 8bit", "[multiply_softmax]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplySoftmax<SSSE3::Kernels8>(5, 256, 256);
+  TestMultiplySoftmax<SSSE3::Kernels8>(9, 512, 1032);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply softmax AVX2 8bit", "[multiply_softmax]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplySoftmax<AVX2::Kernels8>(5, 256, 256);
+  TestMultiplySoftmax<AVX2::Kernels8>(9, 512, 1032);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply softmax AVX512 8bit", "[multiply_softmax]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplySoftmax<AVX512BW::Kernels8>(5, 256, 256);
+  TestMultiplySoftmax<AVX512BW::Kernels8>(9, 512, 1032);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply softmax AVX512VNNI 8bit", "[multiply_softmax]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplySoftmax<AVX512VNNI::Kernels8>(5, 256, 256);
+  TestMultiplySoftmax<AVX512VNNI::Kernels8>(9, 512, 1032);
+}
+#endif
+
+// Activation epilogues: compare with the biased output passed through a scalar activation.
+template <class Routine, class Callback> void TestMultiplyActivation(Index A_rows, Index width, Index B_cols, float (*activation)(float)) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  AlignedVector<float> bias(B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto& it : A) {
+    it = dist(gen);
+  }
+  for (auto& it : B) {
+    it = dist(gen);
+  }
+  for (auto& it : bias) {
+    it = dist(gen);
+  }
+  const float quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (quant_mult * quant_mult);
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, width);
+  Routine::PrepareB(B.begin(), B_prep.begin(), quant_mult, width, B_cols);
+
+  AlignedVector<float> ref_C(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndAddBiasAndWrite(unquant_mult, bias.begin(), ref_C.begin()));
+  AlignedVector<float> test_C(ref_C.size());
+  OMPParallelWrap<Callback, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, Callback(unquant_mult, bias.begin(), test_C.begin()));
+  for (std::size_t i = 0; i < test_C.size(); ++i) {
+    const float expected = activation(ref_C[i]);
+    CHECK_EPS(test_C[i], expected, 0.002f * std::max(1.0f, std::fabs(expected)));
+  }
+}
+
+float SigmoidRef(float x) { return 1.0f / (1.0f + std::exp(-x)); }
+float TanhRef(float x) { return std::tanh(x); }
+float GeluRef(float x) { return 0.5f * x * (1.0f + std::tanh(0.7978845608028654f * (x + 0.044715f * x * x * x))); }
+float SiluRef(float x) { return x * SigmoidRef(x); }
+
+template <class Routine> void TestMultiplyActivations(Index A_rows, Index width, Index B_cols) {
+  TestMultiplyActivation<Routine, callbacks::UnquantizeAndAddBiasAndWriteSigmoid>(A_rows, width, B_cols, SigmoidRef);
+  TestMultiplyActivation<Routine, callbacks::UnquantizeAndAddBiasAndWriteTanh>(A_rows, width, B_cols, TanhRef);
+  TestMultiplyActivation<Routine, callbacks::UnquantizeAndAddBiasAndWriteGelu>(A_rows, width, B_cols, GeluRef);
+  TestMultiplyActivation<Routine, callbacks::UnquantizeAndAddBiasAndWriteSilu>(A_rows, width, B_cols, SiluRef);
+}
+
+TEST_CASE ("Multiply activations SSE2 8bit", "[multiply_activation]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyActivations<SSE2::Kernels8>(8, 256, 256);
+  TestMultiplyActivations<SSE2::Kernels8>(5, 512, 64);
+}
+
+TEST_CASE ("Multiply activations Generic 8bit", "[multiply_activation]") {
+  TestMultiplyActivations<Generic::Kernels8>(8, 256, 256);
+  TestMultiplyActivations<Generic::Kernels8>(5, 512, 64);
+}
+
+TEST_CASE ("Multiply activations SSSE3 8bit", "[multiply_activation]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyActivations<SSSE3::Kernels8>(8, 256, 256);
+  TestMultiplyActivations<SSSE3::Kernels8>(5, 512, 64);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply activations AVX2 8bit", "[multiply_activation]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyActivations<AVX2::Kernels8>(8, 256, 256);
+  TestMultiplyActivations<AVX2::Kernels8>(5, 512, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply activations AVX512 8bit", "[multiply_activation]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyActivations<AVX512BW::Kernels8>(8, 256, 256);
+  TestMultiplyActivations<AVX512BW::Kernels8>(5, 512, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply activations AVX512VNNI 8bit", "[multiply_activation]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyActivations<AVX512VNNI::Kernels8>(8, 256, 256);
+  TestMultiplyActivations<AVX512VNNI::Kernels8>(5, 512, 64);
+}
+#endif
+
+// Requantizing epilogue: compare with the float callback followed by PrepareA.
+template <class Routine, callbacks::Activation activation, class FloatCallback> void TestMultiplyRequantize(Index A_rows, Index width, Index B_cols) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\t' << static_cast<int>(activation) << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  AlignedVector<float> bias(B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto& it : A) {
+    it = dist(gen);
+  }
+  for (auto& it : B) {
+    it = dist(gen);
+  }
+  for (auto& it : bias) {
+    it = dist(gen);
+  }
+  const float quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (quant_mult * quant_mult);
+  // Small enough for some outputs to saturate.
+  const float next_quant_mult = 127.0f / 4.0f;
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, width);
+  Routine::PrepareB(B.begin(), B_prep.begin(), quant_mult, width, B_cols);
+
+  AlignedVector<float> float_C(A_rows * B_cols);
+  OMPParallelWrap<FloatCallback, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, FloatCallback(unquant_mult, bias.begin(), float_C.begin()));
+  AlignedVector<int8_t> ref_C(float_C.size());
+  Routine::PrepareA(float_C.begin(), ref_C.begin(), next_quant_mult, A_rows, B_cols);
+
+  AlignedVector<int8_t> test_C(ref_C.size());
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndRequantize<int8_t, activation>, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndAddBiasAndRequantize<int8_t, activation>(unquant_mult, bias.begin(), next_quant_mult, test_C.begin()));
+  for (std::size_t i = 0; i < test_C.size(); ++i) {
+    CHECK(static_cast<int>(test_C[i]) == static_cast<int>(ref_C[i]));
+  }
+
+  AlignedVector<uint8_t> test_shifted(ref_C.size());
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndRequantize<uint8_t, activation>, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndAddBiasAndRequantize<uint8_t, activation>(unquant_mult, bias.begin(), next_quant_mult, test_shifted.begin()));
+  for (std::size_t i = 0; i < test_shifted.size(); ++i) {
+    CHECK(static_cast<int>(test_shifted[i]) == static_cast<int>(ref_C[i]) + 127);
+  }
+}
+
+template <class Routine> void TestMultiplyRequantizes(Index A_rows, Index width, Index B_cols) {
+  TestMultiplyRequantize<Routine, callbacks::Activation::Identity, callbacks::UnquantizeAndAddBiasAndWrite>(A_rows, width, B_cols);
+  TestMultiplyRequantize<Routine, callbacks::Activation::Relu, callbacks::UnquantizeAndAddBiasAndWriteRelu>(A_rows, width, B_cols);
+  TestMultiplyRequantize<Routine, callbacks::Activation::Gelu, callbacks::UnquantizeAndAddBiasAndWriteGelu>(A_rows, width, B_cols);
+}
+
+TEST_CASE ("Multiply requantize SSE2 8bit", "[multiply_requantize]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyRequantizes<SSE2::Kernels8>(8, 256, 256);
+  TestMultiplyRequantizes<SSE2::Kernels8>(5, 512, 64);
+}
+
+TEST_CASE ("Multiply requantize Generic 8bit", "[multiply_requantize]") {
+  TestMultiplyRequantizes<Generic::Kernels8>(8, 256, 256);
+  TestMultiplyRequantizes<Generic::Kernels8>(5, 512, 64);
+}
+
+TEST_CASE ("Multiply requantize SSSE3 8bit", "[multiply_requantize]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyRequantizes<SSSE3::Kernels8>(8, 256, 256);
+  TestMultiplyRequantizes<SSSE3::Kernels8>(5, 512, 64);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply requantize AVX2 8bit", "[multiply_requantize]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyRequantizes<AVX2::Kernels8>(8, 256, 256);
+  TestMultiplyRequantizes<AVX2::Kernels8>(5, 512, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply requantize AVX512 8bit", "[multiply_requantize]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyRequantizes<AVX512BW::Kernels8>(8, 256, 256);
+  TestMultiplyRequantizes<AVX512BW::Kernels8>(5, 512, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply requantize AVX512VNNI 8bit", "[multiply_requantize]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyRequantizes<AVX512VNNI::Kernels8>(8, 256, 256);
+  TestMultiplyRequantizes<AVX512VNNI::Kernels8>(5, 512, 64);
+}
+#endif
+
+// Per-column scales: columns of B differ in magnitude by up to 2^7 and should
+// all keep the error of a well scaled 8-bit multiply.
+template <class Routine> void TestMultiplyPerColumn(Index A_rows, Index width, Index B_cols) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  AlignedVector<float> bias(B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto& it : A) {
+    it = dist(gen);
+  }
+  for (Index r = 0; r < width; ++r) {
+    for (Index c = 0; c < B_cols; ++c) {
+      B[r * B_cols + c] = dist(gen) * std::ldexp(1.0f, -static_cast<int>(c % 8));
+    }
+  }
+  for (auto& it : bias) {
+    it = dist(gen);
+  }
+
+  const float A_quant_mult = 64.0f;
+  AlignedVector<float> column_max(B_cols);
+  ColumnMaxAbsolute(B.begin(), width, B_cols, column_max.begin());
+  AlignedVector<float> quant_mults(B_cols);
+  AlignedVector<float> unquant_mults(B_cols);
+  for (Index c = 0; c < B_cols; ++c) {
+    // Small enough that SSSE3 does not saturate its 16-bit sums at width 512.
+    quant_mults[c] = 32.0f / column_max[c];
+    unquant_mults[c] = 1.0f / (A_quant_mult * quant_mults[c]);
+  }
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), A_quant_mult, A_rows, width);
+  AlignedVector<float> B_scaled(B.size());
+  for (Index r = 0; r < width; ++r) {
+    for (Index c = 0; c < B_cols; ++c) {
+      B_scaled[r * B_cols + c] = B[r * B_cols + c] * quant_mults[c];
+    }
+  }
+  Routine::PrepareB(B_scaled.begin(), B_prep.begin(), 1.0f, width, B_cols);
+
+  AlignedVector<float> test_C(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizePerColumnAndAddBiasAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizePerColumnAndAddBiasAndWrite(unquant_mults.begin(), bias.begin(), test_C.begin()));
+  AlignedVector<float> test_nobias(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizePerColumnAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizePerColumnAndWrite(unquant_mults.begin(), test_nobias.begin()));
+
+  AlignedVector<float> float_C(A_rows * B_cols);
+  references::Multiply(A.begin(), B.begin(), float_C.begin(), A_rows, width, B_cols, [&](double sum, const callbacks::OutputBufferInfo&) {
+    return static_cast<float>(sum);
+  });
+  for (Index r = 0; r < A_rows; ++r) {
+    for (Index c = 0; c < B_cols; ++c) {
+      const Index i = r * B_cols + c;
+      // Error relative to the scale of the column.  One scale for all of B
+      // would be off by about 2^7 times as much in the smallest columns.
+      const float tolerance = 0.03f * std::sqrt(static_cast<float>(width)) * column_max[c];
+      CHECK_EPS(test_nobias[i], float_C[i], tolerance);
+      CHECK_EPS(test_C[i], float_C[i] + bias[c], tolerance);
+    }
+  }
+}
+
+TEST_CASE ("Multiply per-column SSE2 8bit", "[multiply_per_column]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyPerColumn<SSE2::Kernels8>(8, 256, 256);
+  TestMultiplyPerColumn<SSE2::Kernels8>(5, 512, 64);
+}
+
+TEST_CASE ("Multiply per-column Generic 8bit", "[multiply_per_column]") {
+  TestMultiplyPerColumn<Generic::Kernels8>(8, 256, 256);
+  TestMultiplyPerColumn<Generic::Kernels8>(5, 512, 64);
+}
+
+TEST_CASE ("Multiply per-column SSSE3 8bit", "[multiply_per_column]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyPerColumn<SSSE3::Kernels8>(8, 256, 256);
+  TestMultiplyPerColumn<SSSE3::Kernels8>(5, 512, 64);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply per-column AVX2 8bit", "[multiply_per_column]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyPerColumn<AVX2::Kernels8>(8, 256, 256);
+  TestMultiplyPerColumn<AVX2::Kernels8>(5, 512, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply per-column AVX512 8bit", "[multiply_per_column]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyPerColumn<AVX512BW::Kernels8>(8, 256, 256);
+  TestMultiplyPerColumn<AVX512BW::Kernels8>(5, 512, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply per-column AVX512VNNI 8bit", "[multiply_per_column]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyPerColumn<AVX512VNNI::Kernels8>(8, 256, 256);
+  TestMultiplyPerColumn<AVX512VNNI::Kernels8>(5, 512, 64);
+}
+#endif
+
+TEST_CASE ("Multiply per-column Int8 dispatch", "[multiply_per_column]") {
+  if (kCPU < CPUType::SSE2) return;
+  const Index width = 128, B_cols = 24;
+  AlignedVector<float> B(width * B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto& it : B) it = dist(gen);
+  AlignedVector<float> quant_mults(B_cols);
+  ColumnMaxAbsolute(B.begin(), width, B_cols, quant_mults.begin());
+  for (auto& it : quant_mults) it = 127.0f / it;
+
+  AlignedVector<int8_t> test(B.size());
+  Int8::PrepareBPerColumn(B.begin(), test.begin(), quant_mults.begin(), width, B_cols);
+
+  AlignedVector<float> B_scaled(B.size());
+  for (Index i = 0; i < B.size(); ++i) B_scaled[i] = B[i] * quant_mults[i % B_cols];
+  AlignedVector<int8_t> reference(B.size());
+  Int8::PrepareB(B_scaled.begin(), reference.begin(), 1.0f, width, B_cols);
+  CHECK(std::equal(test.begin(), test.end(), reference.begin()));
+}
+
+// Row-wise quantization of A: each row should match PrepareA with its own
+// multiplier and the multiply should keep the error of every row relative to
+// that row's scale, even with rows that differ by a factor of 100.
+template <class Routine> void TestMultiplyRowwise(Index A_rows, Index width, Index B_cols) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  AlignedVector<float> bias(B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  const float row_magnitudes[] = {0.1f, 1.0f, 10.0f};
+  for (Index r = 0; r < A_rows; ++r) {
+    for (Index i = 0; i < width; ++i) {
+      A[r * width + i] = dist(gen) * row_magnitudes[r % 3];
+    }
+  }
+  for (auto& it : B) {
+    it = dist(gen);
+  }
+  for (auto& it : bias) {
+    it = dist(gen);
+  }
+
+  // 64 rather than 127 keeps SSSE3 from saturating like the other tests.
+  const float max_quant = 64.0f;
+  AlignedVector<int8_t> A_prep(A.size());
+  std::vector<float> row_scales(A_rows);
+  Routine::PrepareARowwise(A.begin(), A_prep.begin(), row_scales.data(), max_quant, A_rows, width);
+  AlignedVector<int8_t> row_ref(width);
+  for (Index r = 0; r < A_rows; ++r) {
+    const float *row = A.begin() + r * width;
+    float row_max = 0.0f;
+    for (Index i = 0; i < width; ++i) {
+      row_max = std::max(row_max, std::fabs(row[i]));
+    }
+    CHECK(row_scales[r] == Approx(row_max / max_quant));
+    Routine::PrepareA(row, row_ref.begin(), 1.0f / row_scales[r], 1, width);
+    CHECK(std::equal(row_ref.begin(), row_ref.end(), A_prep.begin() + r * width));
+  }
+
+  const float B_quant_mult = 64.0f;
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareB(B.begin(), B_prep.begin(), B_quant_mult, width, B_cols);
+  AlignedVector<float> test_C(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeRowScaledAndAddBiasAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeRowScaledAndAddBiasAndWrite(row_scales.data(), 1.0f / B_quant_mult, bias.begin(), test_C.begin()));
+
+  // Per-column unquantization gives the same result when every column has the same multiplier.
+  AlignedVector<float> column_unquant(B_cols);
+  for (auto& it : column_unquant) {
+    it = 1.0f / B_quant_mult;
+  }
+  AlignedVector<float> test_columns(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeRowScaledAndAddBiasAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeRowScaledAndAddBiasAndWrite(row_scales.data(), column_unquant.begin(), bias.begin(), test_columns.begin()));
+  CHECK(std::equal(test_C.begin(), test_C.end(), test_columns.begin()));
+
+  AlignedVector<float> float_C(A_rows * B_cols);
+  references::Multiply(A.begin(), B.begin(), float_C.begin(), A_rows, width, B_cols, [&](double sum, const callbacks::OutputBufferInfo& info) {
+    return static_cast<float>(sum + bias[info.col_idx]);
+  });
+  for (Index r = 0; r < A_rows; ++r) {
+    // Error relative to the scale of the row.
+    const float tolerance = 0.03f * std::sqrt(static_cast<float>(width)) * row_magnitudes[r % 3];
+    for (Index c = 0; c < B_cols; ++c) {
+      CHECK_EPS(test_C[r * B_cols + c], float_C[r * B_cols + c], tolerance);
+    }
+  }
+}
+
+TEST_CASE ("Multiply rowwise SSE2 8bit", "[multiply_rowwise]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyRowwise<SSE2::Kernels8>(8, 256, 256);
+  TestMultiplyRowwise<SSE2::Kernels8>(5, 128, 64);
+}
+
+TEST_CASE ("Multiply rowwise Generic 8bit", "[multiply_rowwise]") {
+  TestMultiplyRowwise<Generic::Kernels8>(8, 256, 256);
+  TestMultiplyRowwise<Generic::Kernels8>(5, 128, 64);
+}
+
+TEST_CASE ("Multiply rowwise SSSE3 8bit", "[multiply_rowwise]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyRowwise<SSSE3::Kernels8>(8, 256, 256);
+  TestMultiplyRowwise<SSSE3::Kernels8>(5, 128, 64);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply rowwise AVX2 8bit", "[multiply_rowwise]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyRowwise<AVX2::Kernels8>(8, 256, 256);
+  TestMultiplyRowwise<AVX2::Kernels8>(5, 128, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply rowwise AVX512 8bit", "[multiply_rowwise]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyRowwise<AVX512BW::Kernels8>(8, 256, 256);
+  TestMultiplyRowwise<AVX512BW::Kernels8>(5, 128, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply rowwise AVX512VNNI 8bit", "[multiply_rowwise]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyRowwise<AVX512VNNI::Kernels8>(8, 256, 256);
+  TestMultiplyRowwise<AVX512VNNI::Kernels8>(5, 128, 64);
+}
+#endif
+
+// Gated linear unit: compare with separate gate and up multiplies.
+template <class Routine, callbacks::Activation activation> void TestMultiplyGatedActivation(Index A_rows, Index width, Index C_cols, float (*ref)(float), bool with_bias) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << C_cols << '\t' << with_bias << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> gate(width * C_cols), up(width * C_cols);
+  AlignedVector<float> gate_bias(C_cols), up_bias(C_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto* mat : {&A, &gate, &up, &gate_bias, &up_bias}) {
+    for (auto& it : *mat) {
+      it = with_bias || (mat != &gate_bias && mat != &up_bias) ? dist(gen) : 0.0f;
+    }
+  }
+  const float quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (quant_mult * quant_mult);
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> gate_prep(gate.size()), up_prep(up.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, width);
+  Routine::PrepareB(gate.begin(), gate_prep.begin(), quant_mult, width, C_cols);
+  Routine::PrepareB(up.begin(), up_prep.begin(), quant_mult, width, C_cols);
+
+  AlignedVector<float> gate_C(A_rows * C_cols), up_C(A_rows * C_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndWrite, Routine>(A_prep.begin(), gate_prep.begin(), A_rows, width, C_cols, callbacks::UnquantizeAndAddBiasAndWrite(unquant_mult, gate_bias.begin(), gate_C.begin()));
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndWrite, Routine>(A_prep.begin(), up_prep.begin(), A_rows, width, C_cols, callbacks::UnquantizeAndAddBiasAndWrite(unquant_mult, up_bias.begin(), up_C.begin()));
+
+  AlignedVector<int8_t> B_prep(2 * gate_prep.size());
+  Int8::InterleaveGatedB(gate_prep.begin(), up_prep.begin(), B_prep.begin(), width, C_cols);
+  AlignedVector<float> test_C(A_rows * C_cols);
+  typedef callbacks::UnquantizeAndAddBiasAndGate<activation> Callback;
+  OMPParallelWrapGated<Callback, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, 2 * C_cols, Callback(unquant_mult, with_bias ? gate_bias.begin() : nullptr, unquant_mult, with_bias ? up_bias.begin() : nullptr, test_C.begin()));
+  for (Index i = 0; i < test_C.size(); ++i) {
+    float expected = ref(gate_C[i]) * up_C[i];
+    CHECK_EPS(test_C[i], expected, 0.002f * std::max(1.0f, std::fabs(expected)));
+  }
+}
+
+template <class Routine> void TestMultiplyGated(Index A_rows, Index width, Index C_cols) {
+  TestMultiplyGatedActivation<Routine, callbacks::Activation::Silu>(A_rows, width, C_cols, SiluRef, true);
+  TestMultiplyGatedActivation<Routine, callbacks::Activation::Sigmoid>(A_rows, width, C_cols, SigmoidRef, false);
+}
+
+TEST_CASE ("Multiply gated SSE2 8bit", "[multiply_gated]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyGated<SSE2::Kernels8>(8, 256, 256);
+  TestMultiplyGated<SSE2::Kernels8>(5, 128, 24);
+}
+
+TEST_CASE ("Multiply gated Generic 8bit", "[multiply_gated]") {
+  TestMultiplyGated<Generic::Kernels8>(8, 256, 256);
+  TestMultiplyGated<Generic::Kernels8>(5, 128, 24);
+}
+
+TEST_CASE ("Multiply gated SSSE3 8bit", "[multiply_gated]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyGated<SSSE3::Kernels8>(8, 256, 256);
+  TestMultiplyGated<SSSE3::Kernels8>(5, 128, 24);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply gated AVX2 8bit", "[multiply_gated]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyGated<AVX2::Kernels8>(8, 256, 256);
+  TestMultiplyGated<AVX2::Kernels8>(5, 128, 24);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply gated AVX512 8bit", "[multiply_gated]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyGated<AVX512BW::Kernels8>(8, 256, 256);
+  TestMultiplyGated<AVX512BW::Kernels8>(5, 128, 24);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply gated AVX512VNNI 8bit", "[multiply_gated]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyGated<AVX512VNNI::Kernels8>(8, 256, 256);
+  TestMultiplyGated<AVX512VNNI::Kernels8>(5, 128, 24);
+}
+#endif
+
+// Accumulating write: compare with writing into a scratch buffer and adding.
+template <class Routine> void TestMultiplyAccumulate(Index A_rows, Index width, Index B_cols) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  AlignedVector<float> bias(B_cols);
+  AlignedVector<float> residual(A_rows * B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto* mat : {&A, &B, &bias, &residual}) {
+    for (auto& it : *mat) {
+      it = dist(gen);
+    }
+  }
+  const float quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (quant_mult * quant_mult);
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, width);
+  Routine::PrepareB(B.begin(), B_prep.begin(), quant_mult, width, B_cols);
+
+  AlignedVector<float> product(A_rows * B_cols), product_bias(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndWrite(unquant_mult, product.begin()));
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndAddBiasAndWrite(unquant_mult, bias.begin(), product_bias.begin()));
+
+  // Residual add: C += A * B.
+  AlignedVector<float> test_C(A_rows * B_cols);
+  std::copy(residual.begin(), residual.end(), test_C.begin());
+  OMPParallelWrap<callbacks::UnquantizeAndAccumulate, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndAccumulate(unquant_mult, test_C.begin()));
+  for (Index i = 0; i < test_C.size(); ++i) {
+    CHECK(test_C[i] == Approx(product[i] + residual[i]).margin(1e-6));
+  }
+
+  // C = alpha * (A * B + bias) + beta * C.
+  const float alpha = 0.5f, beta = -2.0f;
+  std::copy(residual.begin(), residual.end(), test_C.begin());
+  AlignedVector<float> scaled_bias(B_cols);
+  for (Index i = 0; i < B_cols; ++i) {
+    scaled_bias[i] = alpha * bias[i];
+  }
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndAccumulate, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndAddBiasAndAccumulate(alpha * unquant_mult, scaled_bias.begin(), test_C.begin(), beta));
+  for (Index i = 0; i < test_C.size(); ++i) {
+    CHECK(test_C[i] == Approx(alpha * product_bias[i] + beta * residual[i]).margin(1e-6));
+  }
+}
+
+TEST_CASE ("Multiply accumulate SSE2 8bit", "[multiply_accumulate]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyAccumulate<SSE2::Kernels8>(8, 256, 256);
+  TestMultiplyAccumulate<SSE2::Kernels8>(5, 128, 64);
+}
+
+TEST_CASE ("Multiply accumulate Generic 8bit", "[multiply_accumulate]") {
+  TestMultiplyAccumulate<Generic::Kernels8>(8, 256, 256);
+  TestMultiplyAccumulate<Generic::Kernels8>(5, 128, 64);
+}
+
+TEST_CASE ("Multiply accumulate SSSE3 8bit", "[multiply_accumulate]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyAccumulate<SSSE3::Kernels8>(8, 256, 256);
+  TestMultiplyAccumulate<SSSE3::Kernels8>(5, 128, 64);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply accumulate AVX2 8bit", "[multiply_accumulate]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyAccumulate<AVX2::Kernels8>(8, 256, 256);
+  TestMultiplyAccumulate<AVX2::Kernels8>(5, 128, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply accumulate AVX512 8bit", "[multiply_accumulate]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyAccumulate<AVX512BW::Kernels8>(8, 256, 256);
+  TestMultiplyAccumulate<AVX512BW::Kernels8>(5, 128, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply accumulate AVX512VNNI 8bit", "[multiply_accumulate]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyAccumulate<AVX512VNNI::Kernels8>(8, 256, 256);
+  TestMultiplyAccumulate<AVX512VNNI::Kernels8>(5, 128, 64);
+}
+#endif
+
+// Strided A and output: compare with the contiguous multiply.
+template <class Routine> void TestMultiplyStrided(Index A_rows, Index width, Index B_cols) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\n';
+  INFO(info.str());
+
+  // A is a view of the first width columns of a wider matrix and C is a view
+  // of columns [8, 8 + B_cols) of a wider output.
+  const Index lda = width + 64;
+  const Index ldc = B_cols + 16;
+  AlignedVector<float> A(A_rows * lda);
+  AlignedVector<float> B(width * B_cols);
+  AlignedVector<float> bias(B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto* mat : {&A, &B, &bias}) {
+    for (auto& it : *mat) {
+      it = dist(gen);
+    }
+  }
+  const float quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (quant_mult * quant_mult);
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> A_dense(A_rows * width);
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, lda);
+  for (Index r = 0; r < A_rows; ++r) {
+    std::copy(A_prep.begin() + r * lda, A_prep.begin() + r * lda + width, A_dense.begin() + r * width);
+  }
+  Routine::PrepareB(B.begin(), B_prep.begin(), quant_mult, width, B_cols);
+
+  AlignedVector<float> ref_C(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndWrite, Routine>(A_dense.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndAddBiasAndWrite(unquant_mult, bias.begin(), ref_C.begin()));
+
+  AlignedVector<float> test_C(A_rows * ldc);
+  std::fill(test_C.begin(), test_C.end(), 42.0f);
+  OMPParallelWrapStrided<callbacks::UnquantizeAndAddBiasAndWrite, Routine>(A_prep.begin(), lda, B_prep.begin(), A_rows, width, B_cols, ldc, callbacks::UnquantizeAndAddBiasAndWrite(unquant_mult, bias.begin(), test_C.begin() + 8));
+  for (Index r = 0; r < A_rows; ++r) {
+    for (Index c = 0; c < ldc; ++c) {
+      if (c >= 8 && c < 8 + B_cols) {
+        CHECK(test_C[r * ldc + c] == ref_C[r * B_cols + c - 8]);
+      } else {
+        CHECK(test_C[r * ldc + c] == 42.0f);
+      }
+    }
+  }
+
+  // Row completion sees the stride too.
+  std::vector<float> mean(A_rows), rstd(A_rows);
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndLayerNorm, Routine>(A_dense.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndAddBiasAndLayerNorm(unquant_mult, bias.begin(), nullptr, nullptr, nullptr, 1e-5f, ref_C.begin(), mean.data(), rstd.data()));
+  OMPParallelWrapStrided<callbacks::UnquantizeAndAddBiasAndLayerNorm, Routine>(A_prep.begin(), lda, B_prep.begin(), A_rows, width, B_cols, ldc, callbacks::UnquantizeAndAddBiasAndLayerNorm(unquant_mult, bias.begin(), nullptr, nullptr, nullptr, 1e-5f, test_C.begin() + 8, mean.data(), rstd.data()));
+  for (Index r = 0; r < A_rows; ++r) {
+    for (Index c = 0; c < B_cols; ++c) {
+      CHECK(test_C[r * ldc + 8 + c] == Approx(ref_C[r * B_cols + c]).margin(1e-5));
+    }
+  }
+}
+
+TEST_CASE ("Multiply strided SSE2 8bit", "[multiply_strided]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyStrided<SSE2::Kernels8>(8, 256, 256);
+  TestMultiplyStrided<SSE2::Kernels8>(5, 128, 64);
+}
+
+TEST_CASE ("Multiply strided Generic 8bit", "[multiply_strided]") {
+  TestMultiplyStrided<Generic::Kernels8>(8, 256, 256);
+  TestMultiplyStrided<Generic::Kernels8>(5, 128, 64);
+}
+
+TEST_CASE ("Multiply strided SSSE3 8bit", "[multiply_strided]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyStrided<SSSE3::Kernels8>(8, 256, 256);
+  TestMultiplyStrided<SSSE3::Kernels8>(5, 128, 64);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply strided AVX2 8bit", "[multiply_strided]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyStrided<AVX2::Kernels8>(8, 256, 256);
+  TestMultiplyStrided<AVX2::Kernels8>(5, 128, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply strided AVX512 8bit", "[multiply_strided]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyStrided<AVX512BW::Kernels8>(8, 256, 256);
+  TestMultiplyStrided<AVX512BW::Kernels8>(5, 128, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply strided AVX512VNNI 8bit", "[multiply_strided]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyStrided<AVX512VNNI::Kernels8>(8, 256, 256);
+  TestMultiplyStrided<AVX512VNNI::Kernels8>(5, 128, 64);
+}
+#endif
+
+// Transposed output: compare with transposing the row-major output.
+template <class Routine> void TestMultiplyTransposed(Index A_rows, Index width, Index B_cols) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto& it : A) {
+    it = dist(gen);
+  }
+  for (auto& it : B) {
+    it = dist(gen);
+  }
+  const float quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (quant_mult * quant_mult);
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, width);
+  Routine::PrepareB(B.begin(), B_prep.begin(), quant_mult, width, B_cols);
+
+  AlignedVector<float> ref_C(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndWrite(unquant_mult, ref_C.begin()));
+  AlignedVector<float> test_C(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndWriteTransposed, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndWriteTransposed(unquant_mult, test_C.begin()));
+  for (Index r = 0; r < A_rows; ++r) {
+    for (Index c = 0; c < B_cols; ++c) {
+      CHECK(test_C[c * A_rows + r] == ref_C[r * B_cols + c]);
+    }
+  }
+
+  AlignedVector<int32_t> ref_int(A_rows * B_cols);
+  OMPParallelWrap<callbacks::Write<int32_t>, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::Write<int32_t>(ref_int.begin()));
+  AlignedVector<int32_t> test_int(A_rows * B_cols);
+  OMPParallelWrap<callbacks::WriteTransposed<int32_t>, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::WriteTransposed<int32_t>(test_int.begin()));
+  for (Index r = 0; r < A_rows; ++r) {
+    for (Index c = 0; c < B_cols; ++c) {
+      CHECK(test_int[c * A_rows + r] == ref_int[r * B_cols + c]);
+    }
+  }
+
+  // Multiply hands the callbacks whole tiles; the shortlist multiply doesn't
+  // tile, so a shortlist of every column checks the row by row path.
+  std::vector<Index> all_cols(B_cols);
+  std::iota(all_cols.begin(), all_cols.end(), 0);
+  std::fill(test_C.begin(), test_C.end(), 0.0f);
+  OMPParallelWrapShortlist<callbacks::UnquantizeAndWriteTransposed, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, all_cols.data(), all_cols.data() + B_cols, callbacks::UnquantizeAndWriteTransposed(unquant_mult, test_C.begin()));
+  for (Index r = 0; r < A_rows; ++r) {
+    for (Index c = 0; c < B_cols; ++c) {
+      CHECK(test_C[c * A_rows + r] == ref_C[r * B_cols + c]);
+    }
+  }
+}
+
+TEST_CASE ("Multiply transposed SSE2 8bit", "[multiply_transposed]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyTransposed<SSE2::Kernels8>(16, 256, 256);
+  TestMultiplyTransposed<SSE2::Kernels8>(13, 128, 64);
+  TestMultiplyTransposed<SSE2::Kernels8>(3, 64, 8);
+}
+
+TEST_CASE ("Multiply transposed Generic 8bit", "[multiply_transposed]") {
+  TestMultiplyTransposed<Generic::Kernels8>(16, 256, 256);
+  TestMultiplyTransposed<Generic::Kernels8>(13, 128, 64);
+  TestMultiplyTransposed<Generic::Kernels8>(3, 64, 8);
+}
+
+TEST_CASE ("Multiply transposed SSSE3 8bit", "[multiply_transposed]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyTransposed<SSSE3::Kernels8>(16, 256, 256);
+  TestMultiplyTransposed<SSSE3::Kernels8>(13, 128, 64);
+  TestMultiplyTransposed<SSSE3::Kernels8>(3, 64, 8);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply transposed AVX2 8bit", "[multiply_transposed]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyTransposed<AVX2::Kernels8>(16, 256, 256);
+  TestMultiplyTransposed<AVX2::Kernels8>(13, 128, 64);
+  TestMultiplyTransposed<AVX2::Kernels8>(3, 64, 8);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply transposed AVX512 8bit", "[multiply_transposed]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyTransposed<AVX512BW::Kernels8>(16, 256, 256);
+  TestMultiplyTransposed<AVX512BW::Kernels8>(13, 128, 64);
+  TestMultiplyTransposed<AVX512BW::Kernels8>(3, 64, 8);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply transposed AVX512VNNI 8bit", "[multiply_transposed]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyTransposed<AVX512VNNI::Kernels8>(16, 256, 256);
+  TestMultiplyTransposed<AVX512VNNI::Kernels8>(13, 128, 64);
+  TestMultiplyTransposed<AVX512VNNI::Kernels8>(3, 64, 8);
+}
+#endif
+
+// Head-split write: compare with reshaping the row-major output.
+template <class Routine> void TestMultiplyHeads(Index batch, Index seq, Index width, Index parts, Index heads, Index head_dim) {
+  const Index A_rows = batch * seq;
+  const Index B_cols = parts * heads * head_dim;
+  std::ostringstream info;
+  info << Routine::kName << "\t" << batch << '\t' << seq << '\t' << width << '\t' << parts << '\t' << heads << '\t' << head_dim << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  AlignedVector<float> bias(B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto* mat : {&A, &B, &bias}) {
+    for (auto& it : *mat) {
+      it = dist(gen);
+    }
+  }
+  const float quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (quant_mult * quant_mult);
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, width);
+  Routine::PrepareB(B.begin(), B_prep.begin(), quant_mult, width, B_cols);
+
+  AlignedVector<float> ref_C(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndAddBiasAndWrite(unquant_mult, bias.begin(), ref_C.begin()));
+  AlignedVector<float> test_C(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndWriteHeads, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndAddBiasAndWriteHeads(unquant_mult, bias.begin(), seq, heads, head_dim, test_C.begin()));
+  const float *out = test_C.begin();
+  for (Index p = 0; p < parts; ++p) {
+    for (Index b = 0; b < batch; ++b) {
+      for (Index h = 0; h < heads; ++h) {
+        for (Index s = 0; s < seq; ++s) {
+          for (Index d = 0; d < head_dim; ++d, ++out) {
+            CHECK(*out == ref_C[(b * seq + s) * B_cols + (p * heads + h) * head_dim + d]);
+          }
+        }
+      }
+    }
+  }
+}
+
+template <class Routine> void TestMultiplyHeads() {
+  TestMultiplyHeads<Routine>(3, 8, 256, 1, 2, 32);
+  // Fused QKV projection.
+  TestMultiplyHeads<Routine>(2, 5, 128, 3, 4, 16);
+}
+
+TEST_CASE ("Multiply heads SSE2 8bit", "[multiply_heads]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyHeads<SSE2::Kernels8>();
+}
+
+TEST_CASE ("Multiply heads Generic 8bit", "[multiply_heads]") {
+  TestMultiplyHeads<Generic::Kernels8>();
+}
+
+TEST_CASE ("Multiply heads SSSE3 8bit", "[multiply_heads]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyHeads<SSSE3::Kernels8>();
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply heads AVX2 8bit", "[multiply_heads]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyHeads<AVX2::Kernels8>();
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply heads AVX512 8bit", "[multiply_heads]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyHeads<AVX512BW::Kernels8>();
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply heads AVX512VNNI 8bit", "[multiply_heads]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyHeads<AVX512VNNI::Kernels8>();
+}
+#endif
+
+// Rotary position embeddings: compare with rotating the row-major output.
+template <class Routine> void TestMultiplyRotary(Index batch, Index seq, Index width, Index heads, Index head_dim, Index position_offset) {
+  const Index A_rows = batch * seq;
+  const Index B_cols = heads * head_dim;
+  std::ostringstream info;
+  info << Routine::kName << "\t" << batch << '\t' << seq << '\t' << width << '\t' << heads << '\t' << head_dim << '\t' << position_offset << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  AlignedVector<float> bias(B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto* mat : {&A, &B, &bias}) {
+    for (auto& it : *mat) {
+      it = dist(gen);
+    }
+  }
+  const Index positions = position_offset + seq;
+  AlignedVector<float> cos_table(positions * head_dim), sin_table(positions * head_dim);
+  for (Index p = 0; p < positions; ++p) {
+    for (Index i = 0; i < head_dim; ++i) {
+      float angle = p * std::pow(10000.0f, -static_cast<float>(i / 2 * 2) / head_dim);
+      cos_table[p * head_dim + i] = std::cos(angle);
+      sin_table[p * head_dim + i] = std::sin(angle);
+    }
+  }
+  const float quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (quant_mult * quant_mult);
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, width);
+  Routine::PrepareB(B.begin(), B_prep.begin(), quant_mult, width, B_cols);
+
+  AlignedVector<float> ref_C(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndAddBiasAndWrite(unquant_mult, bias.begin(), ref_C.begin()));
+  AlignedVector<float> test_C(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndRotary, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndAddBiasAndRotary(unquant_mult, bias.begin(), cos_table.begin(), sin_table.begin(), seq, head_dim, test_C.begin(), position_offset));
+  for (Index r = 0; r < A_rows; ++r) {
+    const Index p = position_offset + r % seq;
+    for (Index c = 0; c < B_cols; c += 2) {
+      const Index i = c % head_dim;
+      const float x0 = ref_C[r * B_cols + c], x1 = ref_C[r * B_cols + c + 1];
+      const float cos = cos_table[p * head_dim + i], sin = sin_table[p * head_dim + i];
+      CHECK_EPS(test_C[r * B_cols + c], x0 * cos - x1 * sin, 1e-5f);
+      CHECK_EPS(test_C[r * B_cols + c + 1], x0 * sin + x1 * cos, 1e-5f);
+    }
+  }
+}
+
+template <class Routine> void TestMultiplyRotary() {
+  TestMultiplyRotary<Routine>(2, 8, 256, 4, 32, 0);
+  TestMultiplyRotary<Routine>(3, 5, 128, 2, 16, 7);
+}
+
+TEST_CASE ("Multiply rotary SSE2 8bit", "[multiply_rotary]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyRotary<SSE2::Kernels8>();
+}
+
+TEST_CASE ("Multiply rotary Generic 8bit", "[multiply_rotary]") {
+  TestMultiplyRotary<Generic::Kernels8>();
+}
+
+TEST_CASE ("Multiply rotary SSSE3 8bit", "[multiply_rotary]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyRotary<SSSE3::Kernels8>();
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply rotary AVX2 8bit", "[multiply_rotary]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyRotary<AVX2::Kernels8>();
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply rotary AVX512 8bit", "[multiply_rotary]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyRotary<AVX512BW::Kernels8>();
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply rotary AVX512VNNI 8bit", "[multiply_rotary]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyRotary<AVX512VNNI::Kernels8>();
+}
+#endif
+
+// Recurrent cells: compare with the cell update on the separate gate outputs.
+template <class Routine> void TestMultiplyCell(Index A_rows, Index width, Index C_cols, bool with_bias) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << C_cols << '\t' << with_bias << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> gates[4] = {
+    AlignedVector<float>(width * C_cols), AlignedVector<float>(width * C_cols),
+    AlignedVector<float>(width * C_cols), AlignedVector<float>(width * C_cols)};
+  AlignedVector<float> bias(4 * C_cols);
+  AlignedVector<float> state(A_rows * C_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto* mat : {&A, &gates[0], &gates[1], &gates[2], &gates[3], &bias, &state}) {
+    for (auto& it : *mat) {
+      it = with_bias || mat != &bias ? dist(gen) : 0.0f;
+    }
+  }
+  const float quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (quant_mult * quant_mult);
+  AlignedVector<int8_t> A_prep(A.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, width);
+
+  // Gate pre-activations with bias, gate by gate.
+  AlignedVector<int8_t> gates_prep[4] = {
+    AlignedVector<int8_t>(width * C_cols), AlignedVector<int8_t>(width * C_cols),
+    AlignedVector<int8_t>(width * C_cols), AlignedVector<int8_t>(width * C_cols)};
+  AlignedVector<float> gates_C[4] = {
+    AlignedVector<float>(A_rows * C_cols), AlignedVector<float>(A_rows * C_cols),
+    AlignedVector<float>(A_rows * C_cols), AlignedVector<float>(A_rows * C_cols)};
+  for (Index g = 0; g < 4; ++g) {
+    Routine::PrepareB(gates[g].begin(), gates_prep[g].begin(), quant_mult, width, C_cols);
+    OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndWrite, Routine>(A_prep.begin(), gates_prep[g].begin(), A_rows, width, C_cols, callbacks::UnquantizeAndAddBiasAndWrite(unquant_mult, bias.begin() + g * C_cols, gates_C[g].begin()));
+  }
+  AlignedVector<int8_t> B_prep(4 * width * C_cols);
+  Int8::InterleaveCellB(gates_prep[0].begin(), gates_prep[1].begin(), gates_prep[2].begin(), gates_prep[3].begin(), B_prep.begin(), width, C_cols);
+  const float *bias_addr = with_bias ? bias.begin() : nullptr;
+
+  AlignedVector<float> cell(state.size()), hidden(state.size());
+  std::copy(state.begin(), state.end(), cell.begin());
+  OMPParallelWrapCell<callbacks::UnquantizeAndAddBiasAndLSTMCell, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, 4 * C_cols, callbacks::UnquantizeAndAddBiasAndLSTMCell(unquant_mult, bias_addr, cell.begin(), hidden.begin()));
+  for (Index i = 0; i < state.size(); ++i) {
+    float expected_cell = SigmoidRef(gates_C[1][i]) * state[i] + SigmoidRef(gates_C[0][i]) * std::tanh(gates_C[2][i]);
+    CHECK_EPS(cell[i], expected_cell, 0.002f * std::max(1.0f, std::fabs(expected_cell)));
+    CHECK_EPS(hidden[i], SigmoidRef(gates_C[3][i]) * std::tanh(expected_cell), 0.002f);
+  }
+
+  std::copy(state.begin(), state.end(), hidden.begin());
+  OMPParallelWrapCell<callbacks::UnquantizeAndAddBiasAndGRUCell, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, 4 * C_cols, callbacks::UnquantizeAndAddBiasAndGRUCell(unquant_mult, bias_addr, hidden.begin()));
+  for (Index i = 0; i < state.size(); ++i) {
+    float candidate = std::tanh(gates_C[2][i] + SigmoidRef(gates_C[0][i]) * gates_C[3][i]);
+    float update = SigmoidRef(gates_C[1][i]);
+    CHECK_EPS(hidden[i], (1.0f - update) * candidate + update * state[i], 0.002f);
+  }
+}
+
+template <class Routine> void TestMultiplyCell() {
+  TestMultiplyCell<Routine>(8, 256, 64, true);
+  TestMultiplyCell<Routine>(5, 128, 24, false);
+}
+
+TEST_CASE ("Multiply cell SSE2 8bit", "[multiply_cell]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyCell<SSE2::Kernels8>();
+}
+
+TEST_CASE ("Multiply cell Generic 8bit", "[multiply_cell]") {
+  TestMultiplyCell<Generic::Kernels8>();
+}
+
+TEST_CASE ("Multiply cell SSSE3 8bit", "[multiply_cell]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyCell<SSSE3::Kernels8>();
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply cell AVX2 8bit", "[multiply_cell]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyCell<AVX2::Kernels8>();
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply cell AVX512 8bit", "[multiply_cell]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyCell<AVX512BW::Kernels8>();
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply cell AVX512VNNI 8bit", "[multiply_cell]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyCell<AVX512VNNI::Kernels8>();
+}
+#endif
+
+// 16-bit float output: compare with converting the float output in scalar code.
+uint16_t BFloat16Ref(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  if (std::isnan(value)) return static_cast<uint16_t>((bits >> 16) | 0x40);
+  return static_cast<uint16_t>((bits + 0x7fff + ((bits >> 16) & 1)) >> 16);
+}
+
+uint16_t Float16Ref(float value) {
+  uint16_t sign = std::signbit(value) ? 0x8000 : 0;
+  float magnitude = std::fabs(value);
+  if (std::isnan(value)) return sign | 0x7e00;
+  if (magnitude >= 65520.0f) return sign | 0x7c00;
+  // Subnormal, in units of 2^-24.  std::nearbyint rounds half to even.
+  if (magnitude < std::ldexp(1.0f, -14)) return sign | static_cast<uint16_t>(std::nearbyint(std::ldexp(magnitude, 24)));
+  int exponent;
+  std::frexp(magnitude, &exponent);
+  --exponent;
+  auto mantissa = static_cast<uint16_t>(std::nearbyint(std::ldexp(magnitude, 10 - exponent)));
+  if (mantissa == 2048) {
+    mantissa = 1024;
+    ++exponent;
+  }
+  return sign | static_cast<uint16_t>(((exponent + 15) << 10) | (mantissa - 1024));
+}
+
+template <class Routine> void TestMultiplyFloat16(Index A_rows, Index width, Index B_cols) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  AlignedVector<float> bias(B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto* mat : {&A, &B, &bias}) {
+    for (auto& it : *mat) {
+      it = dist(gen);
+    }
+  }
+  const float quant_mult = 64.0f;
+  // Large enough that some outputs overflow float16.
+  const float unquant_mult = 8192.0f / (quant_mult * quant_mult);
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, width);
+  Routine::PrepareB(B.begin(), B_prep.begin(), quant_mult, width, B_cols);
+
+  AlignedVector<float> product(A_rows * B_cols), product_bias(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndWrite(unquant_mult, product.begin()));
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndAddBiasAndWrite(unquant_mult, bias.begin(), product_bias.begin()));
+
+  AlignedVector<uint16_t> test_C(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndWriteBFloat16, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndWriteBFloat16(unquant_mult, test_C.begin()));
+  for (Index i = 0; i < test_C.size(); ++i) {
+    CHECK(test_C[i] == BFloat16Ref(product[i]));
+  }
+  OMPParallelWrap<callbacks::UnquantizeAndWriteBFloat16, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndWriteBFloat16(unquant_mult, bias.begin(), test_C.begin()));
+  for (Index i = 0; i < test_C.size(); ++i) {
+    CHECK(test_C[i] == BFloat16Ref(product_bias[i]));
+  }
+  OMPParallelWrap<callbacks::UnquantizeAndWriteFloat16, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndWriteFloat16(unquant_mult, test_C.begin()));
+  for (Index i = 0; i < test_C.size(); ++i) {
+    CHECK(test_C[i] == Float16Ref(product[i]));
+  }
+  OMPParallelWrap<callbacks::UnquantizeAndWriteFloat16, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndWriteFloat16(unquant_mult, bias.begin(), test_C.begin()));
+  for (Index i = 0; i < test_C.size(); ++i) {
+    CHECK(test_C[i] == Float16Ref(product_bias[i]));
+  }
+}
+
+TEST_CASE ("Multiply float16 SSE2 8bit", "[multiply_float16]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyFloat16<SSE2::Kernels8>(8, 256, 256);
+  TestMultiplyFloat16<SSE2::Kernels8>(5, 128, 64);
+}
+
+TEST_CASE ("Multiply float16 Generic 8bit", "[multiply_float16]") {
+  TestMultiplyFloat16<Generic::Kernels8>(8, 256, 256);
+  TestMultiplyFloat16<Generic::Kernels8>(5, 128, 64);
+}
+
+TEST_CASE ("Multiply float16 SSSE3 8bit", "[multiply_float16]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyFloat16<SSSE3::Kernels8>(8, 256, 256);
+  TestMultiplyFloat16<SSSE3::Kernels8>(5, 128, 64);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply float16 AVX2 8bit", "[multiply_float16]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyFloat16<AVX2::Kernels8>(8, 256, 256);
+  TestMultiplyFloat16<AVX2::Kernels8>(5, 128, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply float16 AVX512 8bit", "[multiply_float16]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyFloat16<AVX512BW::Kernels8>(8, 256, 256);
+  TestMultiplyFloat16<AVX512BW::Kernels8>(5, 128, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply float16 AVX512VNNI 8bit", "[multiply_float16]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyFloat16<AVX512VNNI::Kernels8>(8, 256, 256);
+  TestMultiplyFloat16<AVX512VNNI::Kernels8>(5, 128, 64);
+}
+#endif
+
+// Absolute maximum tracking: compare with scanning the written output.
+template <class Routine> void TestMultiplyAbsMax(Index A_rows, Index width, Index B_cols) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  AlignedVector<float> bias(B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto& it : A) {
+    it = dist(gen);
+  }
+  for (auto& it : B) {
+    it = dist(gen);
+  }
+  for (auto& it : bias) {
+    it = dist(gen);
+  }
+  const float quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (quant_mult * quant_mult);
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, width);
+  Routine::PrepareB(B.begin(), B_prep.begin(), quant_mult, width, B_cols);
+
+  AlignedVector<float> ref_C(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndAddBiasAndWrite(unquant_mult, bias.begin(), ref_C.begin()));
+
+  AlignedVector<float> test_C(A_rows * B_cols);
+  std::vector<float> row_max(A_rows);
+  float global_max;
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndWriteAbsMax, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndAddBiasAndWriteAbsMax(unquant_mult, bias.begin(), test_C.begin(), row_max.data(), &global_max));
+  CHECK(std::equal(ref_C.begin(), ref_C.end(), test_C.begin()));
+  for (Index r = 0; r < A_rows; ++r) {
+    CHECK(row_max[r] == MaxAbsolute(ref_C.begin() + r * B_cols, ref_C.begin() + (r + 1) * B_cols));
+  }
+  CHECK(global_max == MaxAbsolute(ref_C.begin(), ref_C.end()));
+
+  // Without bias and with only the global maximum.
+  OMPParallelWrap<callbacks::UnquantizeAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndWrite(unquant_mult, ref_C.begin()));
+  const callbacks::UnquantizeAndAddBiasAndWriteAbsMax global_only(unquant_mult, nullptr, test_C.begin(), nullptr, &global_max);
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndWriteAbsMax, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, global_only);
+  CHECK(std::equal(ref_C.begin(), ref_C.end(), test_C.begin()));
+  CHECK(global_max == MaxAbsolute(ref_C.begin(), ref_C.end()));
+
+  // Reusing the config forgets the previous maximum.
+  std::fill(A_prep.begin(), A_prep.end(), 0);
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndWriteAbsMax, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, global_only);
+  CHECK(global_max == 0.0f);
+}
+
+TEST_CASE ("Multiply abs max SSE2 8bit", "[multiply_abs_max]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyAbsMax<SSE2::Kernels8>(8, 256, 256);
+  TestMultiplyAbsMax<SSE2::Kernels8>(5, 128, 64);
+}
+
+TEST_CASE ("Multiply abs max Generic 8bit", "[multiply_abs_max]") {
+  TestMultiplyAbsMax<Generic::Kernels8>(8, 256, 256);
+  TestMultiplyAbsMax<Generic::Kernels8>(5, 128, 64);
+}
+
+TEST_CASE ("Multiply abs max SSSE3 8bit", "[multiply_abs_max]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyAbsMax<SSSE3::Kernels8>(8, 256, 256);
+  TestMultiplyAbsMax<SSSE3::Kernels8>(5, 128, 64);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply abs max AVX2 8bit", "[multiply_abs_max]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyAbsMax<AVX2::Kernels8>(8, 256, 256);
+  TestMultiplyAbsMax<AVX2::Kernels8>(5, 128, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply abs max AVX512 8bit", "[multiply_abs_max]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyAbsMax<AVX512BW::Kernels8>(8, 256, 256);
+  TestMultiplyAbsMax<AVX512BW::Kernels8>(5, 128, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply abs max AVX512VNNI 8bit", "[multiply_abs_max]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyAbsMax<AVX512VNNI::Kernels8>(8, 256, 256);
+  TestMultiplyAbsMax<AVX512VNNI::Kernels8>(5, 128, 64);
+}
+#endif
+
+// LayerNorm epilogue: compare with the biased output plus residual normalized
+// in double precision.
+template <class Routine> void TestMultiplyLayerNorm(Index A_rows, Index width, Index B_cols, bool full, float residual_offset = 0.0f) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\t' << full << '\t' << residual_offset << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  AlignedVector<float> bias(B_cols);
+  AlignedVector<float> residual(A_rows * B_cols);
+  AlignedVector<float> gamma(B_cols);
+  AlignedVector<float> beta(B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto& it : A) {
+    it = dist(gen);
+  }
+  for (auto& it : B) {
+    it = dist(gen);
+  }
+  for (auto& it : bias) {
+    it = dist(gen);
+  }
+  for (auto& it : residual) {
+    it = residual_offset + 4.0f * dist(gen);
+  }
+  for (auto& it : gamma) {
+    it = 1.0f + dist(gen);
+  }
+  for (auto& it : beta) {
+    it = dist(gen);
+  }
+  const float quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (quant_mult * quant_mult);
+  const float epsilon = 1e-5f;
+  AlignedVector<typename Routine::Integer> A_prep(A.size());
+  AlignedVector<typename Routine::Integer> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, width);
+  Routine::PrepareB(B.begin(), B_prep.begin(), quant_mult, width, B_cols);
+
+  AlignedVector<float> ref_C(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndAddBiasAndWrite(unquant_mult, bias.begin(), ref_C.begin()));
+  std::vector<float> ref_mean(A_rows), ref_rstd(A_rows);
+  for (Index r = 0; r < A_rows; ++r) {
+    float *row = ref_C.begin() + r * B_cols;
+    double sum = 0, sumsq = 0;
+    for (Index c = 0; c < B_cols; ++c) {
+      if (full) row[c] += residual[r * B_cols + c];
+      sum += row[c];
+      sumsq += static_cast<double>(row[c]) * row[c];
+    }
+    double mean = sum / B_cols;
+    double rstd = 1.0 / std::sqrt(sumsq / B_cols - mean * mean + epsilon);
+    ref_mean[r] = static_cast<float>(mean);
+    ref_rstd[r] = static_cast<float>(rstd);
+    for (Index c = 0; c < B_cols; ++c) {
+      double normalized = (row[c] - mean) * rstd;
+      if (full) normalized = normalized * gamma[c] + beta[c];
+      row[c] = static_cast<float>(normalized);
+    }
+  }
+
+  AlignedVector<float> test_C(A_rows * B_cols);
+  std::vector<float> row_mean(A_rows), row_rstd(A_rows);
+  const callbacks::UnquantizeAndAddBiasAndLayerNorm layer_norm(
+      unquant_mult, bias.begin(), full ? residual.begin() : nullptr, full ? gamma.begin() : nullptr, full ? beta.begin() : nullptr, epsilon,
+      test_C.begin(), row_mean.data(), row_rstd.data());
+  // The second multiply checks that reusing the config starts the sums over.
+  for (int pass = 0; pass < 2; ++pass) {
+    OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndLayerNorm, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, layer_norm);
+    for (Index r = 0; r < A_rows; ++r) {
+      CHECK_EPS(row_mean[r], ref_mean[r], 0.0001f);
+      CHECK(row_rstd[r] == Approx(ref_rstd[r]).epsilon(0.001));
+    }
+    for (std::size_t i = 0; i < test_C.size(); ++i) {
+      CHECK_EPS(test_C[i], ref_C[i], 0.001f);
+    }
+  }
+}
+
+template <class Routine> void TestMultiplyLayerNorms(Index A_rows, Index width, Index B_cols) {
+  TestMultiplyLayerNorm<Routine>(A_rows, width, B_cols, false);
+  TestMultiplyLayerNorm<Routine>(A_rows, width, B_cols, true);
+  // Rows whose mean dwarfs their deviation.
+  TestMultiplyLayerNorm<Routine>(A_rows, width, B_cols, true, 1000.0f);
+}
+
+TEST_CASE ("Multiply layer norm SSE2 16bit", "[multiply_layer_norm]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyLayerNorms<SSE2::Kernels16>(8, 256, 256);
+}
+
+TEST_CASE ("Multiply layer norm SSE2 8bit", "[multiply_layer_norm]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyLayerNorms<SSE2::Kernels8>(8, 256, 256);
+  TestMultiplyLayerNorms<SSE2::Kernels8>(5, 128, 64);
+}
+
+TEST_CASE ("Multiply layer norm Generic 8bit", "[multiply_layer_norm]") {
+  TestMultiplyLayerNorms<Generic::Kernels8>(8, 256, 256);
+  TestMultiplyLayerNorms<Generic::Kernels8>(5, 128, 64);
+}
+
+TEST_CASE ("Multiply layer norm SSSE3 8bit", "[multiply_layer_norm]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyLayerNorms<SSSE3::Kernels8>(8, 256, 256);
+  TestMultiplyLayerNorms<SSSE3::Kernels8>(5, 128, 64);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply layer norm AVX2 8bit", "[multiply_layer_norm]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyLayerNorms<AVX2::Kernels8>(8, 256, 256);
+  TestMultiplyLayerNorms<AVX2::Kernels8>(5, 128, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply layer norm AVX512 8bit", "[multiply_layer_norm]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyLayerNorms<AVX512BW::Kernels8>(8, 256, 256);
+  TestMultiplyLayerNorms<AVX512BW::Kernels8>(5, 128, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply layer norm AVX512VNNI 8bit", "[multiply_layer_norm]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyLayerNorms<AVX512VNNI::Kernels8>(8, 256, 256);
+  TestMultiplyLayerNorms<AVX512VNNI::Kernels8>(5, 128, 64);
+}
+#endif
+
+// Dual product: compare with two separate multiplies added together.
+template <class Routine> void TestMultiplyDual(Index A_rows, Index width1, Index width2, Index B_cols) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width1 << '\t' << width2 << '\t' << B_cols << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A1(A_rows * width1), A2(A_rows * width2);
+  AlignedVector<float> B1(width1 * B_cols), B2(width2 * B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto* mat : {&A1, &A2, &B1, &B2}) {
+    for (auto& it : *mat) {
+      it = dist(gen);
+    }
+  }
+  const float quant_mult1 = 64.0f, quant_mult2 = 32.0f;
+  const float unquant_mult1 = 1.0f / (quant_mult1 * quant_mult1);
+  const float unquant_mult2 = 1.0f / (quant_mult2 * quant_mult2);
+
+  AlignedVector<int8_t> A1_prep(A1.size()), A2_prep(A2.size());
+  AlignedVector<int8_t> B1_prep(B1.size()), B2_prep(B2.size());
+  Routine::PrepareA(A1.begin(), A1_prep.begin(), quant_mult1, A_rows, width1);
+  Routine::PrepareA(A2.begin(), A2_prep.begin(), quant_mult2, A_rows, width2);
+  Routine::PrepareB(B1.begin(), B1_prep.begin(), quant_mult1, width1, B_cols);
+  Routine::PrepareB(B2.begin(), B2_prep.begin(), quant_mult2, width2, B_cols);
+
+  AlignedVector<float> C1(A_rows * B_cols), C2(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndWrite, Routine>(A1_prep.begin(), B1_prep.begin(), A_rows, width1, B_cols, callbacks::UnquantizeAndWrite(unquant_mult1, C1.begin()));
+  OMPParallelWrap<callbacks::UnquantizeAndWrite, Routine>(A2_prep.begin(), B2_prep.begin(), A_rows, width2, B_cols, callbacks::UnquantizeAndWrite(unquant_mult2, C2.begin()));
+  for (Index i = 0; i < C1.size(); ++i) {
+    C1[i] += C2[i];
+  }
+
+  AlignedVector<float> test_C(A_rows * B_cols);
+  OMPParallelWrapDual<callbacks::Write<float>, Routine>(A1_prep.begin(), B1_prep.begin(), unquant_mult1, width1, A2_prep.begin(), B2_prep.begin(), unquant_mult2, width2, A_rows, B_cols, callbacks::Write<float>(test_C.begin()));
+  CompareEps(C1.begin(), test_C.begin(), test_C.size(), 0.0001f);
+}
+
+TEST_CASE ("Multiply dual SSE2 8bit", "[multiply_dual]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyDual<SSE2::Kernels8>(8, 256, 256, 256);
+  TestMultiplyDual<SSE2::Kernels8>(17, 512, 128, 64);
+}
+
+TEST_CASE ("Multiply dual Generic 8bit", "[multiply_dual]") {
+  TestMultiplyDual<Generic::Kernels8>(8, 256, 256, 256);
+  TestMultiplyDual<Generic::Kernels8>(17, 512, 128, 64);
+}
+
+TEST_CASE ("Multiply dual SSSE3 8bit", "[multiply_dual]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyDual<SSSE3::Kernels8>(8, 256, 256, 256);
+  TestMultiplyDual<SSSE3::Kernels8>(17, 512, 128, 64);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply dual AVX2 8bit", "[multiply_dual]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyDual<AVX2::Kernels8>(8, 256, 256, 256);
+  TestMultiplyDual<AVX2::Kernels8>(17, 512, 128, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply dual AVX512 8bit", "[multiply_dual]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyDual<AVX512BW::Kernels8>(8, 256, 256, 256);
+  TestMultiplyDual<AVX512BW::Kernels8>(17, 512, 128, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply dual AVX512VNNI 8bit", "[multiply_dual]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyDual<AVX512VNNI::Kernels8>(8, 256, 256, 256);
+  TestMultiplyDual<AVX512VNNI::Kernels8>(17, 512, 128, 64);
+}
+#endif
+
+// Dynamic B: every layout should match preparing B then multiplying.
+template <class Routine> void TestMultiplyDynamicB(Index A_rows, Index width, Index B_cols) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto& it : A) {
+    it = dist(gen);
+  }
+  for (auto& it : B) {
+    it = dist(gen);
+  }
+  const float quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (quant_mult * quant_mult);
+
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, width);
+  Routine::PrepareB(B.begin(), B_prep.begin(), quant_mult, width, B_cols);
+  AlignedVector<float> ref_C(A_rows * B_cols);
+  OMPParallelWrap<callbacks::UnquantizeAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndWrite(unquant_mult, ref_C.begin()));
+
+  AlignedVector<float> B_transposed(B.size());
+  references::Transpose(B.begin(), B_transposed.begin(), width, B_cols);
+  AlignedVector<int8_t> B_quant(B.size());
+  AlignedVector<int8_t> B_quant_transposed(B.size());
+  Routine::Quantize(B.begin(), B_quant.begin(), quant_mult, static_cast<Index>(B.size()));
+  Routine::Quantize(B_transposed.begin(), B_quant_transposed.begin(), quant_mult, static_cast<Index>(B.size()));
+
+  AlignedVector<float> test_C(A_rows * B_cols);
+  OMPParallelWrapDynamicB<int8_t, callbacks::UnquantizeAndWrite, Routine>(A_prep.begin(), B_quant.begin(), 1.0f, false, A_rows, width, B_cols, callbacks::UnquantizeAndWrite(unquant_mult, test_C.begin()));
+  CompareEps(ref_C.begin(), test_C.begin(), test_C.size(), 0.0001f);
+  OMPParallelWrapDynamicB<int8_t, callbacks::UnquantizeAndWrite, Routine>(A_prep.begin(), B_quant_transposed.begin(), 1.0f, true, A_rows, width, B_cols, callbacks::UnquantizeAndWrite(unquant_mult, test_C.begin()));
+  CompareEps(ref_C.begin(), test_C.begin(), test_C.size(), 0.0001f);
+  OMPParallelWrapDynamicB<float, callbacks::UnquantizeAndWrite, Routine>(A_prep.begin(), B.begin(), quant_mult, false, A_rows, width, B_cols, callbacks::UnquantizeAndWrite(unquant_mult, test_C.begin()));
+  CompareEps(ref_C.begin(), test_C.begin(), test_C.size(), 0.0001f);
+  OMPParallelWrapDynamicB<float, callbacks::UnquantizeAndWrite, Routine>(A_prep.begin(), B_transposed.begin(), quant_mult, true, A_rows, width, B_cols, callbacks::UnquantizeAndWrite(unquant_mult, test_C.begin()));
+  CompareEps(ref_C.begin(), test_C.begin(), test_C.size(), 0.0001f);
+}
+
+TEST_CASE ("Multiply dynamic B SSE2 8bit", "[multiply_dynamic_b]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyDynamicB<SSE2::Kernels8>(8, 256, 256);
+  TestMultiplyDynamicB<SSE2::Kernels8>(33, 512, 64);
+}
+
+TEST_CASE ("Multiply dynamic B Generic 8bit", "[multiply_dynamic_b]") {
+  TestMultiplyDynamicB<Generic::Kernels8>(8, 256, 256);
+  TestMultiplyDynamicB<Generic::Kernels8>(33, 512, 64);
+}
+
+TEST_CASE ("Multiply dynamic B SSSE3 8bit", "[multiply_dynamic_b]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyDynamicB<SSSE3::Kernels8>(8, 256, 256);
+  TestMultiplyDynamicB<SSSE3::Kernels8>(33, 512, 64);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply dynamic B AVX2 8bit", "[multiply_dynamic_b]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyDynamicB<AVX2::Kernels8>(8, 256, 256);
+  TestMultiplyDynamicB<AVX2::Kernels8>(33, 512, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply dynamic B AVX512 8bit", "[multiply_dynamic_b]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyDynamicB<AVX512BW::Kernels8>(8, 256, 256);
+  TestMultiplyDynamicB<AVX512BW::Kernels8>(33, 512, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply dynamic B AVX512VNNI 8bit", "[multiply_dynamic_b]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyDynamicB<AVX512VNNI::Kernels8>(8, 256, 256);
+  TestMultiplyDynamicB<AVX512VNNI::Kernels8>(33, 512, 64);
+}
+#endif
+
+TEST_CASE ("Multiply dynamic B Int8 dispatch", "[multiply_dynamic_b]") {
+  if (kCPU < CPUType::SSE2) return;
+  const Index A_rows = 3, width = 128, B_cols = 16;
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto& it : A) it = dist(gen);
+  for (auto& it : B) it = dist(gen);
+
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Int8::PrepareA(A.begin(), A_prep.begin(), 64.0f, A_rows, width);
+  Int8::PrepareB(B.begin(), B_prep.begin(), 64.0f, width, B_cols);
+  AlignedVector<float> ref_C(A_rows * B_cols);
+  Int8::Multiply(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndWrite(1.0f / (64.0f * 64.0f), ref_C.begin()));
+
+  AlignedVector<float> test_C(A_rows * B_cols);
+  Int8::MultiplyDynamicB(A_prep.begin(), B.begin(), 64.0f, false, A_rows, width, B_cols, callbacks::UnquantizeAndWrite(1.0f / (64.0f * 64.0f), test_C.begin()));
+  CompareEps(ref_C.begin(), test_C.begin(), test_C.size(), 0.0001f);
+}
+
+// Shortlist: should match SelectColumnsB followed by Multiply with the bias gathered the same way.
+template <class Routine> void TestMultiplyShortlist(Index A_rows, Index width, Index B_cols) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  AlignedVector<float> bias(B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto& it : A) {
+    it = dist(gen);
+  }
+  for (auto& it : B) {
+    it = dist(gen);
+  }
+  for (auto& it : bias) {
+    it = dist(gen);
+  }
+
+  // An aligned block of 8 (read in place), then arbitrary columns (gathered).
+  std::vector<Index> shortlist;
+  for (Index c = 8; c < 16; ++c) {
+    shortlist.push_back(c);
+  }
+  std::uniform_int_distribution<Index> col_dist(0, B_cols - 1);
+  for (Index i = 0; i < 16; ++i) {
+    shortlist.push_back(col_dist(gen));
+  }
+  const Index selected = static_cast<Index>(shortlist.size());
+
+  const float quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (quant_mult * quant_mult);
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, width);
+  Routine::PrepareB(B.begin(), B_prep.begin(), quant_mult, width, B_cols);
+
+  AlignedVector<int8_t> B_selected(width * selected);
+  Routine::SelectColumnsB(B_prep.begin(), B_selected.begin(), width, shortlist.data(), shortlist.data() + selected);
+  AlignedVector<float> bias_selected(selected);
+  for (Index i = 0; i < selected; ++i) {
+    bias_selected[i] = bias[shortlist[i]];
+  }
+  AlignedVector<float> ref_C(A_rows * selected);
+  OMPParallelWrap<callbacks::UnquantizeAndAddBiasAndWrite, Routine>(A_prep.begin(), B_selected.begin(), A_rows, width, selected, callbacks::UnquantizeAndAddBiasAndWrite(unquant_mult, bias_selected.begin(), ref_C.begin()));
+
+  AlignedVector<float> test_C(A_rows * selected);
+  OMPParallelWrapShortlist<callbacks::UnquantizeAndAddShortlistBiasAndWrite, Routine>(A_prep.begin(), B_prep.begin(), A_rows, width, shortlist.data(), shortlist.data() + selected, callbacks::UnquantizeAndAddShortlistBiasAndWrite(unquant_mult, bias.begin(), shortlist.data(), test_C.begin()));
+  CompareEps(ref_C.begin(), test_C.begin(), test_C.size(), 0.0001f);
+}
+
+TEST_CASE ("Multiply shortlist SSE2 8bit", "[multiply_shortlist]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyShortlist<SSE2::Kernels8>(8, 256, 256);
+  TestMultiplyShortlist<SSE2::Kernels8>(5, 512, 64);
+}
+
+TEST_CASE ("Multiply shortlist Generic 8bit", "[multiply_shortlist]") {
+  TestMultiplyShortlist<Generic::Kernels8>(8, 256, 256);
+  TestMultiplyShortlist<Generic::Kernels8>(5, 512, 64);
+}
+
+TEST_CASE ("Multiply shortlist SSSE3 8bit", "[multiply_shortlist]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyShortlist<SSSE3::Kernels8>(8, 256, 256);
+  TestMultiplyShortlist<SSSE3::Kernels8>(5, 512, 64);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply shortlist AVX2 8bit", "[multiply_shortlist]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyShortlist<AVX2::Kernels8>(8, 256, 256);
+  TestMultiplyShortlist<AVX2::Kernels8>(5, 512, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply shortlist AVX512 8bit", "[multiply_shortlist]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyShortlist<AVX512BW::Kernels8>(8, 256, 256);
+  TestMultiplyShortlist<AVX512BW::Kernels8>(5, 512, 64);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply shortlist AVX512VNNI 8bit", "[multiply_shortlist]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyShortlist<AVX512VNNI::Kernels8>(8, 256, 256);
+  TestMultiplyShortlist<AVX512VNNI::Kernels8>(5, 512, 64);
+}
+#endif
+
+TEST_CASE ("Multiply shortlist Int8 dispatch", "[multiply_shortlist]") {
+  if (kCPU < CPUType::SSE2) return;
+  const Index A_rows = 3, width = 128, B_cols = 32;
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto& it : A) it = dist(gen);
+  for (auto& it : B) it = dist(gen);
+  const Index shortlist[16] = {24, 25, 26, 27, 28, 29, 30, 31, 3, 17, 0, 9, 31, 12, 5, 20};
+
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Int8::PrepareA(A.begin(), A_prep.begin(), 64.0f, A_rows, width);
+  Int8::PrepareB(B.begin(), B_prep.begin(), 64.0f, width, B_cols);
+  AlignedVector<int8_t> B_selected(width * 16);
+  Int8::SelectColumnsB(B_prep.begin(), B_selected.begin(), width, shortlist, shortlist + 16);
+  AlignedVector<float> ref_C(A_rows * 16);
+  Int8::Multiply(A_prep.begin(), B_selected.begin(), A_rows, width, 16, callbacks::UnquantizeAndWrite(1.0f / (64.0f * 64.0f), ref_C.begin()));
+
+  AlignedVector<float> test_C(A_rows * 16);
+  Int8::MultiplyShortlist(A_prep.begin(), B_prep.begin(), A_rows, width, shortlist, shortlist + 16, callbacks::UnquantizeAndWrite(1.0f / (64.0f * 64.0f), test_C.begin()));
+  CompareEps(ref_C.begin(), test_C.begin(), test_C.size(), 0.0001f);
+}
+
+// Batched shortlists: every group should match its own MultiplyShortlist.
+template <class Routine> void TestMultiplyShortlistBatch(Index width, Index B_cols) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << width << '\t' << B_cols << '\n';
+  INFO(info.str());
+
+  // Four groups of rows, the third with no rows and the last with an empty shortlist.
+  const Index groups = 4;
+  const Index row_offsets[groups + 1] = {0, 3, 4, 4, 9};
+  const Index shortlist_sizes[groups] = {16, 8, 24, 0};
+  std::mt19937 gen;
+  std::uniform_int_distribution<Index> col_dist(0, B_cols - 1);
+  std::vector<Index> col_offsets(1, 0);
+  std::vector<Index> cols;
+  for (Index g = 0; g < groups; ++g) {
+    for (Index i = 0; i < shortlist_sizes[g]; ++i) {
+      cols.push_back(col_dist(gen));
+    }
+    col_offsets.push_back(static_cast<Index>(cols.size()));
+  }
+  // Make the first block of group 0 an aligned block read in place.
+  for (Index k = 0; k < 8; ++k) {
+    cols[k] = 16 + k;
+  }
+
+  const Index A_rows = row_offsets[groups];
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  AlignedVector<float> bias(B_cols);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto& it : A) {
+    it = dist(gen);
+  }
+  for (auto& it : B) {
+    it = dist(gen);
+  }
+  for (auto& it : bias) {
+    it = dist(gen);
+  }
+
+  const float quant_mult = 64.0f;
+  const float unquant_mult = 1.0f / (quant_mult * quant_mult);
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), quant_mult, A_rows, width);
+  Routine::PrepareB(B.begin(), B_prep.begin(), quant_mult, width, B_cols);
+
+  // Ragged output: each group's rows x shortlist block follows the previous one.
+  Index total = 0;
+  std::vector<Index> output_offsets;
+  for (Index g = 0; g < groups; ++g) {
+    output_offsets.push_back(total);
+    total += (row_offsets[g + 1] - row_offsets[g]) * shortlist_sizes[g];
+  }
+  AlignedVector<float> ref_C(total);
+  AlignedVector<float> test_C(total);
+  std::vector<callbacks::UnquantizeAndAddShortlistBiasAndWrite> group_callbacks;
+  for (Index g = 0; g < groups; ++g) {
+    const Index *shortlist = cols.data() + col_offsets[g];
+    OMPParallelWrapShortlist<callbacks::UnquantizeAndAddShortlistBiasAndWrite, Routine>(A_prep.begin() + row_offsets[g] * width, B_prep.begin(), row_offsets[g + 1] - row_offsets[g], width, shortlist, shortlist + shortlist_sizes[g], callbacks::UnquantizeAndAddShortlistBiasAndWrite(unquant_mult, bias.begin(), shortlist, ref_C.begin() + output_offsets[g]));
+    group_callbacks.emplace_back(unquant_mult, bias.begin(), shortlist, test_C.begin() + output_offsets[g]);
+  }
+  OMPParallelWrapShortlistBatch<callbacks::UnquantizeAndAddShortlistBiasAndWrite, Routine>(A_prep.begin(), B_prep.begin(), width, groups, row_offsets, col_offsets.data(), cols.data(), group_callbacks.data());
+  CompareEps(ref_C.begin(), test_C.begin(), test_C.size(), 0.0001f);
+
+  // Callbacks that finish whole rows have to see each group's rows complete.
+  std::vector<float> ref_stats(2 * A_rows), test_stats(2 * A_rows);
+  std::vector<callbacks::UnquantizeAndAddBiasAndLayerNorm> norm_callbacks;
+  for (Index g = 0; g < groups; ++g) {
+    const Index *shortlist = cols.data() + col_offsets[g];
+    const Index group_rows = row_offsets[g + 1] - row_offsets[g];
+    float *ref_mean = ref_stats.data() + row_offsets[g], *ref_rstd = ref_mean + A_rows;
+    float *test_mean = test_stats.data() + row_offsets[g], *test_rstd = test_mean + A_rows;
+    OMPParallelWrapShortlist<callbacks::UnquantizeAndAddBiasAndLayerNorm, Routine>(A_prep.begin() + row_offsets[g] * width, B_prep.begin(), group_rows, width, shortlist, shortlist + shortlist_sizes[g], callbacks::UnquantizeAndAddBiasAndLayerNorm(unquant_mult, bias.begin(), nullptr, nullptr, nullptr, 1e-5f, ref_C.begin() + output_offsets[g], ref_mean, ref_rstd));
+    norm_callbacks.emplace_back(unquant_mult, bias.begin(), nullptr, nullptr, nullptr, 1e-5f, test_C.begin() + output_offsets[g], test_mean, test_rstd);
+  }
+  OMPParallelWrapShortlistBatch<callbacks::UnquantizeAndAddBiasAndLayerNorm, Routine>(A_prep.begin(), B_prep.begin(), width, groups, row_offsets, col_offsets.data(), cols.data(), norm_callbacks.data());
+  CompareEps(ref_C.begin(), test_C.begin(), test_C.size(), 0.0001f);
+  // The last group has no columns, so only the others have statistics.
+  CompareEps(ref_stats.data(), test_stats.data(), row_offsets[groups - 1], 0.0001f);
+  CompareEps(ref_stats.data() + A_rows, test_stats.data() + A_rows, row_offsets[groups - 1], 0.0001f);
+}
+
+TEST_CASE ("Multiply shortlist batch SSE2 8bit", "[multiply_shortlist]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyShortlistBatch<SSE2::Kernels8>(256, 256);
+}
+
+TEST_CASE ("Multiply shortlist batch Generic 8bit", "[multiply_shortlist]") {
+  TestMultiplyShortlistBatch<Generic::Kernels8>(256, 256);
+}
+
+TEST_CASE ("Multiply shortlist batch SSSE3 8bit", "[multiply_shortlist]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyShortlistBatch<SSSE3::Kernels8>(256, 256);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply shortlist batch AVX2 8bit", "[multiply_shortlist]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyShortlistBatch<AVX2::Kernels8>(256, 256);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply shortlist batch AVX512 8bit", "[multiply_shortlist]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyShortlistBatch<AVX512BW::Kernels8>(256, 256);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply shortlist batch AVX512VNNI 8bit", "[multiply_shortlist]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyShortlistBatch<AVX512VNNI::Kernels8>(256, 256);
+}
+#endif
+
+TEST_CASE ("Multiply shortlist batch Int8 dispatch", "[multiply_shortlist]") {
+  if (kCPU < CPUType::SSE2) return;
+  const Index width = 128, B_cols = 32;
+  AlignedVector<float> A(3 * width);
+  AlignedVector<float> B(width * B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto& it : A) it = dist(gen);
+  for (auto& it : B) it = dist(gen);
+  const Index row_offsets[3] = {0, 1, 3};
+  const Index col_offsets[3] = {0, 8, 24};
+  const Index cols[24] = {8, 9, 10, 11, 12, 13, 14, 15, 3, 17, 0, 9, 31, 12, 5, 20, 24, 25, 26, 27, 28, 29, 30, 31};
+
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Int8::PrepareA(A.begin(), A_prep.begin(), 64.0f, 3, width);
+  Int8::PrepareB(B.begin(), B_prep.begin(), 64.0f, width, B_cols);
+  AlignedVector<float> ref_C(8 + 2 * 16);
+  Int8::MultiplyShortlist(A_prep.begin(), B_prep.begin(), 1, width, cols, cols + 8, callbacks::UnquantizeAndWrite(1.0f / (64.0f * 64.0f), ref_C.begin()));
+  Int8::MultiplyShortlist(A_prep.begin() + width, B_prep.begin(), 2, width, cols + 8, cols + 24, callbacks::UnquantizeAndWrite(1.0f / (64.0f * 64.0f), ref_C.begin() + 8));
+
+  AlignedVector<float> test_C(ref_C.size());
+  const callbacks::UnquantizeAndWrite group_callbacks[2] = {
+    callbacks::UnquantizeAndWrite(1.0f / (64.0f * 64.0f), test_C.begin()),
+    callbacks::UnquantizeAndWrite(1.0f / (64.0f * 64.0f), test_C.begin() + 8)};
+  Int8::MultiplyShortlistBatch(A_prep.begin(), B_prep.begin(), width, 2, row_offsets, col_offsets, cols, group_callbacks);
+  CompareEps(ref_C.begin(), test_C.begin(), test_C.size(), 0.0001f);
+}
+
+// Group-wise scales: compare against summing each group in integers then
+// unquantizing it with its own multiplier.
+template <class Routine> void TestMultiplyGroupwise(Index A_rows, Index width, Index B_cols, Index group_size) {
+  std::ostringstream info;
+  info << Routine::kName << "\t" << A_rows << '\t' << width << '\t' << B_cols << '\t' << group_size << '\n';
+  INFO(info.str());
+
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  const Index groups = width / group_size;
+  AlignedVector<float> B_mults(groups * B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::uniform_real_distribution<float> mult_dist(32.0f, 127.0f);
+  for (auto& it : A) {
+    it = dist(gen);
+  }
+  for (auto& it : B) {
+    it = dist(gen);
+  }
+  for (auto& it : B_mults) {
+    it = mult_dist(gen);
+  }
+
+  // Small multiplier for A so 16-bit accumulation does not saturate within a group.
+  const float A_quant_mult = 16.0f;
+  AlignedVector<float> group_unquant(B_mults.size());
+  for (Index i = 0; i < B_mults.size(); ++i) {
+    group_unquant[i] = 1.0f / (A_quant_mult * B_mults[i]);
+  }
+
+  AlignedVector<float> B_scaled(B.size());
+  for (Index r = 0; r < width; ++r) {
+    for (Index c = 0; c < B_cols; ++c) {
+      B_scaled[r * B_cols + c] = B[r * B_cols + c] * B_mults[(r / group_size) * B_cols + c];
+    }
+  }
+
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Routine::PrepareA(A.begin(), A_prep.begin(), A_quant_mult, A_rows, width);
+  Routine::PrepareB(B_scaled.begin(), B_prep.begin(), 1.0f, width, B_cols);
+
+  // Scaling inside PrepareBGroupwise matches quantizing the scaled copy.
+  AlignedVector<int8_t> B_groupwise(B.size());
+  Routine::PrepareBGroupwise(B.begin(), B_groupwise.begin(), B_mults.begin(), group_size, width, B_cols);
+  Compare(B_prep.begin(), B_groupwise.begin(), B_prep.size());
+
+  AlignedVector<float> test_C(A_rows * B_cols);
+  OMPParallelWrapGroupwise<callbacks::Write<float>, Routine>(A_prep.begin(), B_prep.begin(), group_unquant.begin(), group_size, A_rows, width, B_cols, callbacks::Write<float>(test_C.begin()));
+
+  AlignedVector<int8_t> B_quant(B.size());
+  Routine::Quantize(B_scaled.begin(), B_quant.begin(), 1.0f, static_cast<Index>(B.size()));
+  // The kernel scales and adds partial sums in float, so bound its error by the
+  // magnitude of the scaled products rather than by the (possibly cancelled) result.
+  for (Index r = 0; r < A_rows; ++r) {
+    for (Index c = 0; c < B_cols; ++c) {
+      double total = 0, magnitude = 0;
+      for (Index g = 0; g < groups; ++g) {
+        for (Index k = g * group_size; k < (g + 1) * group_size; ++k) {
+          double product = double(A_prep[r * width + k]) * double(B_quant[k * B_cols + c]) * group_unquant[g * B_cols + c];
+          total += product;
+          magnitude += std::fabs(product);
+        }
+      }
+      INFO("Inaccurate at row " << r << " column " << c << ' ' << total << ' ' << test_C[r * B_cols + c]);
+      CHECK(std::fabs(total - test_C[r * B_cols + c]) < 1e-6 * magnitude);
+    }
+  }
+}
+
+TEST_CASE ("Multiply groupwise SSE2 8bit", "[multiply_groupwise]") {
+  if (kCPU < CPUType::SSE2) return;
+  TestMultiplyGroupwise<SSE2::Kernels8>(8, 256, 256, 64);
+  TestMultiplyGroupwise<SSE2::Kernels8>(200, 512, 64, 128);
+}
+
+TEST_CASE ("Multiply groupwise Generic 8bit", "[multiply_groupwise]") {
+  TestMultiplyGroupwise<Generic::Kernels8>(8, 256, 256, 64);
+  TestMultiplyGroupwise<Generic::Kernels8>(200, 512, 64, 128);
+}
+
+TEST_CASE ("Multiply groupwise SSSE3 8bit", "[multiply_groupwise]") {
+  if (kCPU < CPUType::SSSE3) return;
+  TestMultiplyGroupwise<SSSE3::Kernels8>(8, 256, 256, 64);
+  TestMultiplyGroupwise<SSSE3::Kernels8>(1, 256, 256, 256);
+  TestMultiplyGroupwise<SSSE3::Kernels8>(200, 512, 64, 128);
+}
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX2
+TEST_CASE ("Multiply groupwise AVX2 8bit", "[multiply_groupwise]") {
+  if (kCPU < CPUType::AVX2) return;
+  TestMultiplyGroupwise<AVX2::Kernels8>(8, 256, 256, 64);
+  TestMultiplyGroupwise<AVX2::Kernels8>(1, 256, 256, 256);
+  TestMultiplyGroupwise<AVX2::Kernels8>(200, 512, 64, 128);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512BW
+TEST_CASE ("Multiply groupwise AVX512 8bit", "[multiply_groupwise]") {
+  if (kCPU < CPUType::AVX512BW) return;
+  TestMultiplyGroupwise<AVX512BW::Kernels8>(8, 256, 256, 64);
+  TestMultiplyGroupwise<AVX512BW::Kernels8>(1, 256, 256, 256);
+  TestMultiplyGroupwise<AVX512BW::Kernels8>(200, 512, 64, 128);
+}
+#endif
+
+#ifdef INTGEMM_COMPILER_SUPPORTS_AVX512VNNI
+TEST_CASE ("Multiply groupwise AVX512VNNI 8bit", "[multiply_groupwise]") {
+  if (kCPU < CPUType::AVX512VNNI) return;
+  TestMultiplyGroupwise<AVX512VNNI::Kernels8>(8, 256, 256, 64);
+  TestMultiplyGroupwise<AVX512VNNI::Kernels8>(1, 256, 256, 256);
+  TestMultiplyGroupwise<AVX512VNNI::Kernels8>(200, 512, 64, 128);
+}
+#endif
+
+TEST_CASE ("Multiply groupwise Int8 dispatch", "[multiply_groupwise]") {
+  if (kCPU < CPUType::SSE2) return;
+  const Index A_rows = 4, width = 256, B_cols = 16, group_size = 64;
+  AlignedVector<float> A(A_rows * width);
+  AlignedVector<float> B(width * B_cols);
+  AlignedVector<float> B_mults(width / group_size * B_cols);
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (auto& it : A) it = dist(gen);
+  for (auto& it : B) it = dist(gen);
+  for (auto& it : B_mults) it = 127.0f;
+
+  AlignedVector<float> group_unquant(B_mults.size());
+  for (auto& it : group_unquant) it = 1.0f / (16.0f * 127.0f);
+
+  AlignedVector<int8_t> A_prep(A.size());
+  AlignedVector<int8_t> B_prep(B.size());
+  Int8::PrepareA(A.begin(), A_prep.begin(), 16.0f, A_rows, width);
+  Int8::PrepareBGroupwise(B.begin(), B_prep.begin(), B_mults.begin(), group_size, width, B_cols);
+  AlignedVector<float> groupwise_C(A_rows * B_cols);
+  Int8::MultiplyGroupwise(A_prep.begin(), B_prep.begin(), group_unquant.begin(), group_size, A_rows, width, B_cols, callbacks::Write<float>(groupwise_C.begin()));
+
+  // With the same multiplier everywhere this matches the ordinary multiply.
+  Int8::PrepareB(B.begin(), B_prep.begin(), 127.0f, width, B_cols);
+  AlignedVector<float> plain_C(A_rows * B_cols);
+  Int8::Multiply(A_prep.begin(), B_prep.begin(), A_rows, width, B_cols, callbacks::UnquantizeAndWrite(1.0f / (16.0f * 127.0f), plain_C.begin()));
+  CompareEps(plain_C.begin(), groupwise_C.begin(), plain_C.size(), 0.0001f);
+}
+
 } // namespace intgemm
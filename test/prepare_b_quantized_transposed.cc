@@ -63,6 +63,12 @@ TEST_CASE("PrepareBQuantizedTransposed SSE2", "") {
     return;
 
   CHECK(TestMany<SSE2::Kernels16>(32, 128));
+  CHECK(TestMany<SSE2::Kernels8>(32, 128));
+}
+
+TEST_CASE("PrepareBQuantizedTransposed Generic", "") {
+  CHECK(TestMany<Generic::Kernels16>(32, 128));
+  CHECK(TestMany<Generic::Kernels8>(32, 128));
 }
 
 TEST_CASE("PrepareBQuantizedTransposed SSSE3", "") {
@@ -64,6 +64,12 @@ TEST_CASE("PrepareBTransposed SSE2", "") {
     return;
 
   CHECK(TestMany<SSE2::Kernels16>(4, 128, 2.0f));
+  CHECK(TestMany<SSE2::Kernels8>(4, 128, 2.0f));
+}
+
+TEST_CASE("PrepareBTransposed Generic", "") {
+  CHECK(TestMany<Generic::Kernels16>(4, 128, 2.0f));
+  CHECK(TestMany<Generic::Kernels8>(4, 128, 2.0f));
 }
 
 TEST_CASE("PrepareBTransposed SSSE3", "") {
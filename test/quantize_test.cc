@@ -121,6 +121,12 @@ template <class Backend> void TestMany(std::size_t grow) {
 TEST_CASE ("Quantize SSE2", "[quantize]") {
   if (kCPU < CPUType::SSE2) return;
   TestMany<SSE2::Kernels16>(8);
+  TestMany<SSE2::Kernels8>(1);
+}
+
+TEST_CASE ("Quantize Generic", "[quantize]") {
+  TestMany<Generic::Kernels16>(8);
+  TestMany<Generic::Kernels8>(1);
 }
 
 TEST_CASE ("Quantize SSSE3", "[quantize]") {